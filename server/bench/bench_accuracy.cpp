@@ -0,0 +1,266 @@
+//
+// Accuracy against cost of the localization engine: every filter, sample window and access point count is
+// resolved over the desks of synthetic buildings with known positions, and reported with its position error
+// percentiles, CPU time per resolve and working memory, followed by the Pareto front of error against time.
+//
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "synthetic_building.hpp"
+
+using namespace ins_service;
+
+namespace
+{
+
+enum Filter
+{
+    KALMAN, // the engine's kalmanProcess()
+    MEAN    // plain average of the readings, the baseline the Kalman filter has to beat
+};
+
+const std::vector<int64_t> kFilters         = { KALMAN, MEAN };
+const std::vector<int64_t> kSamples         = { 10, 100, 1000, NUMBER_SAMPLES };
+const std::vector<int64_t> kAccessPoints    = { TRILATERAT_NUMBER_NODES, 8, MAXIMUM_NUMBER_NODES };
+const std::vector<int64_t> kNoiseDb         = { 1, 3, 6 };
+const uint32_t             kDesksPerFloor   = 20;
+const uint32_t             kDatasetSeed     = 42;
+const char                 kErrorCounter[]  = "p90_error_m";
+const char                 kMemoryCounter[] = "node_bytes";
+
+// Running mean, one reading per call like the engine's filter callback.
+void meanProcess(wifiParams_t* insNodeBlockWifi)
+{
+    if (insNodeBlockWifi->noProcessedSampleData < NUMBER_SAMPLES)
+    {
+        float count = static_cast<float>(insNodeBlockWifi->noProcessedSampleData);
+        float rssi  = insNodeBlockWifi->rssisampledata[insNodeBlockWifi->noProcessedSampleData];
+        insNodeBlockWifi->estReceivedPower
+            = count == 0 ? rssi : (insNodeBlockWifi->estReceivedPower * count + rssi) / (count + 1);
+        insNodeBlockWifi->noProcessedSampleData++;
+    }
+}
+
+/**
+ * Device blocks of every desk of a synthetic building, filled the way Localization fills them from the
+ * strongest access_points series of samples readings, with their ground truth.
+ */
+class Dataset
+{
+public:
+    Dataset(Filter filter, int samples, int access_points, float noise_db)
+    {
+        BuildingOptions options;
+        options.access_points_per_floor = SyntheticBuilding::kMaxAccessPointsPerFloor;
+        options.desks_per_floor         = kDesksPerFloor;
+        options.noise_db                = noise_db;
+        options.seed                    = kDatasetSeed;
+        SyntheticBuilding building(options);
+
+        std::mt19937 random(kDatasetSeed);
+        desks_ = building.desks();
+        nodes_.reset(new insNode_t[desks_.size()]);
+        for (size_t desk = 0; desk < desks_.size(); ++desk)
+        {
+            insNode_t* node = &nodes_[desk];
+            InsNodeDefine(node, static_cast<uint32_t>(desk), "accuracy-desk");
+            if (filter == MEAN)
+                node->filterProcess = meanProcess;
+
+            // Blocks left unused by a device were cleared by its previous resolve.
+            for (int j = 0; j < MAXIMUM_NUMBER_NODES; ++j)
+                node->wifiAccessPointNode[j].noSampleData = 0;
+
+            auto   series = building.SimulateReadings(desks_[desk], static_cast<size_t>(samples), random);
+            size_t count  = std::min(series.size(), static_cast<size_t>(access_points));
+            for (size_t j = 0; j < count; ++j)
+                Fill(building, series[j], &node->wifiAccessPointNode[j]);
+        }
+        working_.reset(new insNode_t);
+    }
+
+    size_t size() const
+    {
+        return desks_.size();
+    }
+
+    // Copy of the block of desk, the engine consumes the readings it resolves.
+    insNode_t* Prepare(size_t desk)
+    {
+        memcpy(working_.get(), &nodes_[desk], sizeof(insNode_t));
+        return working_.get();
+    }
+
+    // Horizontal error of the estimate for every desk in metres, infinite when the solver found no position,
+    // sorted; and the share of desks placed on their floor.
+    std::vector<double> Errors(double& floor_hits)
+    {
+        std::vector<double> errors;
+        size_t              hits = 0;
+        for (size_t desk = 0; desk < desks_.size(); ++desk)
+        {
+            float* estimate = GetCartesianPosition(Prepare(desk));
+            double dx       = estimate[0] - desks_[desk].x;
+            double dy       = estimate[1] - desks_[desk].y;
+            double error    = std::sqrt(dx * dx + dy * dy);
+            errors.push_back(std::isfinite(error) ? error : std::numeric_limits<double>::infinity());
+            if (estimate[2] == desks_[desk].z)
+                ++hits;
+        }
+        std::sort(errors.begin(), errors.end());
+        floor_hits = static_cast<double>(hits) / desks_.size();
+        return errors;
+    }
+
+private:
+    static void Fill(const SyntheticBuilding&       building,
+                     const AccessPointRssiListPair& series,
+                     wifiParams_t*                  wifiNodeBlock)
+    {
+        auto access_point = std::find_if(building.access_points().begin(),
+                                         building.access_points().end(),
+                                         [&series](const SyntheticAccessPoint& candidate) {
+                                             return candidate.mac_addr == series.first.mac_addr;
+                                         });
+
+        // What loadLCFGParams() reads from the building's local config.
+        initKalmanParams(wifiNodeBlock);
+        wifiNodeBlock->position[0]        = static_cast<float>(access_point->pos.x);
+        wifiNodeBlock->position[1]        = static_cast<float>(access_point->pos.y);
+        wifiNodeBlock->position[2]        = static_cast<float>(access_point->pos.z);
+        wifiNodeBlock->pathLoss.dDistance = access_point->arbitrary_distance;
+        wifiNodeBlock->pathLoss.powerdo   = access_point->power_transmit;
+        wifiNodeBlock->pathLoss.powerd    = access_point->power_at_arbitrary_distance;
+
+        wifiNodeBlock->noSampleData = static_cast<uint32_t>(series.second.size());
+        for (size_t i = 0; i < series.second.size(); ++i)
+            wifiNodeBlock->rssisampledata[i % NUMBER_SAMPLES] = static_cast<float>(series.second[i]);
+    }
+
+    std::vector<Position>        desks_;
+    std::unique_ptr<insNode_t[]> nodes_;
+    std::unique_ptr<insNode_t>   working_;
+};
+
+double Percentile(const std::vector<double>& sorted, double fraction)
+{
+    return sorted[static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5)];
+}
+
+// Resolves the desks of the dataset in turn; the CPU time is per resolve, the counters describe the error over
+// all desks and the memory the engine works in.
+void BM_Resolve(benchmark::State& state)
+{
+    Dataset dataset(static_cast<Filter>(state.range(0)),
+                    static_cast<int>(state.range(1)),
+                    static_cast<int>(state.range(2)),
+                    static_cast<float>(state.range(3)));
+
+    size_t desk = 0;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        insNode_t* node = dataset.Prepare(desk);
+        desk            = (desk + 1) % dataset.size();
+        state.ResumeTiming();
+        benchmark::DoNotOptimize(GetCartesianPosition(node));
+    }
+
+    double              floor_hits;
+    std::vector<double> errors = dataset.Errors(floor_hits);
+    state.counters["p50_error_m"]   = Percentile(errors, 0.5);
+    state.counters[kErrorCounter]   = Percentile(errors, 0.9);
+    state.counters["p99_error_m"]   = Percentile(errors, 0.99);
+    state.counters["floor_hits"]    = floor_hits;
+    state.counters[kMemoryCounter]  = sizeof(insNode_t);
+    state.counters["reading_bytes"] = static_cast<double>(state.range(1) * state.range(2) * sizeof(float));
+}
+BENCHMARK(BM_Resolve)
+    ->ArgNames({ "mean", "samples", "aps", "noise_db" })
+    ->ArgsProduct({ kFilters, kSamples, kAccessPoints, kNoiseDb })
+    ->Unit(benchmark::kMicrosecond);
+
+/**
+ * Console output followed, for every noise level, by the configurations no other one beats on both p90 error
+ * and CPU time per resolve.
+ */
+class ParetoReporter : public benchmark::ConsoleReporter
+{
+public:
+    void ReportRuns(const std::vector<Run>& reports) override
+    {
+        for (auto const& run : reports)
+        {
+            auto error = run.counters.find(kErrorCounter);
+            if (run.error_occurred || error == run.counters.end())
+                continue;
+            std::string name  = run.benchmark_name();
+            size_t      noise = name.find("noise_db:");
+            points_[name.substr(noise)].push_back(
+                Point{ name.substr(0, noise - 1), run.GetAdjustedCPUTime(), error->second.value, run.time_unit });
+        }
+        ConsoleReporter::ReportRuns(reports);
+    }
+
+    void Finalize() override
+    {
+        ConsoleReporter::Finalize();
+        for (auto& level : points_)
+        {
+            std::vector<Point>& points = level.second;
+            std::sort(points.begin(), points.end(), [](const Point& lhs, const Point& rhs) {
+                return lhs.cpu_time < rhs.cpu_time || (lhs.cpu_time == rhs.cpu_time && lhs.error < rhs.error);
+            });
+
+            fprintf(stdout, "\nPareto front, %s (cpu time per resolve, p90 error):\n", level.first.c_str());
+            double best = std::numeric_limits<double>::infinity();
+            for (auto const& point : points)
+            {
+                if (point.error >= best)
+                    continue;
+                best = point.error;
+                fprintf(stdout,
+                        "  %-40s %10.2f %s %8.2f m\n",
+                        point.name.c_str(),
+                        point.cpu_time,
+                        benchmark::GetTimeUnitString(point.unit),
+                        point.error);
+            }
+        }
+    }
+
+private:
+    struct Point
+    {
+        std::string         name;
+        double              cpu_time;
+        double              error;
+        benchmark::TimeUnit unit;
+    };
+
+    std::map<std::string, std::vector<Point>> points_;
+};
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+        return 1;
+    ParetoReporter reporter;
+    benchmark::RunSpecifiedBenchmarks(&reporter);
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,278 @@
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "data_store.hpp"
+
+using namespace ins_service;
+
+namespace
+{
+
+enum Backend
+{
+    MEMORY,
+    DISK
+};
+
+const int64_t kFirstDeviceId  = 1000;
+const int64_t kActiveDevices  = 1000; // devices with a table of readings
+const int     kAccessPoints   = 8;
+const int64_t kUploadsPerTxn  = 64; // StorageWriter::kMaxBatch
+const int64_t kMaxUploadBatch = 10; // IngestRecord::kMaxReadings
+
+const std::vector<int64_t> kBackends    = { MEMORY, DISK };
+const std::vector<int64_t> kFleetSizes  = { 10, 1000, 100000 };
+const std::vector<int64_t> kHistorySize = { 10, 100, 1000, 10000 };
+
+std::string DeviceName(int64_t index)
+{
+    return std::to_string(kFirstDeviceId + index);
+}
+
+std::string EmployeeName(int64_t index)
+{
+    return "employee_" + std::to_string(index);
+}
+
+MacAddress AccessPointName(int index)
+{
+    char mac_addr[18];
+    snprintf(mac_addr, sizeof(mac_addr), "00:11:22:33:44:%02x", index);
+    return MacAddress(mac_addr);
+}
+
+/**
+ * Database of devices located devices, each assigned to an employee, on a temporary file or in memory. Only
+ * the first kActiveDevices have a table of readings: SQLite re-reads its whole schema on every CREATE TABLE,
+ * so creating 100k device tables takes minutes. The last fleet built is kept for the next benchmark asking
+ * for the same one.
+ */
+class Fleet
+{
+public:
+    static std::shared_ptr<Fleet> Get(Backend backend, int64_t devices)
+    {
+        static std::mutex             lock;
+        static std::shared_ptr<Fleet> last;
+
+        std::lock_guard<std::mutex> guard(lock);
+        if (last == nullptr || last->backend_ != backend || last->devices_ != devices)
+        {
+            last.reset();
+            last = std::make_shared<Fleet>(backend, devices);
+        }
+        return last;
+    }
+
+    Fleet(Backend backend, int64_t devices)
+        : backend_(backend)
+        , devices_(devices)
+        , store_(std::make_shared<DataStore>())
+    {
+        if (backend == DISK)
+        {
+            char path[] = "/tmp/bench_data_store_XXXXXX";
+            int  fd     = mkstemp(path);
+            if (fd >= 0)
+                close(fd);
+            path_ = path;
+        }
+        store_->Init(backend == DISK ? path_ : ":memory:");
+
+        std::vector<StoredLocation> locations;
+        locations.reserve(static_cast<size_t>(devices));
+        store_->BeginTransaction();
+        for (int64_t i = 0; i < devices; ++i)
+        {
+            Position pos = { static_cast<double>(i % 50), static_cast<double>(i % 30), static_cast<double>(i % 3) };
+            if (i < kActiveDevices)
+                store_->CreateDeviceTable(DeviceName(i));
+            locations.push_back(StoredLocation{ DeviceName(i), EmployeeName(i), pos, "" });
+        }
+        store_->InsertLocations(locations);
+        store_->CommitTransaction();
+    }
+
+    ~Fleet()
+    {
+        store_->Close();
+        if (!path_.empty())
+            unlink(path_.c_str());
+    }
+
+    DataStore& store()
+    {
+        return *store_;
+    }
+
+    int64_t devices() const
+    {
+        return devices_;
+    }
+
+    int64_t active_devices() const
+    {
+        return std::min(devices_, kActiveDevices);
+    }
+
+private:
+    Backend                    backend_;
+    int64_t                    devices_;
+    std::string                path_;
+    std::shared_ptr<DataStore> store_;
+};
+
+std::vector<RssiReading> Upload(std::mt19937& random, size_t count)
+{
+    std::uniform_int_distribution<int> access_point(0, kAccessPoints - 1);
+    std::uniform_int_distribution<int> rssi(-90, -30);
+
+    std::vector<RssiReading> readings(count);
+    for (auto& reading : readings)
+        reading = RssiReading{ AccessPointName(access_point(random)), rssi(random) };
+    return readings;
+}
+
+std::vector<AccessPoint> AccessPoints()
+{
+    std::vector<AccessPoint> access_points;
+    for (int j = 0; j < kAccessPoints; ++j)
+        access_points.emplace_back(AccessPointName(j));
+    return access_points;
+}
+
+// Uploads of batch readings each to the active devices in turn, uploads_per_txn of them per transaction
+// as the storage thread groups them. Items are readings.
+void BM_InsertRSSIReadings(benchmark::State& state)
+{
+    auto   fleet           = Fleet::Get(static_cast<Backend>(state.range(0)), kFleetSizes[1]);
+    size_t batch           = static_cast<size_t>(state.range(1));
+    size_t uploads_per_txn = static_cast<size_t>(state.range(2));
+
+    std::mt19937             random(42);
+    std::vector<RssiReading> readings = Upload(random, batch);
+    int64_t                  device   = 0;
+    for (auto _ : state)
+    {
+        if (uploads_per_txn > 1)
+            fleet->store().BeginTransaction();
+        for (size_t i = 0; i < uploads_per_txn; ++i)
+        {
+            fleet->store().InsertRSSIReadings(DeviceName(device), readings.data(), readings.size());
+            device = (device + 1) % fleet->active_devices();
+        }
+        if (uploads_per_txn > 1)
+            fleet->store().CommitTransaction();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(1) * state.range(2));
+}
+BENCHMARK(BM_InsertRSSIReadings)
+    ->ArgNames({ "disk", "batch", "uploads_per_txn" })
+    ->ArgsProduct({ kBackends, { 1, kMaxUploadBatch }, { 1, kUploadsPerTxn } })
+    ->Unit(benchmark::kMicrosecond);
+
+// Series of one device with history readings spread over kAccessPoints access points.
+void BM_GetRSSISeriesData(benchmark::State& state)
+{
+    auto        fleet   = Fleet::Get(static_cast<Backend>(state.range(0)), kFleetSizes[0]);
+    std::string device  = DeviceName(0);
+    int64_t     history = state.range(1);
+
+    std::mt19937 random(42);
+    fleet->store().ClearDeviceTable(device);
+    fleet->store().BeginTransaction();
+    for (int64_t stored = 0; stored < history; stored += kMaxUploadBatch)
+    {
+        std::vector<RssiReading> readings
+            = Upload(random, static_cast<size_t>(std::min<int64_t>(kMaxUploadBatch, history - stored)));
+        fleet->store().InsertRSSIReadings(device, readings.data(), readings.size());
+    }
+    fleet->store().CommitTransaction();
+
+    std::vector<AccessPoint> access_points = AccessPoints();
+    for (auto _ : state)
+    {
+        std::vector<AccessPointRssiListPair> series;
+        fleet->store().GetRSSISeriesData(device, access_points, series);
+        benchmark::DoNotOptimize(series.data());
+    }
+    fleet->store().ClearDeviceTable(device);
+    state.SetItemsProcessed(state.iterations() * history);
+}
+BENCHMARK(BM_GetRSSISeriesData)
+    ->ArgNames({ "disk", "history" })
+    ->ArgsProduct({ kBackends, kHistorySize })
+    ->Unit(benchmark::kMicrosecond);
+
+// Position lookups of random devices of the fleet, by device id or by employee id.
+void BM_GetPosition(benchmark::State& state)
+{
+    auto   fleet    = Fleet::Get(static_cast<Backend>(state.range(0)), state.range(2));
+    QueryT query_by = static_cast<QueryT>(state.range(1));
+
+    std::mt19937                           random(42);
+    std::uniform_int_distribution<int64_t> device(0, fleet->devices() - 1);
+    for (auto _ : state)
+    {
+        int64_t     index = device(random);
+        std::string id    = query_by == QueryT::DEVICE ? DeviceName(index) : EmployeeName(index);
+        Position    pos;
+        fleet->store().GetPosition(id, query_by, pos);
+        benchmark::DoNotOptimize(pos);
+    }
+}
+BENCHMARK(BM_GetPosition)
+    ->ArgNames({ "disk", "employee", "devices" })
+    ->ArgsProduct({ kBackends, { QueryT::DEVICE, QueryT::EMPLOYEE }, kFleetSizes })
+    ->Unit(benchmark::kMicrosecond);
+
+// Threads share one store as the service's workers do: nine of ten operations upload to an active device,
+// the tenth resolves one, reading its series and writing its position, and every operation looks up the
+// position of any device of the fleet.
+void BM_MixedWorkload(benchmark::State& state)
+{
+    auto fleet = Fleet::Get(static_cast<Backend>(state.range(0)), state.range(1));
+
+    std::mt19937                           random(static_cast<unsigned>(42 + state.thread_index()));
+    std::uniform_int_distribution<int64_t> active(0, fleet->active_devices() - 1);
+    std::uniform_int_distribution<int64_t> device(0, fleet->devices() - 1);
+    std::vector<AccessPoint>               access_points = AccessPoints();
+    std::vector<RssiReading>               readings      = Upload(random, static_cast<size_t>(kMaxUploadBatch));
+    uint64_t                               operation     = 0;
+    for (auto _ : state)
+    {
+        std::string id = DeviceName(active(random));
+        if (++operation % 10 != 0)
+        {
+            fleet->store().InsertRSSIReadings(id, readings.data(), readings.size());
+        }
+        else
+        {
+            std::vector<AccessPointRssiListPair> series;
+            fleet->store().GetRSSISeriesData(id, access_points, series);
+            fleet->store().UpdateDeviceLocation(id, Position{ 1.0, 2.0, 0.0 });
+        }
+        Position pos;
+        fleet->store().GetPosition(DeviceName(device(random)), QueryT::DEVICE, pos);
+        benchmark::DoNotOptimize(pos);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MixedWorkload)
+    ->ArgNames({ "disk", "devices" })
+    ->ArgsProduct({ kBackends, kFleetSizes })
+    ->ThreadRange(1, 8)
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+
+} // namespace
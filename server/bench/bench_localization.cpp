@@ -0,0 +1,189 @@
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+extern "C"
+{
+#include <WifiNode.h>
+}
+
+namespace
+{
+
+// Synthetic floor: access points on a 10 m grid around a device, path loss exponent 3 and 3 dB of noise.
+const float kDevicePosition[CARTESIANSIZE] = { 23.0f, 17.0f, 1.0f };
+const float kArbitraryDistance             = 10.0f;
+const float kPathLossExponent              = 3.0f;
+const float kNoiseDb                       = 3.0f;
+
+/**
+ * Device block with ap_count access points of samples readings each, as Localization fills it. The
+ * pristine block is kept aside so that benchmarks of the stages that consume it can start over.
+ */
+class SyntheticDevice
+{
+public:
+    SyntheticDevice(int ap_count, int samples)
+        : pristine_(new insNode_t)
+        , node_(new insNode_t)
+    {
+        std::mt19937                    random(42);
+        std::normal_distribution<float> noise(0.0f, kNoiseDb);
+
+        InsNodeDefine(pristine_.get(), 0, "bench-device");
+        for (int j = 0; j < ap_count; ++j)
+        {
+            wifiParams_t& ap = pristine_->wifiAccessPointNode[j];
+            ap.position[0]   = 10.0f * (j % 5);
+            ap.position[1]   = 10.0f * (j / 5);
+            ap.position[2]   = static_cast<float>(j % NO_FLOORS);
+
+            ap.pathLoss.dDistance = kArbitraryDistance;
+            ap.pathLoss.powerdo   = POWER_do;
+            ap.pathLoss.powerd    = POWER_do - 10.0f * kPathLossExponent * std::log10(kArbitraryDistance);
+
+            float distance = 0.0f;
+            for (int k = 0; k < CARTESIANSIZE; ++k)
+                distance += (ap.position[k] - kDevicePosition[k]) * (ap.position[k] - kDevicePosition[k]);
+            distance   = std::max(1.0f, std::sqrt(distance));
+            float rssi = POWER_do - 10.0f * kPathLossExponent * std::log10(distance);
+
+            ap.noSampleData = static_cast<uint32_t>(samples);
+            for (int i = 0; i < samples; ++i)
+                ap.rssisampledata[i] = rssi + noise(random);
+        }
+        for (int j = ap_count; j < MAXIMUM_NUMBER_NODES; ++j)
+            pristine_->wifiAccessPointNode[j].noSampleData = 0;
+        Reset();
+    }
+
+    insNode_t* node()
+    {
+        return node_.get();
+    }
+
+    // Runs the filter on the pristine block, for the stages that start from distances.
+    void Filter()
+    {
+        computePLProcess(pristine_.get());
+        Reset();
+    }
+
+    // Back to the pristine block; copies all of it, call it with the timer paused.
+    void Reset()
+    {
+        memcpy(node_.get(), pristine_.get(), sizeof(insNode_t));
+    }
+
+    // Back to unfiltered readings, cheap enough to run with the timer on.
+    void ResetFilter()
+    {
+        for (int j = 0; j < MAXIMUM_NUMBER_NODES; ++j)
+        {
+            wifiParams_t& ap                       = node_->wifiAccessPointNode[j];
+            ap.noProcessedSampleData               = 0;
+            ap.estReceivedPower                    = INITIAL_ESTIMATE;
+            ap.wifiInitParams.initialErrorEstimate = INITIAL_ERROR_ESTIMATE;
+        }
+    }
+
+private:
+    std::unique_ptr<insNode_t> pristine_;
+    std::unique_ptr<insNode_t> node_;
+};
+
+const std::vector<int64_t> kAccessPoints = { TRILATERAT_NUMBER_NODES, 8, MAXIMUM_NUMBER_NODES };
+const std::vector<int64_t> kSamples      = { 10, 100, 1000, NUMBER_SAMPLES };
+
+void BM_KalmanProcess(benchmark::State& state)
+{
+    SyntheticDevice device(1, static_cast<int>(state.range(0)));
+    wifiParams_t*   ap = &device.node()->wifiAccessPointNode[0];
+    for (auto _ : state)
+    {
+        device.ResetFilter();
+        for (uint32_t i = 0; i < ap->noSampleData; ++i)
+            kalmanProcess(ap);
+        benchmark::DoNotOptimize(ap->estReceivedPower);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_KalmanProcess)->ArgName("samples")->Arg(10)->Arg(100)->Arg(1000)->Arg(NUMBER_SAMPLES);
+
+void BM_ComputePLProcess(benchmark::State& state)
+{
+    SyntheticDevice device(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    for (auto _ : state)
+    {
+        device.ResetFilter();
+        computePLProcess(device.node());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(1));
+}
+BENCHMARK(BM_ComputePLProcess)->ArgNames({ "aps", "samples" })->ArgsProduct({ kAccessPoints, kSamples });
+
+void BM_Power2Distance(benchmark::State& state)
+{
+    SyntheticDevice device(static_cast<int>(state.range(0)), NUMBER_SAMPLES);
+    device.Filter();
+    for (auto _ : state)
+    {
+        power2distance(device.node());
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_Power2Distance)->ArgName("aps")->ArgsProduct({ kAccessPoints });
+
+void BM_OrderRSSIAscend(benchmark::State& state)
+{
+    SyntheticDevice device(static_cast<int>(state.range(0)), NUMBER_SAMPLES);
+    device.Filter();
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        device.Reset();
+        state.ResumeTiming();
+        orderRSSIAscend(device.node());
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_OrderRSSIAscend)->ArgName("aps")->ArgsProduct({ kAccessPoints });
+
+void BM_TrilaterationProcess(benchmark::State& state)
+{
+    SyntheticDevice device(static_cast<int>(state.range(0)), NUMBER_SAMPLES);
+    device.Filter();
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        device.Reset();
+        state.ResumeTiming();
+        trilateration_process(device.node());
+        benchmark::DoNotOptimize(device.node()->nodeCartPosition[0]);
+    }
+}
+BENCHMARK(BM_TrilaterationProcess)->ArgName("aps")->ArgsProduct({ kAccessPoints });
+
+void BM_GetCartesianPosition(benchmark::State& state)
+{
+    SyntheticDevice device(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+    for (auto _ : state)
+    {
+        // GetCartesianPosition() clears the readings it consumed.
+        state.PauseTiming();
+        device.Reset();
+        state.ResumeTiming();
+        benchmark::DoNotOptimize(GetCartesianPosition(device.node()));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(1));
+}
+BENCHMARK(BM_GetCartesianPosition)->ArgNames({ "aps", "samples" })->ArgsProduct({ kAccessPoints, kSamples });
+
+} // namespace
@@ -0,0 +1,119 @@
+//
+// Writes the local config of a synthetic building and the ground truth positions of its desks, so that
+// ins_server and the load generator can run against the same building the benchmarks simulate.
+//
+
+#include <cstdio>
+#include <getopt.h>
+#include <iostream>
+#include <string>
+
+#include "synthetic_building.hpp"
+
+using namespace ins_service;
+
+int main(int argc, char* argv[])
+{
+    enum
+    {
+        OPT_FLOORS = 256,
+        OPT_ACCESS_POINTS,
+        OPT_DESKS,
+        OPT_WIDTH,
+        OPT_DEPTH,
+        OPT_EXPONENT,
+        OPT_NOISE,
+        OPT_SEED,
+        OPT_CONFIG,
+        OPT_DESKS_FILE
+    };
+
+    static const struct option long_options[]
+        = { { "floors", required_argument, nullptr, OPT_FLOORS },
+            { "access-points", required_argument, nullptr, OPT_ACCESS_POINTS },
+            { "desks", required_argument, nullptr, OPT_DESKS },
+            { "width", required_argument, nullptr, OPT_WIDTH },
+            { "depth", required_argument, nullptr, OPT_DEPTH },
+            { "exponent", required_argument, nullptr, OPT_EXPONENT },
+            { "noise", required_argument, nullptr, OPT_NOISE },
+            { "seed", required_argument, nullptr, OPT_SEED },
+            { "config", required_argument, nullptr, OPT_CONFIG },
+            { "desks-file", required_argument, nullptr, OPT_DESKS_FILE },
+            { nullptr, 0, nullptr, 0 } };
+
+    BuildingOptions options;
+    std::string     config_file = "WifiNodeLCFG.xml";
+    std::string     desks_file  = "desks.csv";
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "", long_options, nullptr)) != -1)
+    {
+        switch (opt)
+        {
+            case OPT_FLOORS:
+                options.floors = static_cast<uint32_t>(std::stoul(optarg));
+                break;
+            case OPT_ACCESS_POINTS:
+                options.access_points_per_floor = static_cast<uint32_t>(std::stoul(optarg));
+                break;
+            case OPT_DESKS:
+                options.desks_per_floor = static_cast<uint32_t>(std::stoul(optarg));
+                break;
+            case OPT_WIDTH:
+                options.width_m = std::stof(optarg);
+                break;
+            case OPT_DEPTH:
+                options.depth_m = std::stof(optarg);
+                break;
+            case OPT_EXPONENT:
+                options.path_loss_exponent = std::stof(optarg);
+                break;
+            case OPT_NOISE:
+                options.noise_db = std::stof(optarg);
+                break;
+            case OPT_SEED:
+                options.seed = static_cast<uint32_t>(std::stoul(optarg));
+                break;
+            case OPT_CONFIG:
+                config_file = optarg;
+                break;
+            case OPT_DESKS_FILE:
+                desks_file = optarg;
+                break;
+            default:
+                std::cerr << "usage: " << argv[0] << " [--floors <count>] [--access-points <per floor>]"
+                          << " [--desks <per floor>] [--width <m>] [--depth <m>] [--exponent <path loss>]"
+                          << " [--noise <dB>] [--seed <seed>] [--config <file>] [--desks-file <file>]" << std::endl;
+                return 1;
+        }
+    }
+
+    SyntheticBuilding building(options);
+    if (!building.WriteLocalConfig(config_file))
+    {
+        std::cerr << "cannot write " << config_file << std::endl;
+        return 1;
+    }
+
+    FILE* desks = fopen(desks_file.c_str(), "w");
+    if (desks == nullptr)
+    {
+        std::cerr << "cannot write " << desks_file << std::endl;
+        return 1;
+    }
+    fprintf(desks, "desk,x,y,z\n");
+    for (size_t desk = 0; desk < building.desks().size(); ++desk)
+    {
+        const Position& pos = building.desks()[desk];
+        fprintf(desks, "%zu,%.3f,%.3f,%.0f\n", desk, pos.x, pos.y, pos.z);
+    }
+    fclose(desks);
+
+    printf("%u floors, %zu access points, %zu desks written to %s and %s\n",
+           building.options().floors,
+           building.access_points().size(),
+           building.desks().size(),
+           config_file.c_str(),
+           desks_file.c_str());
+    return 0;
+}
@@ -0,0 +1,506 @@
+//
+// Load generator for ins_server over loopback: simulated INS-nodes upload RSSI readings on their wake cadence
+// and simulated app users resolve and read positions, then throughput and latency percentiles are reported.
+//
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cctype>
+#include <chrono>
+#include <cinttypes>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <getopt.h>
+#include <iostream>
+#include <memory>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <queue>
+#include <random>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+
+typedef std::chrono::steady_clock Clock;
+
+const uint32_t kFirstDeviceId    = 100000;
+const uint32_t kAccessPointPool  = 64;
+const uint32_t kNodeAccessPoints = 8;
+const uint32_t kMaxReadings      = 10; // readings of one /set_rssi upload
+
+struct Options
+{
+    std::string address          = "127.0.0.1";
+    uint16_t    port             = 9080;
+    uint32_t    threads          = 4;
+    uint32_t    duration_s       = 30;
+    uint32_t    nodes            = 1000;
+    uint32_t    wake_interval_ms = 1000;
+    uint32_t    wake_jitter_ms   = 200;
+    uint32_t    readings         = kMaxReadings;
+    uint32_t    apps             = 100;
+    uint32_t    app_interval_ms  = 2000;
+    uint32_t    resolve_percent  = 20;
+    uint32_t    seed             = 42;
+};
+
+enum Route
+{
+    SET_RSSI,
+    RESOLVE_POS,
+    GET_DEVICE_POS,
+    ROUTE_COUNT
+};
+
+const char* const kRouteNames[ROUTE_COUNT] = { "set_rssi", "resolve_pos", "get_device_pos" };
+
+// Outcomes of one route on one worker. Latency runs from the time the request was due, so a server that falls
+// behind shows up in it even though every worker waits for each answer; service time runs from the send.
+struct RouteStats
+{
+    uint64_t              ok       = 0;
+    uint64_t              rejected = 0; // 429 and 503, the server shedding load
+    uint64_t              failed   = 0;
+    std::vector<uint32_t> latency_us;
+    std::vector<uint32_t> service_us;
+};
+
+// Node or app user, due again at due.
+struct Actor
+{
+    Clock::time_point due;
+    uint32_t          index;
+    bool              is_node;
+
+    bool operator>(const Actor& rhs) const
+    {
+        return due > rhs.due;
+    }
+};
+
+/**
+ * Keep-alive HTTP/1.1 connection issuing one request at a time, reconnecting after errors and closes.
+ */
+class Connection
+{
+public:
+    explicit Connection(const sockaddr_in& address)
+        : address_(address)
+        , fd_(-1)
+    {
+    }
+
+    ~Connection()
+    {
+        Close();
+    }
+
+    Connection(const Connection&) = delete;
+    Connection& operator=(const Connection&) = delete;
+
+    // Sends request and reads the whole response. False on connection errors, status is the HTTP status.
+    bool Exchange(const std::string& request, int& status)
+    {
+        if (fd_ < 0 && !Open())
+            return false;
+        if (!Send(request) || !Receive(status))
+        {
+            Close();
+            return false;
+        }
+        return true;
+    }
+
+private:
+    bool Open()
+    {
+        fd_ = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd_ < 0)
+            return false;
+        int no_delay = 1;
+        setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+        if (connect(fd_, reinterpret_cast<const sockaddr*>(&address_), sizeof(address_)) != 0)
+        {
+            Close();
+            return false;
+        }
+        return true;
+    }
+
+    void Close()
+    {
+        if (fd_ >= 0)
+            close(fd_);
+        fd_ = -1;
+        buffer_.clear();
+    }
+
+    bool Send(const std::string& request)
+    {
+        size_t sent = 0;
+        while (sent < request.size())
+        {
+            ssize_t written = send(fd_, request.data() + sent, request.size() - sent, MSG_NOSIGNAL);
+            if (written <= 0)
+                return false;
+            sent += static_cast<size_t>(written);
+        }
+        return true;
+    }
+
+    bool Fill()
+    {
+        char    chunk[4096];
+        ssize_t received = recv(fd_, chunk, sizeof(chunk), 0);
+        if (received <= 0)
+            return false;
+        buffer_.append(chunk, static_cast<size_t>(received));
+        return true;
+    }
+
+    bool Receive(int& status)
+    {
+        size_t header_end;
+        while ((header_end = buffer_.find("\r\n\r\n")) == std::string::npos)
+        {
+            if (!Fill())
+                return false;
+        }
+        if (sscanf(buffer_.c_str(), "HTTP/1.%*d %d", &status) != 1)
+            return false;
+
+        std::string headers = buffer_.substr(0, header_end);
+        std::transform(headers.begin(), headers.end(), headers.begin(), ::tolower);
+        size_t content_length = 0;
+        size_t field          = headers.find("\r\ncontent-length:");
+        if (field != std::string::npos)
+            content_length = std::strtoul(headers.c_str() + field + 17, nullptr, 10);
+        bool keep_alive = headers.find("\r\nconnection: close") == std::string::npos;
+
+        size_t end = header_end + 4 + content_length;
+        while (buffer_.size() < end)
+        {
+            if (!Fill())
+                return false;
+        }
+        buffer_.erase(0, end);
+        if (!keep_alive)
+            Close();
+        return true;
+    }
+
+    sockaddr_in address_;
+    int         fd_;
+    std::string buffer_;
+};
+
+std::string DeviceId(uint32_t node)
+{
+    return std::to_string(kFirstDeviceId + node);
+}
+
+std::string AccessPointMac(uint32_t access_point)
+{
+    char mac_addr[18];
+    snprintf(mac_addr, sizeof(mac_addr), "0a:1b:2c:3d:%02x:%02x", access_point >> 8, access_point & 0xff);
+    return mac_addr;
+}
+
+std::string Request(const char* method, const std::string& path)
+{
+    return std::string(method) + " " + path + " HTTP/1.1\r\nHost: localhost\r\nContent-Length: 0\r\n\r\n";
+}
+
+/**
+ * Simulates the nodes and app users with index % threads == thread over one connection.
+ */
+class Worker
+{
+public:
+    Worker(const Options& options, const sockaddr_in& address, uint32_t thread)
+        : options_(options)
+        , connection_(address)
+        , random_(options.seed + thread)
+        , stats_(ROUTE_COUNT)
+    {
+        Clock::time_point                       start = Clock::now();
+        std::uniform_int_distribution<uint32_t> wake_phase(0, std::max(1u, options.wake_interval_ms) - 1);
+        std::uniform_int_distribution<uint32_t> app_phase(0, std::max(1u, options.app_interval_ms) - 1);
+        for (uint32_t node = thread; node < options.nodes; node += options.threads)
+            schedule_.push(Actor{ start + std::chrono::milliseconds(wake_phase(random_)), node, true });
+        for (uint32_t app = thread; app < options.apps; app += options.threads)
+            schedule_.push(Actor{ start + std::chrono::milliseconds(app_phase(random_)), app, false });
+    }
+
+    void Run(Clock::time_point end)
+    {
+        while (!schedule_.empty())
+        {
+            Actor actor = schedule_.top();
+            schedule_.pop();
+            if (actor.due >= end)
+                break;
+            std::this_thread::sleep_until(actor.due);
+
+            if (actor.is_node)
+            {
+                Issue(SET_RSSI, actor.due, Request("POST", UploadPath(actor.index)));
+                actor.due += Interval(options_.wake_interval_ms);
+            }
+            else
+            {
+                std::uniform_int_distribution<uint32_t> node(0, std::max(1u, options_.nodes) - 1);
+                std::uniform_int_distribution<uint32_t> percent(0, 99);
+                std::string                             device_id = DeviceId(node(random_));
+                if (percent(random_) < options_.resolve_percent)
+                    Issue(RESOLVE_POS, actor.due, Request("POST", "/resolve_pos/" + device_id));
+                else
+                    Issue(GET_DEVICE_POS, actor.due, Request("GET", "/get_device_pos/" + device_id));
+                actor.due += Interval(options_.app_interval_ms);
+            }
+            schedule_.push(actor);
+        }
+    }
+
+    const std::vector<RouteStats>& stats() const
+    {
+        return stats_;
+    }
+
+private:
+    // Readings from the node's own access points, strengths depending on the node and access point plus noise.
+    std::string UploadPath(uint32_t node)
+    {
+        std::normal_distribution<float> noise(0.0f, 3.0f);
+        std::string                     path = "/set_rssi/" + DeviceId(node);
+        for (uint32_t i = 0; i < options_.readings; ++i)
+        {
+            uint32_t access_point = (node * 7 + i % kNodeAccessPoints) % kAccessPointPool;
+            int      rssi         = -40 - static_cast<int>((node + access_point * 13) % 50)
+                       + static_cast<int>(std::lround(noise(random_)));
+            path += "/" + AccessPointMac(access_point) + "/" + std::to_string(rssi);
+        }
+        return path;
+    }
+
+    Clock::duration Interval(uint32_t interval_ms)
+    {
+        int32_t                                jitter = static_cast<int32_t>(options_.wake_jitter_ms);
+        std::uniform_int_distribution<int32_t> offset(-jitter, jitter);
+        int32_t                                next = static_cast<int32_t>(interval_ms) + offset(random_);
+        return std::chrono::milliseconds(std::max(1, next));
+    }
+
+    void Issue(Route route, Clock::time_point due, const std::string& request)
+    {
+        RouteStats&       stats = stats_[route];
+        Clock::time_point sent  = Clock::now();
+        int               status;
+        if (!connection_.Exchange(request, status))
+        {
+            ++stats.failed;
+            return;
+        }
+        Clock::time_point answered = Clock::now();
+
+        if (status >= 200 && status < 300)
+            ++stats.ok;
+        else if (status == 429 || status == 503)
+            ++stats.rejected;
+        else
+            ++stats.failed;
+        stats.latency_us.push_back(Microseconds(answered - due));
+        stats.service_us.push_back(Microseconds(answered - sent));
+    }
+
+    static uint32_t Microseconds(Clock::duration duration)
+    {
+        return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
+    }
+
+    const Options&                                                      options_;
+    Connection                                                          connection_;
+    std::mt19937                                                        random_;
+    std::priority_queue<Actor, std::vector<Actor>, std::greater<Actor>> schedule_;
+    std::vector<RouteStats>                                             stats_;
+};
+
+double Percentile(const std::vector<uint32_t>& sorted, double fraction)
+{
+    if (sorted.empty())
+        return 0.0;
+    size_t rank = static_cast<size_t>(fraction * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[rank] / 1000.0;
+}
+
+void PrintLatencies(const char* name, std::vector<uint32_t>& latencies)
+{
+    std::sort(latencies.begin(), latencies.end());
+    printf("  %-8s p50 %8.2f  p90 %8.2f  p99 %8.2f  p99.9 %8.2f  max %8.2f ms\n",
+           name,
+           Percentile(latencies, 0.5),
+           Percentile(latencies, 0.9),
+           Percentile(latencies, 0.99),
+           Percentile(latencies, 0.999),
+           Percentile(latencies, 1.0));
+}
+
+void Report(const std::vector<std::unique_ptr<Worker>>& workers, double seconds)
+{
+    for (int route = 0; route < ROUTE_COUNT; ++route)
+    {
+        RouteStats total;
+        for (auto const& worker : workers)
+        {
+            const RouteStats& stats = worker->stats()[route];
+            total.ok += stats.ok;
+            total.rejected += stats.rejected;
+            total.failed += stats.failed;
+            total.latency_us.insert(total.latency_us.end(), stats.latency_us.begin(), stats.latency_us.end());
+            total.service_us.insert(total.service_us.end(), stats.service_us.begin(), stats.service_us.end());
+        }
+        uint64_t requests = total.ok + total.rejected + total.failed;
+        if (requests == 0)
+            continue;
+
+        printf("%s: %" PRIu64 " requests, %.1f/s, %" PRIu64 " ok, %" PRIu64 " rejected, %" PRIu64 " failed\n",
+               kRouteNames[route],
+               requests,
+               requests / seconds,
+               total.ok,
+               total.rejected,
+               total.failed);
+        PrintLatencies("latency", total.latency_us);
+        PrintLatencies("service", total.service_us);
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    enum
+    {
+        OPT_ADDRESS = 256,
+        OPT_PORT,
+        OPT_THREADS,
+        OPT_DURATION,
+        OPT_NODES,
+        OPT_WAKE_INTERVAL,
+        OPT_WAKE_JITTER,
+        OPT_READINGS,
+        OPT_APPS,
+        OPT_APP_INTERVAL,
+        OPT_RESOLVE_PERCENT,
+        OPT_SEED
+    };
+
+    static const struct option long_options[]
+        = { { "address", required_argument, nullptr, OPT_ADDRESS },
+            { "port", required_argument, nullptr, OPT_PORT },
+            { "threads", required_argument, nullptr, OPT_THREADS },
+            { "duration", required_argument, nullptr, OPT_DURATION },
+            { "nodes", required_argument, nullptr, OPT_NODES },
+            { "wake-interval", required_argument, nullptr, OPT_WAKE_INTERVAL },
+            { "wake-jitter", required_argument, nullptr, OPT_WAKE_JITTER },
+            { "readings", required_argument, nullptr, OPT_READINGS },
+            { "apps", required_argument, nullptr, OPT_APPS },
+            { "app-interval", required_argument, nullptr, OPT_APP_INTERVAL },
+            { "resolve-percent", required_argument, nullptr, OPT_RESOLVE_PERCENT },
+            { "seed", required_argument, nullptr, OPT_SEED },
+            { nullptr, 0, nullptr, 0 } };
+
+    Options options;
+    int     opt;
+    while ((opt = getopt_long(argc, argv, "", long_options, nullptr)) != -1)
+    {
+        switch (opt)
+        {
+            case OPT_ADDRESS:
+                options.address = optarg;
+                break;
+            case OPT_PORT:
+                options.port = static_cast<uint16_t>(std::stoul(optarg));
+                break;
+            case OPT_THREADS:
+                options.threads = std::max(1u, static_cast<uint32_t>(std::stoul(optarg)));
+                break;
+            case OPT_DURATION:
+                options.duration_s = static_cast<uint32_t>(std::stoul(optarg));
+                break;
+            case OPT_NODES:
+                options.nodes = static_cast<uint32_t>(std::stoul(optarg));
+                break;
+            case OPT_WAKE_INTERVAL:
+                options.wake_interval_ms = static_cast<uint32_t>(std::stoul(optarg));
+                break;
+            case OPT_WAKE_JITTER:
+                options.wake_jitter_ms = static_cast<uint32_t>(std::stoul(optarg));
+                break;
+            case OPT_READINGS:
+                options.readings = std::min(kMaxReadings, std::max(1u, static_cast<uint32_t>(std::stoul(optarg))));
+                break;
+            case OPT_APPS:
+                options.apps = static_cast<uint32_t>(std::stoul(optarg));
+                break;
+            case OPT_APP_INTERVAL:
+                options.app_interval_ms = static_cast<uint32_t>(std::stoul(optarg));
+                break;
+            case OPT_RESOLVE_PERCENT:
+                options.resolve_percent = std::min(100u, static_cast<uint32_t>(std::stoul(optarg)));
+                break;
+            case OPT_SEED:
+                options.seed = static_cast<uint32_t>(std::stoul(optarg));
+                break;
+            default:
+                std::cerr << "usage: " << argv[0] << " [--address <ipv4>] [--port <port>] [--threads <count>]"
+                          << " [--duration <seconds>] [--nodes <count>] [--wake-interval <ms>] [--wake-jitter <ms>]"
+                          << " [--readings <per upload>] [--apps <count>] [--app-interval <ms>]"
+                          << " [--resolve-percent <percent>] [--seed <seed>]" << std::endl;
+                return 1;
+        }
+    }
+
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port   = htons(options.port);
+    if (inet_pton(AF_INET, options.address.c_str(), &address.sin_addr) != 1)
+    {
+        std::cerr << "invalid address " << options.address << std::endl;
+        return 1;
+    }
+
+    printf("%u nodes every %u+-%u ms, %u app users every %u+-%u ms (%u%% resolves), %u threads, %u s\n",
+           options.nodes,
+           options.wake_interval_ms,
+           options.wake_jitter_ms,
+           options.apps,
+           options.app_interval_ms,
+           options.wake_jitter_ms,
+           options.resolve_percent,
+           options.threads,
+           options.duration_s);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    for (uint32_t thread = 0; thread < options.threads; ++thread)
+        workers.emplace_back(new Worker(options, address, thread));
+
+    Clock::time_point        start = Clock::now();
+    Clock::time_point        end   = start + std::chrono::seconds(options.duration_s);
+    std::vector<std::thread> threads;
+    for (auto& worker : workers)
+        threads.emplace_back(&Worker::Run, worker.get(), end);
+    for (auto& thread : threads)
+        thread.join();
+
+    Report(workers, std::chrono::duration<double>(Clock::now() - start).count());
+    return 0;
+}
@@ -0,0 +1,114 @@
+/*************************************************************************************************************************
+ * 			FILENAME :- InsNodePool.h
+ *
+ * Description :- The module contains a slab pool for insNode_t device blocks. Blocks are carved out of large slabs and
+ * 					recycled through a free list, so device churn does not fault in fresh pages or fragment the heap.
+ * 					Slabs are only returned to the system when the pool is destroyed.
+ ************************************************************************************************************************/
+
+#ifndef INS_NODE_POOL_H
+#define INS_NODE_POOL_H
+
+#include <stdint.h>
+#include <WifiNode.h>
+
+/************************************************************************************************************************
+ *
+ * 		CONSTANTS
+ *
+ ************************************************************************************************************************/
+#define INS_NODE_POOL_SLAB_BLOCKS 16
+
+
+/************************************************************************************************************************
+ *
+ * 		TYPES
+ *
+ ************************************************************************************************************************/
+typedef struct insNodePoolStats_tag
+{
+	uint32_t slabs;
+	uint32_t capacity;
+	uint32_t inUse;
+	uint32_t highWater;
+	uint64_t allocations;
+	uint64_t releases;
+}insNodePoolStats_t;
+
+
+/************************************************************************************************************************
+ *
+ * 		FUNCTIONS
+ *
+ ************************************************************************************************************************/
+
+
+/************************************************************************************************************************
+ *  Function          := insNodePoolInit
+ *  Description       :=
+ *  					 Sets the number of blocks per slab and grows the pool until it holds prefaultBlocks blocks, writing
+ *  					 to every one of them so their pages are resident before the first device reports. The pool is
+ *  					 also usable without calling this, with INS_NODE_POOL_SLAB_BLOCKS blocks per slab.
+ *
+ *  parameters input(s)  :=
+ *  					    number of insNode_t blocks per slab.
+ *  					    number of blocks to pre-fault, zero to skip.
+ *  parameters output    :=
+ *  					    returns a zero on success and a non zero if memory could not be allocated.
+ ************************************************************************************************************************/
+uint32_t insNodePoolInit(uint32_t blocksPerSlab, uint32_t prefaultBlocks);
+
+
+/************************************************************************************************************************
+ *  Function          := insNodePoolAlloc
+ *  Description       :=
+ *  					 Takes an insNode_t block from the pool, growing it by one slab when the free list is empty.
+ *  					 The block holds whatever it held before, InsNodeDefine() initialises it.
+ *
+ *  parameters input(s)  :=
+ *  					    void.
+ *  parameters output    :=
+ *  					    pointer to the block, NULL if memory could not be allocated.
+ ************************************************************************************************************************/
+insNode_t * insNodePoolAlloc(void);
+
+
+/************************************************************************************************************************
+ *  Function          := insNodePoolFree
+ *  Description       :=
+ *  					 Returns a block taken with insNodePoolAlloc to the free list.
+ *
+ *  parameters input(s)  :=
+ *  					    pointer to the insNode_t block.
+ *  parameters output    :=
+ *  					    returns a zero on success and a non zero if the block does not belong to the pool.
+ ************************************************************************************************************************/
+uint32_t insNodePoolFree(insNode_t * insNodeBlock);
+
+
+/************************************************************************************************************************
+ *  Function          := insNodePoolGetStats
+ *  Description       :=
+ *  					 Copies the usage statistics of the pool.
+ *
+ *  parameters input(s)  :=
+ *  					    pointer to the statistics to fill.
+ *  parameters output    :=
+ *  					    void returned.
+ ************************************************************************************************************************/
+void insNodePoolGetStats(insNodePoolStats_t * stats);
+
+
+/************************************************************************************************************************
+ *  Function          := insNodePoolDestroy
+ *  Description       :=
+ *  					 Releases every slab and resets the statistics. Only allowed while no block is in use.
+ *
+ *  parameters input(s)  :=
+ *  					    void.
+ *  parameters output    :=
+ *  					    returns a zero on success and a non zero if blocks are still in use.
+ ************************************************************************************************************************/
+uint32_t insNodePoolDestroy(void);
+
+#endif // INS_NODE_POOL_H
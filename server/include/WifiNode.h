@@ -104,6 +104,14 @@ typedef struct insNode_tag
 	void * next;
 }insNode_t;
 
+typedef enum insStage_tag
+{
+	INS_STAGE_FILTER,	/* kalman filter and path loss of every wifi node */
+	INS_STAGE_SOLVE		/* trilateration */
+}insStage_t;
+
+typedef void (* insStageTimer_t)(insStage_t stage, long durationNs);
+
 
 /************************************************************************************************************************
  *
@@ -127,6 +135,20 @@ typedef struct insNode_tag
 float * GetCartesianPosition(insNode_t * insNodeBlock);
 
 
+/************************************************************************************************************************
+ *  Function          := insSetStageTimer
+ *  Description       :=
+ *  					 This function registers a callback that GetCartesianPosition() reports the duration of each of
+ *  					 its stages to, in nanoseconds, right as the stage ends. A NULL timer stops the reports.
+ *
+ *  parameters input(s)  :=
+ *  					    insStageTimer_t
+ *  parameters output    :=
+ *  					    void.
+ ************************************************************************************************************************/
+void insSetStageTimer(insStageTimer_t timer);
+
+
 /************************************************************************************************************************
  *  Function          := createInsNodeListDevice
  *  Description       :=
@@ -141,6 +163,20 @@ float * GetCartesianPosition(insNode_t * insNodeBlock);
 insNode_t *  createInsNodeListDevice(const char * deviceId);
 
 
+/************************************************************************************************************************
+ *  Function          := removeInsNodeListDevice
+ *  Description       :=
+ *  					 This function unlinks the ins node block of the given device ID from the ins node list in memory
+ *  					 and frees it. The root block is never removed.
+ *
+ *  parameters input(s)  :=
+ *  					    device ID, which is in principle the mac address of the ins node.
+ *  parameters output    :=
+ *  					    returns a zero on success and a non zero if the device was not found.
+ ************************************************************************************************************************/
+uint32_t removeInsNodeListDevice(const char * deviceId);
+
+
 /************************************************************************************************************************
  *  Function          := computePLProcess
  *  Description       :=
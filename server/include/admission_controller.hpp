@@ -0,0 +1,100 @@
+#ifndef INS_SERVER_INS_INCLUDE_ADMISSION_CONTROLLER_HPP
+#define INS_SERVER_INS_INCLUDE_ADMISSION_CONTROLLER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace ins_service
+{
+
+#ifdef ENABLE_TESTS
+class AdmissionControllerFixture;
+#endif // ENABLE_TESTS
+
+// Requests admitted against separate limits, highest priority first.
+enum class RouteClass
+{
+    kInteractive, // position lookups and employee search from the apps
+    kDevice,      // position resolution and resets
+    kIngest,      // RSSI uploads
+};
+
+/**
+ * Caps the number of requests of each route class in flight, from acceptance to response.
+ *
+ * A request over its class limit is shed right away, the client is answered with 503 and a
+ * Retry-After hint instead of waiting in a queue that grows without bound. Lower classes also give
+ * way while a higher class is more than half full, so a fleet-wide upload burst is shed before app
+ * lookups start queueing behind it.
+ */
+class AdmissionController
+{
+public:
+#ifdef ENABLE_TESTS
+    friend class AdmissionControllerFixture;
+#endif // ENABLE_TESTS
+
+    static const size_t kRouteClasses = 3;
+
+    // Holds one in-flight slot of a class until destroyed.
+    class Ticket
+    {
+    public:
+        ~Ticket()
+        {
+            --in_flight_;
+        }
+
+        Ticket(const Ticket&) = delete;
+        Ticket& operator=(const Ticket&) = delete;
+
+    private:
+        friend class AdmissionController;
+
+        explicit Ticket(std::atomic<uint32_t>& in_flight)
+            : in_flight_(in_flight)
+        {
+        }
+
+        std::atomic<uint32_t>& in_flight_;
+    };
+
+    AdmissionController(uint32_t interactive_limit, uint32_t device_limit, uint32_t ingest_limit);
+
+    AdmissionController(const AdmissionController&) = delete;
+    AdmissionController& operator=(const AdmissionController&) = delete;
+
+    // Admits a request of route_class; nullptr when it has to be shed. Shared so that it can travel
+    // with the request through the task queues.
+    std::shared_ptr<Ticket> Admit(RouteClass route_class);
+
+    // Seconds a shed client of route_class is asked to wait before retrying.
+    uint32_t RetryAfter(RouteClass route_class);
+
+    uint32_t InFlight(RouteClass route_class) const
+    {
+        return in_flight_[Index(route_class)].load();
+    }
+
+    uint64_t Shed(RouteClass route_class) const
+    {
+        return shed_[Index(route_class)].load();
+    }
+
+private:
+    static size_t Index(RouteClass route_class)
+    {
+        return static_cast<size_t>(route_class);
+    }
+
+    uint32_t              limits_[kRouteClasses];
+    std::atomic<uint32_t> in_flight_[kRouteClasses];
+    std::atomic<uint64_t> shed_[kRouteClasses];
+    std::atomic<uint32_t> retries_;
+};
+
+} // namespace ins_service
+
+#endif // INS_SERVER_INS_INCLUDE_ADMISSION_CONTROLLER_HPP
@@ -0,0 +1,184 @@
+#ifndef INS_SERVER_INS_INCLUDE_ARENA_HPP
+#define INS_SERVER_INS_INCLUDE_ARENA_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace ins_service
+{
+
+#ifdef ENABLE_TESTS
+class ArenaFixture;
+#endif // ENABLE_TESTS
+
+/**
+ * Bump allocator for short-lived, request scoped data.
+ *
+ * Memory is carved out of large blocks and never freed individually; Rewind() drops everything
+ * allocated after a mark in one go. Blocks are kept for reuse after a rewind, so a worker thread
+ * that handles similar requests stops calling malloc once its arena has warmed up. Only blocks
+ * beyond the retained budget are returned to the system when the arena is rewound to empty.
+ *
+ * An arena is not thread safe, use one per thread (see ThreadArena()).
+ */
+class Arena
+{
+public:
+#ifdef ENABLE_TESTS
+    friend class ArenaFixture;
+#endif // ENABLE_TESTS
+
+    struct Mark
+    {
+        size_t block;
+        size_t offset;
+    };
+
+    static const size_t kDefaultBlockSize = 64 * 1024;
+    static const size_t kRetainedBytes    = 1024 * 1024;
+
+    explicit Arena(size_t block_size = kDefaultBlockSize)
+        : block_size_(block_size)
+        , current_(0)
+        , offset_(0)
+    {
+    }
+
+    ~Arena();
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    // NUL-terminated copy of length bytes at data.
+    const char* CopyString(const char* data, size_t length);
+
+    const char* CopyString(const std::string& text)
+    {
+        return CopyString(text.data(), text.size());
+    }
+
+    Mark GetMark() const
+    {
+        return Mark{ current_, offset_ };
+    }
+
+    void Rewind(const Mark& mark);
+
+    size_t BytesReserved() const;
+
+private:
+    struct Block
+    {
+        char*  data;
+        size_t size;
+    };
+
+    std::vector<Block> blocks_;
+    size_t             block_size_;
+    size_t             current_;
+    size_t             offset_;
+};
+
+/**
+ * Standard allocator handing out arena memory; deallocate is a no-op. Containers using it must not
+ * outlive the scope that rewinds their arena.
+ */
+template <typename T>
+class ArenaAllocator
+{
+public:
+    typedef T value_type;
+
+    explicit ArenaAllocator(Arena& arena) noexcept
+        : arena_(&arena)
+    {
+    }
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept
+        : arena_(other.arena_)
+    {
+    }
+
+    T* allocate(size_t count)
+    {
+        return static_cast<T*>(arena_->Allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T*, size_t) noexcept
+    {
+    }
+
+    Arena& arena() const
+    {
+        return *arena_;
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const
+    {
+        return arena_ == other.arena_;
+    }
+
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const
+    {
+        return arena_ != other.arena_;
+    }
+
+private:
+    template <typename U>
+    friend class ArenaAllocator;
+
+    Arena* arena_;
+};
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+// The calling thread's arena, shared by every ArenaScope opened on that thread.
+Arena& ThreadArena();
+
+/**
+ * Rewinds an arena to where it was when the scope was opened. Scopes nest, so a callee can open its
+ * own scope on the thread arena without disturbing allocations made by its caller.
+ */
+class ArenaScope
+{
+public:
+    explicit ArenaScope(Arena& arena = ThreadArena())
+        : arena_(arena)
+        , mark_(arena.GetMark())
+    {
+    }
+
+    ~ArenaScope()
+    {
+        arena_.Rewind(mark_);
+    }
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+    Arena& arena() const
+    {
+        return arena_;
+    }
+
+    template <typename T>
+    ArenaAllocator<T> Allocator() const
+    {
+        return ArenaAllocator<T>(arena_);
+    }
+
+private:
+    Arena&      arena_;
+    Arena::Mark mark_;
+};
+
+} // namespace ins_service
+
+#endif // INS_SERVER_INS_INCLUDE_ARENA_HPP
@@ -0,0 +1,18 @@
+#ifndef INS_SERVER_INS_INCLUDE_CHECKSUM_HPP
+#define INS_SERVER_INS_INCLUDE_CHECKSUM_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ins_service
+{
+
+/**
+ * CRC-32 (IEEE 802.3, as used by zlib) of length bytes at data. Pass the previous result as crc to
+ * checksum a buffer in several pieces.
+ */
+uint32_t Crc32(const void* data, size_t length, uint32_t crc = 0);
+
+} // namespace ins_service
+
+#endif // INS_SERVER_INS_INCLUDE_CHECKSUM_HPP
@@ -0,0 +1,143 @@
+#ifndef INS_SERVER_INS_INCLUDE_COROUTINE_HPP
+#define INS_SERVER_INS_INCLUDE_COROUTINE_HPP
+
+// Building blocks of the coroutine request pipeline, only available in the C++20 build
+// (-DINS_ENABLE_COROUTINES=ON).
+#ifdef INS_ENABLE_COROUTINES
+
+#include <coroutine>
+#include <exception>
+
+#include "device_executor.hpp"
+#include "storage_writer.hpp"
+
+namespace ins_service
+{
+
+/**
+ * Coroutine that starts right away and owns its frame: nobody awaits it and the frame is freed when
+ * it returns. Request handlers use it to continue a request after the HTTP thread moved on; they
+ * answer their request when it fails, an exception that still escapes is only logged.
+ */
+class DetachedTask
+{
+public:
+    struct promise_type
+    {
+        DetachedTask get_return_object() noexcept
+        {
+            return DetachedTask();
+        }
+
+        std::suspend_never initial_suspend() noexcept
+        {
+            return {};
+        }
+
+        std::suspend_never final_suspend() noexcept
+        {
+            return {};
+        }
+
+        void return_void() noexcept
+        {
+        }
+
+        void unhandled_exception() noexcept
+        {
+            auto console = spdlog::get(LOGGER_NAME);
+            if (console == nullptr)
+                return;
+            try
+            {
+                throw;
+            }
+            catch (const std::exception& e)
+            {
+                console->error("Detached coroutine failed: {0}", e.what());
+            }
+            catch (...)
+            {
+                console->error("Detached coroutine failed with an unknown exception");
+            }
+        }
+    };
+};
+
+/**
+ * Resumes the coroutine as an operation of the device, on the shard running its actor. Yields true
+ * once running there, false without suspending when the executor is saturated.
+ */
+class ResumeOnDevice
+{
+public:
+    ResumeOnDevice(DeviceExecutor& executor, const DeviceId& device_id)
+        : executor_(executor)
+        , device_id_(device_id)
+        , posted_(true)
+    {
+    }
+
+    bool await_ready() const noexcept
+    {
+        return false;
+    }
+
+    bool await_suspend(std::coroutine_handle<> handle)
+    {
+        // The coroutine may already run (and finish) on a shard before TryPost() returns, so the
+        // awaiter is only touched again when posting failed.
+        if (!executor_.TryPost(device_id_, [handle] { handle.resume(); }))
+        {
+            posted_ = false;
+            return false;
+        }
+        return true;
+    }
+
+    bool await_resume() const noexcept
+    {
+        return posted_;
+    }
+
+private:
+    DeviceExecutor& executor_;
+    DeviceId        device_id_;
+    bool            posted_;
+};
+
+/**
+ * Suspends until every upload queued on the storage writer so far is stored, then resumes on the
+ * storage thread. Callers hop back to their executor before doing real work.
+ */
+class ResumeWhenStored
+{
+public:
+    explicit ResumeWhenStored(StorageWriter& writer)
+        : writer_(writer)
+    {
+    }
+
+    bool await_ready() const noexcept
+    {
+        return false;
+    }
+
+    void await_suspend(std::coroutine_handle<> handle)
+    {
+        writer_.OnStored([handle] { handle.resume(); });
+    }
+
+    void await_resume() const noexcept
+    {
+    }
+
+private:
+    StorageWriter& writer_;
+};
+
+} // namespace ins_service
+
+#endif // INS_ENABLE_COROUTINES
+
+#endif // INS_SERVER_INS_INCLUDE_COROUTINE_HPP
@@ -0,0 +1,53 @@
+#ifndef INS_SERVER_INS_INCLUDE_DATA_ARCHIVE_HPP
+#define INS_SERVER_INS_INCLUDE_DATA_ARCHIVE_HPP
+
+#include <memory>
+#include <spdlog/spdlog.h>
+#include <string>
+
+#include "data_store.hpp"
+#include "types.hpp"
+
+namespace ins_service
+{
+
+#ifdef ENABLE_TESTS
+class DataArchiveFixture;
+#endif // ENABLE_TESTS
+
+/**
+ * Streams the whole dataset (access points, locations and every device's readings) to and from a
+ * compact binary archive.
+ *
+ * The archive is a header followed by blocks of at most a few thousand rows. Each block stores its
+ * rows column by column and carries a CRC-32 of its payload, so memory use is bounded by one block
+ * regardless of the dataset size. Import loads the whole archive in one transaction and rolls it back
+ * on the first corrupt or truncated block, so a failed import can be re-run as is.
+ */
+class DataArchive
+{
+public:
+#ifdef ENABLE_TESTS
+    friend class DataArchiveFixture;
+#endif // ENABLE_TESTS
+
+    explicit DataArchive(std::shared_ptr<DataStore> data_store)
+        : data_store_(data_store)
+        , console_(spdlog::get(LOGGER_NAME))
+    {
+        if (console_ == nullptr)
+            console_ = spdlog::stdout_logger_mt(LOGGER_NAME);
+    }
+
+    bool Export(const std::string& filename);
+
+    bool Import(const std::string& filename);
+
+private:
+    std::shared_ptr<DataStore>      data_store_;
+    std::shared_ptr<spdlog::logger> console_;
+};
+
+} // namespace ins_service
+
+#endif // INS_SERVER_INS_INCLUDE_DATA_ARCHIVE_HPP
@@ -5,6 +5,7 @@
 #ifndef INS_SERVER_INS_INCLUDE_DATA_STORE_HPP
 #define INS_SERVER_INS_INCLUDE_DATA_STORE_HPP
 
+#include <functional>
 #include <iostream>
 #include <spdlog/spdlog.h>
 #include <sqlite3.h>
@@ -18,6 +19,13 @@ namespace ins_service
 class DataStoreFixture;
 #endif // ENABLE_TESTS
 
+// Row visitors used to stream query results without materializing them.
+typedef std::function<void(const char* mac_addr)>            AccessPointVisitor;
+typedef std::function<void(int32_t rssi)>                    RssiVisitor;
+typedef std::function<void(const StoredReading& reading)>    ReadingVisitor;
+typedef std::function<void(const StoredLocation& location)>  LocationVisitor;
+typedef std::function<void(const AccessPoint& access_point)> AccessPointPositionVisitor;
+
 class DataStore
 {
 public:
@@ -43,18 +51,65 @@ public:
 
     bool InsertRSSIReadings(const std::string& device_id, std::vector<AccessPointRssiPair> accesspoint_rssi_pair_list);
 
+    bool InsertRSSIReadings(const std::string& device_id, const RssiReading* readings, size_t count);
+
     bool GetPosition(const std::string& id, QueryT queryby, Position& pos);
 
+    std::vector<std::string> GetEmployeeIds();
+
     bool CreateDeviceTable(const std::string& device_id);
 
     bool ClearDeviceTable(const std::string& device_id);
 
+    bool VisitDistinctAccessPoints(const std::string& device_id, const AccessPointVisitor& visitor);
+
+    bool VisitRSSISeries(const std::string& device_id, const AccessPoint& access_point, const RssiVisitor& visitor);
+
+    bool GetDistinctAccessPoints(const std::string& device_id, std::vector<AccessPoint>& access_points);
+
+    bool GetRSSISeriesFromDatabase(const std::string&    device_id,
+                                   const AccessPoint&    access_point,
+                                   std::vector<int32_t>& rssi_list);
+
+    bool GetRSSISeriesData(const std::string&                    device_id,
+                           const std::vector<AccessPoint>&       access_points,
+                           std::vector<AccessPointRssiListPair>& series);
+
+    // Groups every reading of the device by access point in a single scan, allocating from the arena
+    // of series.
+    bool CollectRSSISeries(const std::string& device_id, ArenaVector<RssiSeries>& series);
+
+    bool GetDeviceIds(std::vector<std::string>& device_ids);
+
+    bool VisitReadings(const std::string& device_id, const ReadingVisitor& visitor);
+
+    bool VisitLocations(const LocationVisitor& visitor);
+
+    bool VisitAccessPoints(const AccessPointPositionVisitor& visitor);
+
+    bool BeginTransaction();
+
+    bool CommitTransaction();
+
+    bool RollbackTransaction();
+
+    // Runs body in one transaction and keeps the connection to this thread until it commits, so writes of
+    // other threads cannot land in it. Rolls back when body fails; false when the transaction could not be
+    // opened, body failed or the commit failed.
+    bool RunInTransaction(const std::function<bool()>& body);
+
+    bool InsertReadings(const std::string& device_id, const std::vector<StoredReading>& readings);
+
+    bool InsertLocations(const std::vector<StoredLocation>& locations);
+
+    bool InsertAccessPoints(const std::vector<AccessPoint>& access_points);
+
     std::vector<AccessPoint> GetDistinctAccessPoints(const std::string& device_id);
 
-    std::vector<int32_t> GetRSSISeriesFromDatabase(const std::string& device_id, AccessPoint access_point);
+    std::vector<int32_t> GetRSSISeriesFromDatabase(const std::string& device_id, const AccessPoint& access_point);
 
-    std::vector<AccessPointRssiListPair> GetRSSISeriesData(const std::string&       device_id,
-                                                           std::vector<AccessPoint> access_points);
+    std::vector<AccessPointRssiListPair> GetRSSISeriesData(const std::string&              device_id,
+                                                           const std::vector<AccessPoint>& access_points);
 
 private:
     bool CreateLocationTable();
@@ -63,10 +118,14 @@ private:
 
     bool RunQuery(const std::string& sql);
 
-    static int DbCallback(void* not_used, int argc, char** argv, char** azColName);
+    bool RunQuery(const char* sql);
+
+    bool RunStatement(const std::string& sql, const std::function<bool(sqlite3_stmt*)>& on_row);
+
+    bool RunBatch(const std::string& sql, size_t rows, const std::function<void(sqlite3_stmt*, size_t)>& bind);
 
     sqlite3*                        database_;
-    std::mutex                      database_lock_;
+    std::recursive_mutex            database_lock_;
     std::shared_ptr<spdlog::logger> console_;
 
 // Used for making sql variable passed to RunQuery() readable for UT purpose.
@@ -0,0 +1,139 @@
+#ifndef INS_SERVER_INS_INCLUDE_DEVICE_EXECUTOR_HPP
+#define INS_SERVER_INS_INCLUDE_DEVICE_EXECUTOR_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <spdlog/spdlog.h>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "types.hpp"
+
+namespace ins_service
+{
+
+#ifdef ENABLE_TESTS
+class DeviceExecutorFixture;
+#endif // ENABLE_TESTS
+
+struct DeviceExecutorStats
+{
+    uint64_t executed;
+    uint64_t stolen;
+    size_t   actors;
+    size_t   pending;
+};
+
+/**
+ * Runs device operations on a fixed set of shard threads, one device at a time.
+ *
+ * Every device is an actor with its own mailbox. An actor with pending work sits in the run queue of
+ * exactly one shard, its home shard chosen by device hash, and only the shard that dequeued it runs
+ * its tasks, in submission order. Operations on one device are therefore serialized without a lock
+ * around the device state, while different devices run in parallel. Posting still takes the lock of
+ * the actor table, which only lives as long as the device has work queued: an actor whose mailbox
+ * runs dry is dropped, so the table is bounded by the pending operations, not by the devices seen. A shard whose run queue is empty steals
+ * runnable actors from the back of the other shards' queues, so a hot shard does not leave the other
+ * cores idle. Stealing moves whole actors, never single tasks, which keeps the per-device ordering.
+ * Shard threads run at bulk priority.
+ */
+class DeviceExecutor
+{
+public:
+#ifdef ENABLE_TESTS
+    friend class DeviceExecutorFixture;
+#endif // ENABLE_TESTS
+
+    typedef std::function<void()> Task;
+
+    // Tasks an actor runs before yielding its shard to the next runnable actor.
+    static const size_t kActorBudget = 16;
+
+    static const size_t kDefaultMaxPending = 4096;
+
+    explicit DeviceExecutor(size_t shard_count, size_t max_pending = kDefaultMaxPending);
+
+    ~DeviceExecutor()
+    {
+        Stop();
+    }
+
+    DeviceExecutor(const DeviceExecutor&) = delete;
+    DeviceExecutor& operator=(const DeviceExecutor&) = delete;
+
+    void Start();
+
+    // Stops the shard threads, then runs whatever is still queued on the calling thread.
+    void Stop();
+
+    // Queues task behind the pending operations of the device.
+    void Post(const DeviceId& device_id, Task task);
+
+    // Post() unless max_pending operations are already queued over all devices. Runs inline when the
+    // executor is not started.
+    bool TryPost(const DeviceId& device_id, Task task);
+
+    // Runs task on the device's actor and waits for it; exceptions are rethrown here. Runs inline when
+    // the executor is not started. Must not be called from a device task.
+    void Execute(const DeviceId& device_id, const Task& task);
+
+    size_t ShardOf(const DeviceId& device_id) const;
+
+    size_t ShardCount() const
+    {
+        return shards_.size();
+    }
+
+    DeviceExecutorStats GetStats() const;
+
+private:
+    struct Actor
+    {
+        std::mutex       lock;
+        std::deque<Task> mailbox;
+        bool             scheduled;
+        size_t           home;
+        DeviceId         device_id;
+    };
+
+    struct Shard
+    {
+        std::mutex              lock;
+        std::condition_variable ready;
+        std::deque<Actor*>      runnable;
+        std::thread             thread;
+    };
+
+    Actor* FindActor(const DeviceId& device_id);
+
+    bool Retire(Actor* actor);
+
+    void Schedule(Actor* actor);
+
+    Actor* NextActor(size_t shard);
+
+    void RunActor(Actor* actor);
+
+    void RunShard(size_t shard);
+
+    std::vector<std::unique_ptr<Shard>>                  shards_;
+    mutable std::mutex                                   actors_lock_;
+    std::unordered_map<DeviceId, std::unique_ptr<Actor>> actors_;
+    std::atomic<bool>                                    running_;
+    std::atomic<bool>                                    stop_;
+    std::atomic<uint64_t>                                executed_;
+    std::atomic<uint64_t>                                stolen_;
+    std::atomic<size_t>                                  next_thief_;
+    size_t                                               max_pending_;
+    std::atomic<size_t>                                  pending_;
+    std::shared_ptr<spdlog::logger>                      console_;
+};
+
+} // namespace ins_service
+
+#endif // INS_SERVER_INS_INCLUDE_DEVICE_EXECUTOR_HPP
@@ -0,0 +1,100 @@
+#ifndef INS_SERVER_INS_INCLUDE_DEVICE_RATE_LIMITER_HPP
+#define INS_SERVER_INS_INCLUDE_DEVICE_RATE_LIMITER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <spdlog/spdlog.h>
+#include <unordered_map>
+
+#include "types.hpp"
+
+namespace ins_service
+{
+
+#ifdef ENABLE_TESTS
+class DeviceRateLimiterFixture;
+#endif // ENABLE_TESTS
+
+/**
+ * Token bucket per device for RSSI uploads.
+ *
+ * Every device may upload rate times per second on average and burst times in a row. Buckets are
+ * spread over kStripes independently locked maps, so checks of different devices rarely contend and
+ * none of them touches the engine lock. Once a stripe tracks more than kMaxBucketsPerStripe devices,
+ * buckets of devices that have been quiet long enough to be full again are dropped.
+ */
+class DeviceRateLimiter
+{
+public:
+#ifdef ENABLE_TESTS
+    friend class DeviceRateLimiterFixture;
+#endif // ENABLE_TESTS
+
+    typedef std::chrono::steady_clock Clock;
+
+    static const size_t kStripes             = 64;
+    static const size_t kMaxBucketsPerStripe = 4096;
+
+    // A rate of 0 admits everything.
+    DeviceRateLimiter(double rate, double burst);
+
+    DeviceRateLimiter(const DeviceRateLimiter&) = delete;
+    DeviceRateLimiter& operator=(const DeviceRateLimiter&) = delete;
+
+    // Takes one token of the device's bucket; false when the device is over its rate.
+    bool TryAcquire(const DeviceId& device_id, Clock::time_point now);
+
+    bool TryAcquire(const DeviceId& device_id)
+    {
+        return TryAcquire(device_id, Clock::now());
+    }
+
+    // Seconds until a throttled device has a token again, at least 1.
+    uint32_t RetryAfter() const;
+
+    // Uploads rejected since start.
+    uint64_t Throttled() const
+    {
+        return throttled_.load();
+    }
+
+    // Uploads of device_id rejected since its bucket was created.
+    uint64_t Throttled(const DeviceId& device_id) const;
+
+    size_t BucketCount() const;
+
+private:
+    struct Bucket
+    {
+        double            tokens;
+        Clock::time_point refilled;
+        uint64_t          throttled;
+    };
+
+    struct Stripe
+    {
+        mutable std::mutex                   lock;
+        std::unordered_map<DeviceId, Bucket> buckets;
+    };
+
+    Stripe& StripeOf(const DeviceId& device_id) const
+    {
+        return stripes_[std::hash<DeviceId>()(device_id) % kStripes];
+    }
+
+    void Refill(Bucket& bucket, Clock::time_point now) const;
+
+    void PruneFullBuckets(Stripe& stripe, Clock::time_point now) const;
+
+    double                          rate_;
+    double                          burst_;
+    std::unique_ptr<Stripe[]>       stripes_;
+    std::atomic<uint64_t>           throttled_;
+    std::shared_ptr<spdlog::logger> console_;
+};
+
+} // namespace ins_service
+
+#endif // INS_SERVER_INS_INCLUDE_DEVICE_RATE_LIMITER_HPP
@@ -0,0 +1,60 @@
+#ifndef INS_SERVER_INS_INCLUDE_DEVICE_RECORD_HPP
+#define INS_SERVER_INS_INCLUDE_DEVICE_RECORD_HPP
+
+#include <cstdint>
+#include <type_traits>
+
+extern "C"
+{
+#include <WifiNode.h>
+}
+
+namespace ins_service
+{
+
+/**
+ * Compact, fixed-size copy of the persistent part of an insNode_t: identity, last position and the
+ * filter and path-loss state of each access point. Sample buffers and pointers are left out, the
+ * samples are reloaded from the database on every position computation.
+ */
+struct AccessPointRecord
+{
+    float    position[CARTESIANSIZE];
+    float    distance;
+    float    est_received_power;
+    uint32_t sample_count;
+    uint32_t processed_sample_count;
+    float    error_estimate;
+    float    error_measurement;
+    float    power_estimate;
+    float    estimate;
+    float    kalman_gain;
+    float    path_loss_exponent;
+    float    power_do;
+    float    do_distance;
+    float    power_d;
+    float    d_distance;
+};
+
+struct DeviceRecord
+{
+    char              dev_name[DEV_NAME];
+    char              mac_address[DEV_NAME];
+    uint32_t          device_no;
+    uint32_t          wifi_no;
+    float             position[CARTESIANSIZE];
+    AccessPointRecord access_points[MAXIMUM_NUMBER_NODES];
+};
+
+static_assert(std::is_trivially_copyable<DeviceRecord>::value, "DeviceRecord is written to disk as is");
+
+void ToDeviceRecord(const insNode_t* node, DeviceRecord& record);
+
+void FromDeviceRecord(const DeviceRecord& record, insNode_t* node);
+
+// A record read from disk is only usable if both names are NUL-terminated.
+bool IsValidDeviceRecord(const DeviceRecord& record);
+
+} // namespace ins_service
+
+#endif // INS_SERVER_INS_INCLUDE_DEVICE_RECORD_HPP
@@ -0,0 +1,113 @@
+#ifndef INS_SERVER_INS_INCLUDE_DEVICE_REGISTRY_HPP
+#define INS_SERVER_INS_INCLUDE_DEVICE_REGISTRY_HPP
+
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <spdlog/spdlog.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "device_record.hpp"
+#include "types.hpp"
+
+namespace ins_service
+{
+
+static_assert(DeviceId::kCapacity < DEV_NAME, "device ids must fit insNode_t::devName");
+
+#ifdef ENABLE_TESTS
+class DeviceRegistryFixture;
+#endif // ENABLE_TESTS
+
+/**
+ * Owns the insNoderoot device list and keeps at most max_resident devices in memory.
+ *
+ * Devices are kept in least-recently-active order. When a new or spilled device becomes active and
+ * the budget is exceeded, the least recently active unpinned device is written to the spill file as
+ * a DeviceRecord and its node is freed; it is read back the next time the device is acquired. The
+ * spill file only lives as long as the registry, the engine snapshot persists spilled devices.
+ *
+ * The registry guards its own bookkeeping. Calls that may add devices to or remove them from the
+ * insNoderoot list, Acquire() and Restore(), must run under the engine lock held exclusively; Touch()
+ * and Unpin() leave the list alone and need no engine lock.
+ */
+class DeviceRegistry
+{
+public:
+#ifdef ENABLE_TESTS
+    friend class DeviceRegistryFixture;
+#endif // ENABLE_TESTS
+
+    explicit DeviceRegistry(size_t max_resident, const std::string& spill_file)
+        : max_resident_(max_resident > 0 ? max_resident : 1)
+        , spill_file_(spill_file)
+        , spill_fd_(-1)
+        , slot_count_(0)
+        , console_(spdlog::get(LOGGER_NAME))
+    {
+        if (console_ == nullptr)
+            console_ = spdlog::stdout_logger_mt(LOGGER_NAME);
+    }
+
+    ~DeviceRegistry();
+
+    bool Init();
+
+    // Returns the resident node of device_id, creating or rehydrating it. A pinned device is never
+    // evicted until it is unpinned.
+    insNode_t* Acquire(const DeviceId& device_id, bool pin = false);
+
+    // Acquire() of a device that is already resident; false, without touching anything, otherwise.
+    bool Touch(const DeviceId& device_id, bool pin = false);
+
+    void Unpin(const DeviceId& device_id);
+
+    // Places a device read back from an engine snapshot, resident while the budget allows.
+    void Restore(const DeviceRecord& record);
+
+    // Visits every known device, resident ones first from most to least recently active. Resident nodes
+    // are copied with engine_lock held exclusively, spilled ones are read back after it is released.
+    void VisitRecords(std::shared_timed_mutex&                          engine_lock,
+                      const std::function<void(const DeviceRecord&)>& visitor);
+
+    size_t ResidentCount() const;
+
+    size_t SpilledCount() const;
+
+private:
+    struct Entry
+    {
+        insNode_t*                       node;
+        std::list<DeviceId>::iterator lru;
+        uint32_t                         pins;
+    };
+
+    insNode_t* MakeResident(const DeviceId& device_id, bool most_recent);
+
+    void EvictOverBudget();
+
+    bool Spill(const DeviceId& device_id, const DeviceRecord& record);
+
+    bool WriteSlot(uint32_t slot, const DeviceRecord& record);
+
+    bool ReadSlot(uint32_t slot, DeviceRecord& record);
+
+    size_t                                 max_resident_;
+    std::string                            spill_file_;
+    int                                    spill_fd_;
+    std::list<DeviceId>                    lru_;
+    std::unordered_map<DeviceId, Entry>    resident_;
+    std::unordered_map<DeviceId, uint32_t> spilled_;
+    std::vector<uint32_t>                  free_slots_;
+    uint32_t                               slot_count_;
+    mutable std::mutex                     lock_;
+    std::shared_ptr<spdlog::logger>        console_;
+};
+
+} // namespace ins_service
+
+#endif // INS_SERVER_INS_INCLUDE_DEVICE_REGISTRY_HPP
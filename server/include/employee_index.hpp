@@ -0,0 +1,102 @@
+#ifndef INS_SERVER_INS_INCLUDE_EMPLOYEE_INDEX_HPP
+#define INS_SERVER_INS_INCLUDE_EMPLOYEE_INDEX_HPP
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ins_service
+{
+
+#ifdef ENABLE_TESTS
+class EmployeeIndexFixture;
+#endif // ENABLE_TESTS
+
+class EmployeeMatch
+{
+public:
+    std::string employee_id;
+    double      score;
+};
+
+/**
+ * In-memory search index over the employee directory.
+ *
+ * Every key (employee id and, when known, display name) is stored lower-cased in a compressed
+ * trie for prefix lookups and in a trigram posting list for fuzzy lookups. Prefix matches always
+ * rank above fuzzy matches.
+ *
+ * The service fills it from the locations table at startup; archive imports run offline and are picked
+ * up on the next start.
+ */
+class EmployeeIndex
+{
+public:
+#ifdef ENABLE_TESTS
+    friend class EmployeeIndexFixture;
+#endif // ENABLE_TESTS
+
+    explicit EmployeeIndex()
+        : root_(new TrieNode())
+    {
+    }
+
+    void Insert(const std::string& employee_id, const std::string& name = std::string());
+
+    void Remove(const std::string& employee_id);
+
+    std::vector<EmployeeMatch> Search(const std::string& query, size_t max_results) const;
+
+    size_t Size() const;
+
+private:
+    struct TrieNode
+    {
+        std::string                            label;
+        std::vector<std::unique_ptr<TrieNode>> children;
+        std::vector<uint32_t>                  keys;
+    };
+
+    struct Key
+    {
+        std::string text;
+        uint32_t    entry;
+        uint32_t    trigram_count;
+    };
+
+    // Remove() with lock_ already held.
+    void RemoveLocked(const std::string& employee_id);
+
+    uint32_t AddKey(uint32_t entry, const std::string& text);
+
+    void DropKey(uint32_t key);
+
+    void TrieInsert(const std::string& text, uint32_t key);
+
+    void TrieErase(const std::string& text, uint32_t key);
+
+    const TrieNode* TrieFindPrefix(const std::string& prefix) const;
+
+    void CollectKeys(const TrieNode* node, std::vector<uint32_t>& keys, size_t max_entries) const;
+
+    static std::string Normalize(const std::string& text);
+
+    static std::vector<uint32_t> Trigrams(const std::string& text);
+
+    std::unique_ptr<TrieNode>                           root_;
+    std::vector<Key>                                    keys_;
+    std::vector<uint32_t>                               free_keys_;
+    std::vector<std::string>                            entries_;
+    std::vector<std::vector<uint32_t>>                  entry_keys_;
+    std::vector<uint32_t>                               free_entries_;
+    std::unordered_map<std::string, uint32_t>           entry_by_id_;
+    std::unordered_map<uint32_t, std::vector<uint32_t>> trigrams_;
+    mutable std::mutex                                  lock_;
+};
+
+} // namespace ins_service
+
+#endif // INS_SERVER_INS_INCLUDE_EMPLOYEE_INDEX_HPP
@@ -0,0 +1,54 @@
+#ifndef INS_SERVER_INS_INCLUDE_ENGINE_SNAPSHOT_HPP
+#define INS_SERVER_INS_INCLUDE_ENGINE_SNAPSHOT_HPP
+
+#include <memory>
+#include <shared_mutex>
+#include <spdlog/spdlog.h>
+#include <string>
+
+#include "device_registry.hpp"
+#include "types.hpp"
+
+namespace ins_service
+{
+
+#ifdef ENABLE_TESTS
+class EngineSnapshotFixture;
+#endif // ENABLE_TESTS
+
+/**
+ * Saves and restores the in-memory localization engine (every device known to the registry, resident
+ * or spilled, with its filter state and last computed position) so a restarted service is warm
+ * immediately.
+ *
+ * A snapshot is a fixed-size header followed by one DeviceRecord per device, protected by a CRC-32.
+ * Save writes to a temporary file and renames it over the previous snapshot; Restore maps the file
+ * read-only and validates it before handing the records to the registry. Both take engine_lock
+ * exclusively only while copying resident device state; spilled devices are read back from the spill
+ * file under the registry's own lock.
+ */
+class EngineSnapshot
+{
+public:
+#ifdef ENABLE_TESTS
+    friend class EngineSnapshotFixture;
+#endif // ENABLE_TESTS
+
+    explicit EngineSnapshot()
+        : console_(spdlog::get(LOGGER_NAME))
+    {
+        if (console_ == nullptr)
+            console_ = spdlog::stdout_logger_mt(LOGGER_NAME);
+    }
+
+    bool Save(const std::string& filename, std::shared_timed_mutex& engine_lock, DeviceRegistry& device_registry);
+
+    bool Restore(const std::string& filename, std::shared_timed_mutex& engine_lock, DeviceRegistry& device_registry);
+
+private:
+    std::shared_ptr<spdlog::logger> console_;
+};
+
+} // namespace ins_service
+
+#endif // INS_SERVER_INS_INCLUDE_ENGINE_SNAPSHOT_HPP
@@ -5,18 +5,37 @@
 #ifndef INS_SERVER_INS_INCLUDE_SERVICE_HPP
 #define INS_SERVER_INS_INCLUDE_SERVICE_HPP
 
+#include <condition_variable>
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <spdlog/spdlog.h>
+#include <thread>
 
 #include "lib_wrapper.hpp"
+#include "admission_controller.hpp"
+#include "coroutine.hpp"
 #include "data_store.hpp"
+#include "device_executor.hpp"
+#include "device_rate_limiter.hpp"
+#include "device_registry.hpp"
+#include "employee_index.hpp"
+#include "engine_snapshot.hpp"
 #include "localization.hpp"
+#include "metered_response.hpp"
+#include "metrics.hpp"
+#include "position_index.hpp"
+#include "profiler.hpp"
+#include "request_parser.hpp"
+#include "storage_writer.hpp"
+#include "task_pool.hpp"
+#include "tracer.hpp"
 #include "types.hpp"
 extern "C"
 {
 #include <WifiNode.h>
 #include <WifiAccessPointLocalConfig.h>
+#include <InsNodePool.h>
 }
 
 namespace ins_service
@@ -37,13 +56,31 @@ public:
         : http_end_point_(nullptr)
         , data_store_(nullptr)
         , localization_(nullptr)
+        , employee_index_(nullptr)
+        , device_registry_(nullptr)
+        , engine_snapshot_(nullptr)
+        , storage_writer_(nullptr)
+        , device_executor_(nullptr)
+        , read_pool_(nullptr)
+        , admission_(nullptr)
+        , upload_limiter_(nullptr)
+        , metrics_(&DefaultMetrics())
+        , tracer_(&DefaultTracer())
+        , profiler_(nullptr)
+        , position_index_(nullptr)
+        , snapshot_stop_(false)
         , console_(spdlog::get(LOGGER_NAME))
     {
         if (console_ == nullptr)
             console_ = spdlog::stdout_logger_mt(LOGGER_NAME);
     }
 
-    int Init(Pistache::Address addr, int thread_count = 2);
+    ~IndoorNavigationService()
+    {
+        StopSnapshots();
+    }
+
+    int Init(Pistache::Address addr, int thread_count = 2, const ServiceOptions& options = ServiceOptions());
 
     void Start();
 
@@ -58,19 +95,81 @@ private:
 
     void ResetDevicePosition(const Pistache::Rest::Request& request, Pistache::Http::ResponseWriter response);
 
+    // Answers 503 with a Retry-After hint for route_class.
+    void SendBusy(MeteredResponse& writer, RouteClass route_class, const std::string& body);
+
+    // Runs the part of a request that continues off the HTTP thread, answering 500 with error_body when it
+    // throws before a response was sent.
+    void RunRequest(MeteredResponse& writer, const std::string& error_body, const std::function<void()>& body);
+
+    // Marks the device most recently active, creating or rehydrating it when it is not resident.
+    void ActivateDevice(const DeviceId& device_id, bool pin = false);
+
+    // Computes, stores and publishes the position of a device; runs on the device's actor.
+    bool ResolveAndStorePosition(const std::string& device_id);
+
+#ifdef INS_ENABLE_COROUTINES
+    // Coroutine bodies of the device handlers, they answer through writer and hold ticket until done; the
+    // spans they record belong to trace.
+    DetachedTask StoreUpload(IngestRecord upload,
+                             std::shared_ptr<MeteredResponse>             writer,
+                             std::shared_ptr<AdmissionController::Ticket> ticket,
+                             uint64_t                                     trace);
+
+    DetachedTask ResolvePosition(std::string device_id,
+                                 std::shared_ptr<MeteredResponse>             writer,
+                                 std::shared_ptr<AdmissionController::Ticket> ticket,
+                                 uint64_t                                     trace);
+
+    DetachedTask ResetPosition(std::string device_id,
+                               std::shared_ptr<MeteredResponse>             writer,
+                               std::shared_ptr<AdmissionController::Ticket> ticket,
+                               uint64_t                                     trace);
+#endif // INS_ENABLE_COROUTINES
+
     void GetDevicePosition(const Pistache::Rest::Request& request, Pistache::Http::ResponseWriter response);
 
     void GetEmployeePosition(const Pistache::Rest::Request& request, Pistache::Http::ResponseWriter response);
 
+    void SearchEmployees(const Pistache::Rest::Request& request, Pistache::Http::ResponseWriter response);
+
     void Auth(const Pistache::Rest::Request& request, Pistache::Http::ResponseWriter response);
 
     void HandleReady(const Pistache::Rest::Request& request, Pistache::Http::ResponseWriter response);
 
+    void HandleMetrics(const Pistache::Rest::Request& request, Pistache::Http::ResponseWriter response);
+
+    void HandleTrace(const Pistache::Rest::Request& request, Pistache::Http::ResponseWriter response);
+
+    void HandleProfile(const Pistache::Rest::Request& request, Pistache::Http::ResponseWriter response);
+
     void PrintCookies(const Pistache::Rest::Request& request);
 
+    void RunSnapshots();
+
+    void StopSnapshots();
+
     std::shared_ptr<Pistache::Http::Endpoint> http_end_point_;
     std::shared_ptr<DataStore>                data_store_;
     std::shared_ptr<Localization>             localization_;
+    std::shared_ptr<EmployeeIndex>            employee_index_;
+    std::shared_ptr<DeviceRegistry>           device_registry_;
+    std::shared_ptr<EngineSnapshot>           engine_snapshot_;
+    std::shared_ptr<StorageWriter>            storage_writer_;
+    std::shared_ptr<DeviceExecutor>           device_executor_;
+    std::shared_ptr<TaskPool>                 read_pool_;
+    std::shared_ptr<AdmissionController>      admission_;
+    std::shared_ptr<DeviceRateLimiter>        upload_limiter_;
+    Metrics*                                  metrics_;
+    Tracer*                                   tracer_;
+    std::shared_ptr<Profiler>                 profiler_;
+    std::shared_ptr<PositionIndex>            position_index_;
+    ServiceOptions                            options_;
+    std::shared_timed_mutex                   engine_lock_;
+    std::thread                               snapshot_thread_;
+    std::mutex                                snapshot_lock_;
+    std::condition_variable                   snapshot_cv_;
+    bool                                      snapshot_stop_;
     Pistache::Rest::Router                    router_;
     std::shared_ptr<spdlog::logger>           console_;
 };
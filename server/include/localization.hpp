@@ -5,6 +5,7 @@
 #ifndef INS_SERVER_INS_INCLUDE_LOCALIZATION_HPP
 #define INS_SERVER_INS_INCLUDE_LOCALIZATION_HPP
 
+#include <shared_mutex>
 #include <spdlog/spdlog.h>
 
 #include "types.hpp"
@@ -38,10 +39,11 @@ public:
 			console_ = spdlog::stdout_logger_mt(LOGGER_NAME);
 	}
 
+	//engine_lock is held shared while the device list is walked, not while the readings are fetched.
 	Position
-	ProcessRSSIDataSet(const std::string& device_id);
-	insNode_t * FillNodesDataPoints(const char * device_id, std::vector<AccessPointRssiListPair> mac_rssi_list);
-	wifiParams_t * FillNodeDataPoints(wifiParams_t *  wifiNodeBlock, AccessPointRssiListPair mac_rssi_);
+	ProcessRSSIDataSet(const std::string& device_id, std::shared_timed_mutex& engine_lock);
+	insNode_t * FillNodesDataPoints(const char * device_id, const ArenaVector<RssiSeries>& mac_rssi_list);
+	wifiParams_t * FillNodeDataPoints(wifiParams_t *  wifiNodeBlock, const RssiSeries& mac_rssi_);
 
 private:
 	std::shared_ptr<spdlog::logger> console_;
@@ -0,0 +1,18 @@
+#ifndef INS_SERVER_INS_INCLUDE_LOGGING_HPP
+#define INS_SERVER_INS_INCLUDE_LOGGING_HPP
+
+#include <spdlog/spdlog.h>
+
+// Lowest log level compiled in, numbered like spdlog::level (0 trace, 1 debug, 2 info, ...). Statements
+// below it are removed together with the construction of their arguments, the build sets it.
+#ifndef INS_LOG_LEVEL
+#define INS_LOG_LEVEL 1
+#endif // INS_LOG_LEVEL
+
+#if INS_LOG_LEVEL <= 1
+#define INS_LOG_DEBUG(logger, ...) (logger)->debug(__VA_ARGS__)
+#else
+#define INS_LOG_DEBUG(logger, ...) (void)0
+#endif // INS_LOG_LEVEL <= 1
+
+#endif // INS_SERVER_INS_INCLUDE_LOGGING_HPP
@@ -0,0 +1,66 @@
+#ifndef INS_SERVER_INS_INCLUDE_METERED_RESPONSE_HPP
+#define INS_SERVER_INS_INCLUDE_METERED_RESPONSE_HPP
+
+#include <pistache/http.h>
+#include <string>
+
+#include "metrics.hpp"
+
+namespace ins_service
+{
+
+/**
+ * Response of a request that is counted in the metrics of its route: in flight from construction,
+ * answered with its status and latency on send(). Handlers share it with the tasks that answer
+ * asynchronously.
+ */
+class MeteredResponse
+{
+public:
+    MeteredResponse(Metrics& metrics, Route route, Pistache::Http::ResponseWriter response)
+        : metrics_(metrics)
+        , route_(route)
+        , start_(Metrics::Clock::now())
+        , response_(std::move(response))
+        , sent_(false)
+    {
+        metrics_.StartRequest(route_);
+    }
+
+    ~MeteredResponse()
+    {
+        if (!sent_)
+            metrics_.EndRequest(route_, 0, Metrics::Clock::duration::zero());
+    }
+
+    MeteredResponse(const MeteredResponse&) = delete;
+    MeteredResponse& operator=(const MeteredResponse&) = delete;
+
+    auto& headers()
+    {
+        return response_.headers();
+    }
+
+    void send(Pistache::Http::Code code, const std::string& body)
+    {
+        response_.send(code, body);
+        sent_ = true;
+        metrics_.EndRequest(route_, static_cast<int>(code), Metrics::Clock::now() - start_);
+    }
+
+    bool sent() const
+    {
+        return sent_;
+    }
+
+private:
+    Metrics&                       metrics_;
+    Route                          route_;
+    Metrics::Clock::time_point     start_;
+    Pistache::Http::ResponseWriter response_;
+    bool                           sent_;
+};
+
+} // namespace ins_service
+
+#endif // INS_SERVER_INS_INCLUDE_METERED_RESPONSE_HPP
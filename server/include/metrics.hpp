@@ -0,0 +1,125 @@
+#ifndef INS_SERVER_INS_INCLUDE_METRICS_HPP
+#define INS_SERVER_INS_INCLUDE_METRICS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+namespace ins_service
+{
+
+#ifdef ENABLE_TESTS
+class MetricsFixture;
+#endif // ENABLE_TESTS
+
+// Routes with metrics of their own.
+enum class Route
+{
+    kSetRssi,
+    kResolvePos,
+    kResetPos,
+    kGetDevicePos,
+    kGetEmployeePos,
+    kSearchEmployees,
+    kCount
+};
+
+// Stages of a position resolution.
+enum class Stage
+{
+    kDbFetch, // reading the RSSI series of the device
+    kFilter,  // kalman filter and path loss of every access point
+    kSolve,   // trilateration
+    kCount
+};
+
+/**
+ * Request and engine metrics, rendered in the Prometheus text format.
+ *
+ * Every recording thread gets a shard of its own and only updates that, so recording is a few
+ * uncontended relaxed increments; Render() sums the shards of all threads. Shards are kept after their
+ * thread exits so totals never go backwards.
+ */
+class Metrics
+{
+public:
+#ifdef ENABLE_TESTS
+    friend class MetricsFixture;
+#endif // ENABLE_TESTS
+
+    typedef std::chrono::steady_clock Clock;
+
+    // Upper bounds of the latency buckets in microseconds, +Inf is implied.
+    static const size_t   kBuckets = 16;
+    static const uint32_t kBucketBoundsUs[kBuckets];
+
+    Metrics();
+
+    Metrics(const Metrics&) = delete;
+    Metrics& operator=(const Metrics&) = delete;
+
+    void StartRequest(Route route);
+
+    // Ends a request answered with status after elapsed; status 0 ends a request that got no response.
+    void EndRequest(Route route, int status, Clock::duration elapsed);
+
+    void RecordStage(Stage stage, Clock::duration elapsed);
+
+    // Appends every metric to out.
+    void Render(std::string& out) const;
+
+    // Appends the help and type lines of a metric, followed by its samples rendered with RenderValue().
+    static void RenderHeader(std::string& out, const char* name, const char* type, const char* help);
+
+    static void RenderValue(std::string& out, const char* name, const std::string& labels, uint64_t value);
+
+private:
+    struct Histogram
+    {
+        std::atomic<uint64_t> buckets[kBuckets + 1];
+        std::atomic<uint64_t> sum_ns;
+    };
+
+    struct Shard
+    {
+        std::atomic<uint64_t> started[static_cast<size_t>(Route::kCount)];
+        std::atomic<uint64_t> ended[static_cast<size_t>(Route::kCount)];
+        std::atomic<uint64_t> responses[static_cast<size_t>(Route::kCount)][3]; // 2xx, 4xx, 5xx
+        Histogram             requests[static_cast<size_t>(Route::kCount)];
+        Histogram             stages[static_cast<size_t>(Stage::kCount)];
+    };
+
+    struct HistogramTotals
+    {
+        uint64_t buckets[kBuckets + 1];
+        uint64_t sum_ns;
+    };
+
+    Shard& LocalShard();
+
+    static void Add(Histogram& histogram, Clock::duration elapsed);
+
+    static void Merge(const Histogram& histogram, HistogramTotals& totals);
+
+    static void RenderHistogram(std::string&           out,
+                                const char*            name,
+                                const std::string&     labels,
+                                const HistogramTotals& totals);
+
+    const uint64_t                                              id_;
+    mutable std::mutex                                          lock_;
+    std::unordered_map<std::thread::id, std::unique_ptr<Shard>> shards_;
+};
+
+// Metrics of the running service, shared with the localization engine.
+Metrics& DefaultMetrics();
+
+} // namespace ins_service
+
+#endif // INS_SERVER_INS_INCLUDE_METRICS_HPP
@@ -0,0 +1,134 @@
+#ifndef INS_SERVER_INS_INCLUDE_MPSC_RING_HPP
+#define INS_SERVER_INS_INCLUDE_MPSC_RING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace ins_service
+{
+
+/**
+ * Bounded lock-free ring with any number of producers and a single consumer.
+ *
+ * Every cell carries a sequence number telling whether it is free for the producer that claimed its
+ * position or holds an item for the consumer, so producers only contend on one compare-and-swap of
+ * the head and never wait on each other or on the consumer. The capacity is rounded up to a power of
+ * two. TryPop() must only ever be called from one thread at a time.
+ */
+template <typename T>
+class MpscRing
+{
+public:
+    explicit MpscRing(size_t capacity)
+        : mask_(RoundUpPowerOfTwo(capacity) - 1)
+        , cells_(new Cell[mask_ + 1])
+        , head_(0)
+        , tail_(0)
+    {
+        for (size_t i = 0; i <= mask_; ++i)
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    MpscRing(const MpscRing&) = delete;
+    MpscRing& operator=(const MpscRing&) = delete;
+
+    // Returns false without blocking when the ring is full.
+    bool TryPush(const T& item)
+    {
+        Cell*  cell;
+        size_t position = head_.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            cell             = &cells_[position & mask_];
+            size_t  sequence = cell->sequence.load(std::memory_order_acquire);
+            int64_t distance = static_cast<int64_t>(sequence) - static_cast<int64_t>(position);
+            if (distance == 0)
+            {
+                if (head_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (distance < 0)
+            {
+                return false;
+            }
+            else
+            {
+                position = head_.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->item = item;
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Returns false when the next item has not been published yet.
+    bool TryPop(T& item)
+    {
+        size_t position = tail_.load(std::memory_order_relaxed);
+        Cell&  cell     = cells_[position & mask_];
+        if (cell.sequence.load(std::memory_order_acquire) != position + 1)
+            return false;
+
+        item = cell.item;
+        cell.sequence.store(position + mask_ + 1, std::memory_order_release);
+        tail_.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Number of items claimed by producers and not popped yet; racy by nature, for monitoring only.
+    size_t Depth() const
+    {
+        size_t tail = tail_.load(std::memory_order_acquire);
+        size_t head = head_.load(std::memory_order_acquire);
+        return head - tail;
+    }
+
+    // Number of positions ever claimed by producers; every item pushed before this call sits below it.
+    size_t Pushed() const
+    {
+        return head_.load(std::memory_order_acquire);
+    }
+
+    // Number of items ever popped.
+    size_t Popped() const
+    {
+        return tail_.load(std::memory_order_acquire);
+    }
+
+    size_t Capacity() const
+    {
+        return mask_ + 1;
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        T                   item;
+    };
+
+    // Keeps the producer and consumer indices on separate cache lines.
+    static const size_t kCacheLine = 64;
+
+    static size_t RoundUpPowerOfTwo(size_t value)
+    {
+        size_t power = 1;
+        while (power < value)
+            power <<= 1;
+        return power;
+    }
+
+    const size_t            mask_;
+    std::unique_ptr<Cell[]> cells_;
+    char                    pad0_[kCacheLine];
+    std::atomic<size_t>     head_;
+    char                    pad1_[kCacheLine - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t>     tail_;
+};
+
+} // namespace ins_service
+
+#endif // INS_SERVER_INS_INCLUDE_MPSC_RING_HPP
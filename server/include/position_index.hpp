@@ -0,0 +1,124 @@
+#ifndef INS_SERVER_INS_INCLUDE_POSITION_INDEX_HPP
+#define INS_SERVER_INS_INCLUDE_POSITION_INDEX_HPP
+
+#include <condition_variable>
+#include <mutex>
+#include <spdlog/spdlog.h>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include "data_store.hpp"
+#include "rcu_cell.hpp"
+#include "types.hpp"
+
+namespace ins_service
+{
+
+#ifdef ENABLE_TESTS
+class PositionIndexFixture;
+#endif // ENABLE_TESTS
+
+// Immutable copy of the locations table, one version of the position index.
+class PositionSnapshot
+{
+public:
+    struct Location
+    {
+        std::string employee_id;
+        Position    pos;
+    };
+
+    uint64_t                                  version = 0;
+    std::unordered_map<DeviceId, Location>    devices;
+    std::unordered_map<std::string, DeviceId> employees;
+
+    bool FindDevice(const DeviceId& device_id, Position& pos) const;
+
+    bool FindEmployee(const std::string& employee_id, Position& pos) const;
+};
+
+/**
+ * Lock-free read side for device and employee positions.
+ *
+ * Readers pin the current PositionSnapshot and never touch the database. Position updates are queued
+ * and folded into a new snapshot version by the publisher thread every publish interval, so a burst
+ * of resolves costs one copy of the index instead of one per device. Published positions therefore
+ * lag the database by up to one interval.
+ */
+class PositionIndex
+{
+public:
+#ifdef ENABLE_TESTS
+    friend class PositionIndexFixture;
+#endif // ENABLE_TESTS
+
+    typedef RcuCell<PositionSnapshot>::ReadGuard ReadGuard;
+
+    static const uint32_t kDefaultPublishIntervalMs = 20;
+
+    explicit PositionIndex()
+        : snapshot_(std::unique_ptr<PositionSnapshot>(new PositionSnapshot()))
+        , stop_(false)
+        , console_(spdlog::get(LOGGER_NAME))
+    {
+        if (console_ == nullptr)
+            console_ = spdlog::stdout_logger_mt(LOGGER_NAME);
+    }
+
+    ~PositionIndex()
+    {
+        Stop();
+    }
+
+    // Publishes the locations table as a new version, replacing everything indexed so far.
+    bool Load(DataStore& data_store);
+
+    void Start(uint32_t publish_interval_ms = kDefaultPublishIntervalMs);
+
+    // Stops the publisher thread, publishing the updates still queued.
+    void Stop();
+
+    // Queues a new position of a device for the next version.
+    void UpdateDevicePosition(const DeviceId& device_id, const Position& pos);
+
+    // Folds the queued updates into a new version, if there are any.
+    void Publish();
+
+    ReadGuard Read() const
+    {
+        return snapshot_.Read();
+    }
+
+    bool GetDevicePosition(const DeviceId& device_id, Position& pos) const
+    {
+        return Read()->FindDevice(device_id, pos);
+    }
+
+    bool GetEmployeePosition(const std::string& employee_id, Position& pos) const
+    {
+        return Read()->FindEmployee(employee_id, pos);
+    }
+
+    uint64_t Version() const
+    {
+        return Read()->version;
+    }
+
+private:
+    void Run(uint32_t publish_interval_ms);
+
+    RcuCell<PositionSnapshot>              snapshot_;
+    std::mutex                             writer_lock_;
+    std::mutex                             pending_lock_;
+    std::unordered_map<DeviceId, Position> pending_;
+    std::mutex                             publisher_lock_;
+    std::condition_variable                publisher_cv_;
+    bool                                   stop_;
+    std::thread                            publisher_;
+    std::shared_ptr<spdlog::logger>        console_;
+};
+
+} // namespace ins_service
+
+#endif // INS_SERVER_INS_INCLUDE_POSITION_INDEX_HPP
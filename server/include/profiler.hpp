@@ -0,0 +1,88 @@
+#ifndef INS_SERVER_INS_INCLUDE_PROFILER_HPP
+#define INS_SERVER_INS_INCLUDE_PROFILER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <spdlog/spdlog.h>
+#include <string>
+#include <thread>
+
+#include "types.hpp"
+
+namespace ins_service
+{
+
+#ifdef ENABLE_TESTS
+class ProfilerFixture;
+#endif // ENABLE_TESTS
+
+/**
+ * Sampling CPU profiler of the whole process.
+ *
+ * While a profile runs, ITIMER_PROF raises SIGPROF on whichever thread is using the CPU kFrequencyHz times
+ * per CPU second. The handler only stores the thread's return addresses in a preallocated slot; they are
+ * symbolized once the profile ends and returned as collapsed stacks ("outer;inner;leaf count" lines),
+ * the input of flamegraph.pl and speedscope. One profile runs at a time in the process.
+ */
+class Profiler
+{
+public:
+#ifdef ENABLE_TESTS
+    friend class ProfilerFixture;
+#endif // ENABLE_TESTS
+
+    typedef std::function<void(const std::string& stacks)> DoneCallback;
+
+    static const uint32_t kFrequencyHz = 99;
+    static const uint32_t kMaxSeconds  = 60;
+    static const size_t   kMaxFrames   = 48;
+    static const size_t   kMaxSamples  = 32768; // samples beyond are dropped and logged
+
+    Profiler();
+
+    // Cuts a running profile short and waits for it to be delivered.
+    ~Profiler();
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    // Profiles the process for duration (at most kMaxSeconds) on a thread of its own, then hands the stacks
+    // to done on that thread. False, without calling done, when a profile is already running.
+    bool Start(std::chrono::seconds duration, DoneCallback done);
+
+private:
+    struct Sample
+    {
+        int   depth;
+        void* frames[kMaxFrames];
+    };
+
+    void Run(std::chrono::seconds duration, DoneCallback done);
+
+    bool Arm();
+
+    void Disarm();
+
+    void Collapse(size_t count, std::string& out) const;
+
+    static void OnSignal(int signal);
+
+    std::unique_ptr<Sample[]>       samples_;
+    size_t                          capacity_;
+    std::atomic<size_t>             next_;
+    std::thread                     thread_;
+    std::mutex                      lock_;
+    std::condition_variable         stop_cv_;
+    bool                            stop_;
+    std::shared_ptr<spdlog::logger> console_;
+};
+
+} // namespace ins_service
+
+#endif // INS_SERVER_INS_INCLUDE_PROFILER_HPP
@@ -0,0 +1,175 @@
+#ifndef INS_SERVER_INS_INCLUDE_RCU_CELL_HPP
+#define INS_SERVER_INS_INCLUDE_RCU_CELL_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ins_service
+{
+
+/**
+ * Read-copy-update holder of an immutable T.
+ *
+ * Readers pin the current version with Read() and use it without any lock; writers build a new
+ * version and Publish() it with one atomic exchange. Old versions are reclaimed by epoch: a reader
+ * announces the epoch it started in through a slot of its own, a replaced version is retired with
+ * the epoch it was replaced in and deleted once no slot announces that epoch or an older one.
+ *
+ * At most kReaderSlots readers can hold a version at the same time, further readers spin until a
+ * slot frees up.
+ */
+template <typename T>
+class RcuCell
+{
+    struct Slot
+    {
+        std::atomic<uint64_t> epoch;
+        char                  pad[64 - sizeof(std::atomic<uint64_t>)]; // one slot per cache line
+    };
+
+public:
+    static const size_t kReaderSlots = 128;
+
+    // Pins the version that was current when it was created.
+    class ReadGuard
+    {
+    public:
+        ReadGuard(ReadGuard&& other)
+            : slot_(other.slot_)
+            , value_(other.value_)
+        {
+            other.slot_ = nullptr;
+        }
+
+        ~ReadGuard()
+        {
+            if (slot_ != nullptr)
+                slot_->epoch.store(0, std::memory_order_release);
+        }
+
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+
+        const T& operator*() const
+        {
+            return *value_;
+        }
+
+        const T* operator->() const
+        {
+            return value_;
+        }
+
+    private:
+        friend class RcuCell;
+
+        ReadGuard(Slot* slot, const T* value)
+            : slot_(slot)
+            , value_(value)
+        {
+        }
+
+        Slot*    slot_;
+        const T* value_;
+    };
+
+    explicit RcuCell(std::unique_ptr<T> initial)
+        : current_(initial.release())
+        , epoch_(1)
+        , slots_(new Slot[kReaderSlots])
+    {
+        for (size_t i = 0; i < kReaderSlots; ++i)
+            slots_[i].epoch.store(0, std::memory_order_relaxed);
+    }
+
+    // No reader may hold a version any more.
+    ~RcuCell()
+    {
+        delete current_.load();
+        for (auto const& retired : retired_)
+            delete retired.value;
+    }
+
+    RcuCell(const RcuCell&) = delete;
+    RcuCell& operator=(const RcuCell&) = delete;
+
+    ReadGuard Read() const
+    {
+        size_t start = std::hash<std::thread::id>()(std::this_thread::get_id());
+        for (size_t i = 0;; ++i)
+        {
+            Slot&    slot  = slots_[(start + i) % kReaderSlots];
+            uint64_t free  = 0;
+            uint64_t epoch = epoch_.load();
+            if (slot.epoch.load(std::memory_order_relaxed) == 0 && slot.epoch.compare_exchange_strong(free, epoch))
+                return ReadGuard(&slot, current_.load());
+            if (i % kReaderSlots == kReaderSlots - 1)
+                std::this_thread::yield();
+        }
+    }
+
+    // Makes value the current version and reclaims the replaced versions no reader holds any more;
+    // versions still held are retried on later publishes.
+    void Publish(std::unique_ptr<T> value)
+    {
+        std::lock_guard<std::mutex> lock(writer_lock_);
+        T*       replaced = current_.exchange(value.release());
+        uint64_t epoch    = epoch_.fetch_add(1);
+        retired_.push_back(Retired{ epoch, replaced });
+        Reclaim();
+    }
+
+    // Retired versions still waiting for readers.
+    size_t RetiredCount() const
+    {
+        std::lock_guard<std::mutex> lock(writer_lock_);
+        return retired_.size();
+    }
+
+private:
+    struct Retired
+    {
+        uint64_t epoch;
+        T*       value;
+    };
+
+    void Reclaim()
+    {
+        uint64_t oldest_reader = UINT64_MAX;
+        for (size_t i = 0; i < kReaderSlots; ++i)
+        {
+            uint64_t epoch = slots_[i].epoch.load();
+            if (epoch != 0 && epoch < oldest_reader)
+                oldest_reader = epoch;
+        }
+
+        size_t kept = 0;
+        for (auto const& retired : retired_)
+        {
+            if (retired.epoch < oldest_reader)
+                delete retired.value;
+            else
+                retired_[kept++] = retired;
+        }
+        retired_.resize(kept);
+    }
+
+    std::atomic<T*>         current_;
+    std::atomic<uint64_t>   epoch_;
+    std::unique_ptr<Slot[]> slots_;
+    mutable std::mutex      writer_lock_;
+    std::vector<Retired>    retired_;
+};
+
+template <typename T>
+const size_t RcuCell<T>::kReaderSlots;
+
+} // namespace ins_service
+
+#endif // INS_SERVER_INS_INCLUDE_RCU_CELL_HPP
@@ -0,0 +1,121 @@
+#ifndef INS_SERVER_INS_INCLUDE_REQUEST_PARSER_HPP
+#define INS_SERVER_INS_INCLUDE_REQUEST_PARSER_HPP
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+#include "types.hpp"
+
+namespace ins_service
+{
+
+/**
+ * Non-owning view of characters in a request buffer (C++14 has no std::string_view). The viewed
+ * buffer must outlive the view.
+ */
+class StringView
+{
+public:
+    StringView()
+        : data_(nullptr)
+        , size_(0)
+    {
+    }
+
+    StringView(const char* data, size_t size)
+        : data_(data)
+        , size_(size)
+    {
+    }
+
+    StringView(const char* text)
+        : data_(text)
+        , size_(std::strlen(text))
+    {
+    }
+
+    StringView(const std::string& text)
+        : data_(text.data())
+        , size_(text.size())
+    {
+    }
+
+    const char* data() const
+    {
+        return data_;
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+    bool empty() const
+    {
+        return size_ == 0;
+    }
+
+    char operator[](size_t i) const
+    {
+        return data_[i];
+    }
+
+    bool operator==(const StringView& rhs) const
+    {
+        return size_ == rhs.size_ && std::memcmp(data_, rhs.data_, size_) == 0;
+    }
+
+private:
+    const char* data_;
+    size_t      size_;
+};
+
+/**
+ * Walks the '/' separated segments of a request path in place, empty segments are skipped.
+ */
+class PathSegments
+{
+public:
+    explicit PathSegments(const StringView& path)
+        : pos_(path.data())
+        , end_(path.data() + path.size())
+    {
+    }
+
+    bool Next(StringView& segment);
+
+private:
+    const char* pos_;
+    const char* end_;
+};
+
+// Decimal integer with an optional sign, rejecting anything that does not fit.
+bool ParseInt32(const StringView& text, int32_t& value);
+
+// Decimal rssi reading, any fraction is dropped as the former stream conversion did ("-44.7" is -44).
+bool ParseRssi(const StringView& text, int32_t& rssi);
+
+// "aa:bb:cc:dd:ee:ff" with hexadecimal digits in either case, copied as given.
+bool ParseMacAddress(const StringView& text, MacAddress& mac_addr);
+
+// Device ids name a database table, so only letters, digits and '_' are accepted.
+bool ParseDeviceId(const StringView& text, DeviceId& device_id);
+
+// Device id of an RSSI upload path, without looking at the readings.
+bool ParseUploadDeviceId(const StringView& resource, DeviceId& device_id);
+
+/**
+ * Parses the path of an RSSI upload, "/set_rssi/<device_id>/<mac_addr>/<rssi>[/<mac_addr>/<rssi>...]",
+ * into at most capacity readings. A trailing access point without an rssi is ignored. Returns false
+ * when a segment is malformed or not a single reading is present.
+ */
+bool ParseRssiUpload(const StringView& resource,
+                     DeviceId&         device_id,
+                     RssiReading*      readings,
+                     size_t            capacity,
+                     size_t&           count);
+
+} // namespace ins_service
+
+#endif // INS_SERVER_INS_INCLUDE_REQUEST_PARSER_HPP
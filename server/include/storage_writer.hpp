@@ -0,0 +1,133 @@
+#ifndef INS_SERVER_INS_INCLUDE_STORAGE_WRITER_HPP
+#define INS_SERVER_INS_INCLUDE_STORAGE_WRITER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <spdlog/spdlog.h>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "data_store.hpp"
+#include "mpsc_ring.hpp"
+#include "types.hpp"
+
+namespace ins_service
+{
+
+#ifdef ENABLE_TESTS
+class StorageWriterFixture;
+#endif // ENABLE_TESTS
+
+// One RSSI upload as queued between the HTTP workers and the storage thread.
+struct IngestRecord
+{
+    static const size_t kMaxReadings = 10;
+
+    DeviceId    device_id;
+    uint32_t    count;
+    RssiReading readings[kMaxReadings];
+};
+
+/**
+ * Storage stage of the RSSI ingest path.
+ *
+ * HTTP workers hand decoded uploads to Submit(), which only pushes them on a lock-free ring, and a
+ * single storage thread drains the ring in batches of up to kMaxBatch uploads per transaction. Only
+ * that thread writes readings, so workers no longer queue up on the database lock, and device tables
+ * are created once per device instead of on every upload.
+ *
+ * Readings are stored asynchronously; callers that read them back wait for them with OnStored() first,
+ * or with Flush() where blocking the calling thread is fine.
+ */
+class StorageWriter
+{
+public:
+#ifdef ENABLE_TESTS
+    friend class StorageWriterFixture;
+#endif // ENABLE_TESTS
+
+    static const size_t kDefaultCapacity = 4096;
+    static const size_t kMaxBatch        = 64;
+
+    explicit StorageWriter(std::shared_ptr<DataStore> data_store, size_t capacity = kDefaultCapacity)
+        : data_store_(data_store)
+        , ring_(capacity)
+        , stored_(0)
+        , stop_(false)
+        , waiting_(false)
+        , console_(spdlog::get(LOGGER_NAME))
+    {
+        if (console_ == nullptr)
+            console_ = spdlog::stdout_logger_mt(LOGGER_NAME);
+        batch_.reserve(kMaxBatch);
+    }
+
+    ~StorageWriter()
+    {
+        Stop();
+    }
+
+    void Start();
+
+    // Stops the storage thread once everything queued so far is stored.
+    void Stop();
+
+    // Queues count readings of a device; false when the queue is full or count is out of range.
+    bool Submit(const DeviceId& device_id, const RssiReading* readings, size_t count);
+
+    // Blocks until every upload submitted before the call is stored.
+    void Flush();
+
+    // Non-blocking Flush(): callback runs once every upload submitted before the call is stored, on the
+    // storage thread, or right away when there is nothing to wait for.
+    void OnStored(std::function<void()> callback);
+
+    size_t Depth() const
+    {
+        return ring_.Depth();
+    }
+
+    size_t Capacity() const
+    {
+        return ring_.Capacity();
+    }
+
+private:
+    void Run();
+
+    size_t DrainBatch();
+
+    void StoreRecord(const IngestRecord& record);
+
+    void RunStoredCallbacks(bool all);
+
+    struct StoredCallback
+    {
+        size_t                target;
+        std::function<void()> callback;
+    };
+
+    std::shared_ptr<DataStore>      data_store_;
+    MpscRing<IngestRecord>          ring_;
+    std::unordered_set<DeviceId>    known_tables_;
+    std::vector<IngestRecord>       batch_;
+    std::vector<DeviceId>           new_tables_;
+    std::mutex                      drain_lock_;
+    std::mutex                      lock_;
+    std::condition_variable         wake_cv_;
+    std::condition_variable         stored_cv_;
+    size_t                          stored_;
+    std::vector<StoredCallback>     stored_callbacks_;
+    bool                            stop_;
+    std::atomic<bool>               waiting_;
+    std::thread                     thread_;
+    std::shared_ptr<spdlog::logger> console_;
+};
+
+} // namespace ins_service
+
+#endif // INS_SERVER_INS_INCLUDE_STORAGE_WRITER_HPP
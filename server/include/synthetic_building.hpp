@@ -0,0 +1,106 @@
+#ifndef INS_SERVER_INS_INCLUDE_SYNTHETIC_BUILDING_HPP
+#define INS_SERVER_INS_INCLUDE_SYNTHETIC_BUILDING_HPP
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "types.hpp"
+
+extern "C"
+{
+#include <WifiNode.h>
+}
+
+namespace ins_service
+{
+
+class BuildingOptions
+{
+public:
+    uint32_t floors                  = 3;
+    uint32_t access_points_per_floor = 6;
+    uint32_t desks_per_floor         = 20;
+    float    width_m                 = 40.0f;
+    float    depth_m                 = 20.0f;
+    float    floor_height_m          = 3.5f;
+    float    power_transmit_dbm      = -40.0f; // received at 1 m, the engine's powerTransmit
+    float    transmit_spread_db      = 2.0f;   // per access point deviation of powerTransmit
+    float    path_loss_exponent      = 3.0f;
+    float    arbitrary_distance_m    = 5.0f;
+    float    noise_db                = 3.0f; // deviation of every reading
+    float    sensitivity_dbm         = -95.0f;
+    uint32_t seed                    = 42;
+};
+
+// Access point as the local config describes it.
+class SyntheticAccessPoint
+{
+public:
+    MacAddress mac_addr;
+    uint32_t   floor; // 1 based, the wifiFloor block holding it
+    uint32_t   block; // 1 based, the wifiNodeBlock within its floor
+    Position   pos;   // metres, z is the floor number like the engine's
+    float      power_transmit;
+    float      power_at_arbitrary_distance;
+    float      arbitrary_distance;
+};
+
+/**
+ * Building of floors with access points and desks laid out from a seed, for benchmarks and accuracy tests.
+ *
+ * The access points are written as a local config file (WifiNodeLCFG.xml) and readings at any position
+ * follow the log-distance path loss model the engine inverts, plus gaussian noise. Floors and access points
+ * per floor are capped at what the engine's config lookup can tell apart.
+ */
+class SyntheticBuilding
+{
+public:
+    // wifiNodeBlock10 and up share their name prefix with wifiNodeBlock1, which the config lookup finds first.
+    static const uint32_t kMaxFloors               = NO_FLOORS;
+    static const uint32_t kMaxAccessPointsPerFloor = 9;
+    static const uint32_t kConfigBlocksPerFloor    = MAXIMUM_NUMBER_NODES;
+    static const char     kUnusedMacAddress[];
+
+    explicit SyntheticBuilding(const BuildingOptions& options);
+
+    const BuildingOptions& options() const
+    {
+        return options_;
+    }
+
+    const std::vector<SyntheticAccessPoint>& access_points() const
+    {
+        return access_points_;
+    }
+
+    // Ground truth positions, floor by floor.
+    const std::vector<Position>& desks() const
+    {
+        return desks_;
+    }
+
+    // Local config describing every access point, unused blocks filled like the shipped config.
+    std::string LocalConfig() const;
+
+    bool WriteLocalConfig(const std::string& filename) const;
+
+    // Noise free RSSI of access_point at pos.
+    float MeanRssi(const SyntheticAccessPoint& access_point, const Position& pos) const;
+
+    // samples readings of every access point heard at pos, strongest first and at most MAXIMUM_NUMBER_NODES
+    // of them like a device block holds.
+    std::vector<AccessPointRssiListPair> SimulateReadings(const Position& pos,
+                                                          size_t           samples,
+                                                          std::mt19937&    random) const;
+
+private:
+    BuildingOptions                   options_;
+    std::vector<SyntheticAccessPoint> access_points_;
+    std::vector<Position>             desks_;
+};
+
+} // namespace ins_service
+
+#endif // INS_SERVER_INS_INCLUDE_SYNTHETIC_BUILDING_HPP
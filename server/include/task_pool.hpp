@@ -0,0 +1,112 @@
+#ifndef INS_SERVER_INS_INCLUDE_TASK_POOL_HPP
+#define INS_SERVER_INS_INCLUDE_TASK_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <spdlog/spdlog.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "types.hpp"
+
+namespace ins_service
+{
+
+#ifdef ENABLE_TESTS
+class TaskPoolFixture;
+#endif // ENABLE_TESTS
+
+enum class ThreadPriority
+{
+    kInteractive, // requests a user is waiting on
+    kBulk         // device ingest, localization and storage, yields the CPU to interactive work
+};
+
+// Niceness given to bulk threads, the kernel then favours interactive threads when cores are saturated.
+static const int kBulkThreadNiceness = 5;
+
+// Sets the scheduling priority of the calling thread; false when the system refuses it.
+bool ApplyThreadPriority(ThreadPriority priority);
+
+/**
+ * Fixed set of worker threads running tasks from a bounded FIFO queue.
+ *
+ * TrySubmit() never blocks; a full queue rejects the task so the caller can shed load instead of
+ * piling up requests. Workers run at the pool's thread priority. A pool that is not started runs
+ * submitted tasks inline.
+ */
+class TaskPool
+{
+public:
+#ifdef ENABLE_TESTS
+    friend class TaskPoolFixture;
+#endif // ENABLE_TESTS
+
+    typedef std::function<void()> Task;
+
+    TaskPool(const std::string& name, size_t thread_count, size_t queue_limit, ThreadPriority priority)
+        : name_(name)
+        , thread_count_(thread_count == 0 ? 1 : thread_count)
+        , queue_limit_(queue_limit)
+        , priority_(priority)
+        , running_(false)
+        , stop_(false)
+        , rejected_(0)
+        , console_(spdlog::get(LOGGER_NAME))
+    {
+        if (console_ == nullptr)
+            console_ = spdlog::stdout_logger_mt(LOGGER_NAME);
+    }
+
+    ~TaskPool()
+    {
+        Stop();
+    }
+
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    void Start();
+
+    // Stops the workers once every queued task has run.
+    void Stop();
+
+    // Queues task, false when the queue already holds queue_limit tasks.
+    bool TrySubmit(Task task);
+
+    size_t Depth() const;
+
+    uint64_t Rejected() const
+    {
+        return rejected_;
+    }
+
+    const std::string& Name() const
+    {
+        return name_;
+    }
+
+private:
+    void Run();
+
+    std::string                     name_;
+    size_t                          thread_count_;
+    size_t                          queue_limit_;
+    ThreadPriority                  priority_;
+    mutable std::mutex              lock_;
+    std::condition_variable         ready_;
+    std::deque<Task>                queue_;
+    std::vector<std::thread>        threads_;
+    std::atomic<bool>               running_;
+    bool                            stop_;
+    std::atomic<uint64_t>           rejected_;
+    std::shared_ptr<spdlog::logger> console_;
+};
+
+} // namespace ins_service
+
+#endif // INS_SERVER_INS_INCLUDE_TASK_POOL_HPP
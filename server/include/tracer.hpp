@@ -0,0 +1,125 @@
+#ifndef INS_SERVER_INS_INCLUDE_TRACER_HPP
+#define INS_SERVER_INS_INCLUDE_TRACER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+namespace ins_service
+{
+
+#ifdef ENABLE_TESTS
+class TracerFixture;
+#endif // ENABLE_TESTS
+
+/**
+ * Spans of sampled requests, dumped in the Chrome trace format (chrome://tracing, Perfetto).
+ *
+ * A sampled request gets a trace id that its tasks make current on whichever thread runs them, see
+ * TraceScope. Spans are kept in a ring per recording thread, the oldest spans of a thread are overwritten
+ * once its ring is full. Threads without a current trace record nothing.
+ */
+class Tracer
+{
+public:
+#ifdef ENABLE_TESTS
+    friend class TracerFixture;
+#endif // ENABLE_TESTS
+
+    typedef std::chrono::steady_clock Clock;
+
+    static const size_t kRingSpans = 4096;
+
+    Tracer();
+
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+    // Traces one request out of every; 0 turns tracing off.
+    void SetSampleEvery(uint32_t every);
+
+    // Id of a new trace if the request is sampled, 0 otherwise.
+    uint64_t StartTrace();
+
+    // Records a span of trace_id; name must outlive the tracer, string literals are expected.
+    void Record(const char* name, uint64_t trace_id, Clock::time_point start, Clock::time_point end);
+
+    // Appends the recorded spans to out as a Chrome trace JSON document.
+    void Dump(std::string& out) const;
+
+private:
+    struct Span
+    {
+        const char* name;
+        uint64_t    trace_id;
+        int64_t     start_ns;
+        int64_t     duration_ns;
+    };
+
+    struct Ring
+    {
+        std::mutex lock;
+        uint32_t   tid;
+        uint64_t   next;
+        Span       spans[kRingSpans];
+    };
+
+    Ring& LocalRing();
+
+    const uint64_t                                             id_;
+    std::atomic<uint32_t>                                      sample_every_;
+    std::atomic<uint64_t>                                      requests_;
+    mutable std::mutex                                         lock_;
+    std::unordered_map<std::thread::id, std::unique_ptr<Ring>> rings_;
+};
+
+// Tracer of the running service, shared with the data store and the localization engine.
+Tracer& DefaultTracer();
+
+// Trace of the request the calling thread is working on, 0 if none.
+uint64_t CurrentTrace();
+
+/**
+ * Makes a trace current on the calling thread until the scope ends. Tasks of a sampled request open one
+ * with the id captured when the request was accepted.
+ */
+class TraceScope
+{
+public:
+    explicit TraceScope(uint64_t trace_id);
+
+    ~TraceScope();
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    uint64_t previous_;
+};
+
+// Span of the current trace covering the scope; only reads a thread local when the thread has no trace.
+class TraceSpan
+{
+public:
+    explicit TraceSpan(const char* name);
+
+    ~TraceSpan();
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char*               name_;
+    uint64_t                  trace_id_;
+    Tracer::Clock::time_point start_;
+};
+
+} // namespace ins_service
+
+#endif // INS_SERVER_INS_INCLUDE_TRACER_HPP
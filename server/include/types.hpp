@@ -5,10 +5,19 @@
 #ifndef INS_SERVICE_INS_INCLUDE_TYPES_HPP
 #define INS_SERVICE_INS_INCLUDE_TYPES_HPP
 
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <ostream>
+#include <spdlog/fmt/ostr.h>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
+#include "arena.hpp"
+#include "logging.hpp"
+
 namespace ins_service
 {
 
@@ -35,23 +44,136 @@ public:
     }
 };
 
+/**
+ * String of at most Capacity characters stored inline and NUL-terminated, so that types holding one stay
+ * trivially copyable. Longer input is truncated.
+ */
+template <size_t Capacity>
+class FixedString
+{
+public:
+    static_assert(Capacity < 256, "length is stored in a byte");
+
+    static const size_t kCapacity = Capacity;
+
+    FixedString()
+        : length_(0)
+    {
+        data_[0] = '\0';
+    }
+
+    FixedString(const char* text)
+    {
+        Assign(text, std::strlen(text));
+    }
+
+    FixedString(const char* text, size_t length)
+    {
+        Assign(text, length);
+    }
+
+    FixedString(const std::string& text)
+    {
+        Assign(text.data(), text.size());
+    }
+
+    void Assign(const char* text, size_t length)
+    {
+        length_ = static_cast<uint8_t>(length < Capacity ? length : Capacity);
+        std::memcpy(data_, text, length_);
+        data_[length_] = '\0';
+    }
+
+    const char* c_str() const
+    {
+        return data_;
+    }
+
+    const char* data() const
+    {
+        return data_;
+    }
+
+    size_t size() const
+    {
+        return length_;
+    }
+
+    bool empty() const
+    {
+        return length_ == 0;
+    }
+
+    std::string str() const
+    {
+        return std::string(data_, length_);
+    }
+
+    bool Equals(const char* text, size_t length) const
+    {
+        return length == length_ && std::memcmp(data_, text, length) == 0;
+    }
+
+    // Friends so that either side may be a plain string.
+    friend bool operator==(const FixedString& lhs, const FixedString& rhs)
+    {
+        return lhs.Equals(rhs.data_, rhs.length_);
+    }
+
+    friend bool operator!=(const FixedString& lhs, const FixedString& rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+    friend bool operator<(const FixedString& lhs, const FixedString& rhs)
+    {
+        int order = std::memcmp(lhs.data_, rhs.data_, lhs.length_ < rhs.length_ ? lhs.length_ : rhs.length_);
+        return order < 0 || (order == 0 && lhs.length_ < rhs.length_);
+    }
+
+private:
+    char    data_[Capacity + 1];
+    uint8_t length_;
+};
+
+template <size_t Capacity>
+const size_t FixedString<Capacity>::kCapacity;
+
+// Printing support, also lets spdlog format FixedString arguments.
+template <size_t Capacity>
+std::ostream& operator<<(std::ostream& out, const FixedString<Capacity>& text)
+{
+    return out.write(text.data(), text.size());
+}
+
+// "aa:bb:cc:dd:ee:ff"
+typedef FixedString<17> MacAddress;
+
+// Same bound as the device name of an insNode_t (DEV_NAME - 1).
+typedef FixedString<63> DeviceId;
+
 class AccessPoint
 {
 public:
-    explicit AccessPoint(std::string id)
+    AccessPoint()
+        : pos(Position{ 0, 0, 0 })
+    {
+    }
+
+    explicit AccessPoint(const MacAddress& id)
         : mac_addr(id)
         , pos(Position{ 0, 0, 0 })
     {
     }
 
-    AccessPoint(std::string id, Position p)
+    AccessPoint(const MacAddress& id, Position p)
         : mac_addr(id)
         , pos(p)
     {
     }
 
-    std::string mac_addr;
-    Position    pos;
+    MacAddress mac_addr;
+    Position   pos;
 
     bool operator==(const AccessPoint& rhs) const
     {
@@ -59,9 +181,123 @@ public:
     }
 };
 
-typedef std::pair<AccessPoint, int32_t>              AccessPointRssiPair;
+// Row of a device table as stored, an empty timestamp stands for NULL.
+class StoredReading
+{
+public:
+    MacAddress  mac_addr;
+    int32_t     rssi;
+    std::string timestamp;
+};
+
+// Row of the locations table as stored, an empty employee_id or timestamp stands for NULL.
+class StoredLocation
+{
+public:
+    DeviceId    device_id;
+    std::string employee_id;
+    Position    pos;
+    std::string timestamp;
+};
+
+// Runtime settings of the service, filled from the command line by main.
+class ServiceOptions
+{
+public:
+    std::string snapshot_file           = "../ins.snapshot";
+    uint32_t    snapshot_interval_s     = 60;
+    std::string spill_file              = "../ins.spill";
+    uint32_t    device_memory_budget_mb = 256;
+    uint32_t    prefault_devices        = 0;
+    uint32_t    ingest_queue_capacity   = 4096;
+    uint32_t    device_shards           = 0; // 0 uses one shard per hardware thread
+    uint32_t    device_queue_limit      = 4096;
+    uint32_t    read_threads            = 2;
+    uint32_t    read_queue_limit        = 256;
+    uint32_t    max_inflight_reads      = 512;
+    uint32_t    max_inflight_device_ops = 1024;
+    uint32_t    max_inflight_uploads    = 4096;
+    double      upload_rate             = 10; // uploads per second and device, 0 disables the limit
+    double      upload_burst            = 20;
+    uint32_t    trace_sample_every      = 0; // traces one request out of that many, 0 disables tracing
+    bool        enable_profiler         = false;
+};
+
+// Flat (access point, rssi) pair; unlike std::pair it is trivially copyable, so lists of readings can be bulk copied.
+class AccessPointRssiPair
+{
+public:
+    AccessPointRssiPair() = default;
+
+    AccessPointRssiPair(const AccessPoint& access_point, int32_t rssi)
+        : first(access_point)
+        , second(rssi)
+    {
+    }
+
+    template <typename T, typename U>
+    AccessPointRssiPair(const std::pair<T, U>& pair)
+        : first(pair.first)
+        , second(pair.second)
+    {
+    }
+
+    AccessPoint first;
+    int32_t     second;
+
+    bool operator==(const AccessPointRssiPair& rhs) const
+    {
+        return this->first == rhs.first && this->second == rhs.second;
+    }
+};
+
 typedef std::pair<AccessPoint, std::vector<int32_t>> AccessPointRssiListPair;
 
+typedef std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>> ArenaString;
+
+// One reading of a request being ingested.
+class RssiReading
+{
+public:
+    MacAddress mac_addr;
+    int32_t    rssi;
+};
+
+// Every reading of one access point, collected into the request arena while resolving a position.
+class RssiSeries
+{
+public:
+    RssiSeries(const MacAddress& mac_addr, const ArenaAllocator<int32_t>& allocator)
+        : mac_addr(mac_addr)
+        , rssi(allocator)
+    {
+    }
+
+    MacAddress           mac_addr;
+    ArenaVector<int32_t> rssi;
+};
+
+static_assert(std::is_trivially_copyable<AccessPointRssiPair>::value, "readings are bulk copied");
+static_assert(std::is_trivially_copyable<RssiReading>::value, "readings are bulk copied");
+
 } // namespace ins_service
 
+namespace std
+{
+
+template <size_t Capacity>
+struct hash<ins_service::FixedString<Capacity>>
+{
+    size_t operator()(const ins_service::FixedString<Capacity>& text) const
+    {
+        // FNV-1a
+        size_t hash = static_cast<size_t>(14695981039346656037ULL);
+        for (size_t i = 0; i < text.size(); ++i)
+            hash = (hash ^ static_cast<unsigned char>(text.data()[i])) * static_cast<size_t>(1099511628211ULL);
+        return hash;
+    }
+};
+
+} // namespace std
+
 #endif // INS_SERVICE_INS_INCLUDE_TYPES_HPP
\ No newline at end of file
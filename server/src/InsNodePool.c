@@ -0,0 +1,195 @@
+/*************************************************************************************************************************
+ * 			FILENAME :- InsNodePool.c
+ *
+ * Description :- The module contains a slab pool for insNode_t device blocks. Free blocks are chained through their
+ * 					next member, the pool is guarded by its own mutex.
+ ************************************************************************************************************************/
+
+#include <pthread.h>
+#include <stddef.h>
+#include <InsNodePool.h>
+
+typedef struct insNodeSlab_tag
+{
+	insNode_t * blocks;
+	uint32_t count;
+	struct insNodeSlab_tag * next;
+}insNodeSlab_t;
+
+static pthread_mutex_t poolLock = PTHREAD_MUTEX_INITIALIZER;
+static insNodeSlab_t * poolSlabs = NULL;
+static insNode_t * poolFreeList = NULL;
+static uint32_t poolBlocksPerSlab = INS_NODE_POOL_SLAB_BLOCKS;
+static insNodePoolStats_t poolStats;
+
+static uint32_t growPool(void)  //adds one slab to the free list, called with poolLock held.
+{
+	uint32_t i = 0;
+	insNodeSlab_t * slab = (insNodeSlab_t *)malloc(sizeof(insNodeSlab_t));
+
+	if (slab == NULL)
+	{
+		return 1;
+	}
+
+	slab->blocks = (insNode_t *)malloc((size_t)poolBlocksPerSlab * sizeof(insNode_t));
+	if (slab->blocks == NULL)
+	{
+		free(slab);
+		return 1;
+	}
+	slab->count = poolBlocksPerSlab;
+	slab->next = poolSlabs;
+	poolSlabs = slab;
+
+	for (i = slab->count; i > 0; i--)  //chain in address order so consecutive allocations stay close together.
+	{
+		slab->blocks[i - 1].next = poolFreeList;
+		poolFreeList = &slab->blocks[i - 1];
+	}
+
+	poolStats.slabs++;
+	poolStats.capacity += slab->count;
+
+	return 0;
+}
+
+static uint32_t ownsBlock(const insNode_t * insNodeBlock)  //called with poolLock held.
+{
+	const insNodeSlab_t * slab = poolSlabs;
+
+	while (slab != NULL)
+	{
+		if ((insNodeBlock >= slab->blocks) && (insNodeBlock < (slab->blocks + slab->count)))
+		{
+			return ((size_t)((const char *)insNodeBlock - (const char *)slab->blocks) % sizeof(insNode_t)) == 0;
+		}
+		slab = slab->next;
+	}
+	return 0;
+}
+
+uint32_t insNodePoolInit(uint32_t blocksPerSlab, uint32_t prefaultBlocks)
+{
+	uint32_t result = 0;
+	insNode_t * looper = NULL;
+
+	pthread_mutex_lock(&poolLock);
+
+	if (blocksPerSlab > 0)
+	{
+		poolBlocksPerSlab = blocksPerSlab;
+	}
+
+	while ((poolStats.capacity - poolStats.inUse) < prefaultBlocks)
+	{
+		if (growPool())
+		{
+			result = 1;
+			break;
+		}
+	}
+
+	//touch every free block up front, the first ingest of a new device then never waits on page faults.
+	looper = poolFreeList;
+	while ((looper != NULL) && (prefaultBlocks > 0))
+	{
+		memset(looper, 0, offsetof(insNode_t, next));
+		looper = (insNode_t *)looper->next;
+		prefaultBlocks--;
+	}
+
+	pthread_mutex_unlock(&poolLock);
+
+	return result;
+}
+
+insNode_t * insNodePoolAlloc(void)
+{
+	insNode_t * insNodeBlock = NULL;
+
+	pthread_mutex_lock(&poolLock);
+
+	if ((poolFreeList != NULL) || (growPool() == 0))
+	{
+		insNodeBlock = poolFreeList;
+		poolFreeList = (insNode_t *)insNodeBlock->next;
+
+		poolStats.inUse++;
+		poolStats.allocations++;
+		if (poolStats.inUse > poolStats.highWater)
+		{
+			poolStats.highWater = poolStats.inUse;
+		}
+	}
+
+	pthread_mutex_unlock(&poolLock);
+
+	return insNodeBlock;  //not zeroed, InsNodeDefine() clears the whole block when it sets the device up.
+}
+
+uint32_t insNodePoolFree(insNode_t * insNodeBlock)
+{
+	uint32_t result = 1;
+
+	if (insNodeBlock == NULL)
+	{
+		return 1;
+	}
+
+	pthread_mutex_lock(&poolLock);
+
+	if (ownsBlock(insNodeBlock))
+	{
+		insNodeBlock->next = poolFreeList;
+		poolFreeList = insNodeBlock;
+
+		poolStats.inUse--;
+		poolStats.releases++;
+		result = 0;
+	}
+
+	pthread_mutex_unlock(&poolLock);
+
+	if (result)
+	{
+		printf("[%s] Block %p does not belong to the device pool!! \n", __func__, (void *)insNodeBlock);
+	}
+
+	return result;
+}
+
+void insNodePoolGetStats(insNodePoolStats_t * stats)
+{
+	pthread_mutex_lock(&poolLock);
+	*stats = poolStats;
+	pthread_mutex_unlock(&poolLock);
+}
+
+uint32_t insNodePoolDestroy(void)
+{
+	insNodeSlab_t * slab = NULL;
+
+	pthread_mutex_lock(&poolLock);
+
+	if (poolStats.inUse > 0)
+	{
+		pthread_mutex_unlock(&poolLock);
+		return 1;
+	}
+
+	while (poolSlabs != NULL)
+	{
+		slab = poolSlabs;
+		poolSlabs = slab->next;
+		free(slab->blocks);
+		free(slab);
+	}
+	poolFreeList = NULL;
+	poolBlocksPerSlab = INS_NODE_POOL_SLAB_BLOCKS;
+	memset(&poolStats, 0, sizeof(poolStats));
+
+	pthread_mutex_unlock(&poolLock);
+
+	return 0;
+}
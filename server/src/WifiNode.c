@@ -11,25 +11,46 @@
  ************************************************************************************************************************/
 #include <WifiNode.h>
 #include <WifiAccessPointLocalConfig.h>
+#include <InsNodePool.h>
 
 insNode_t insNoderootP;
 insNode_t * insNoderoot = &insNoderootP;
 
+static insStageTimer_t stageTimer = NULL;
+
+static long elapsedNs(const struct timespec * before, const struct timespec * after)
+{
+	return 1000000000*(after->tv_sec - before->tv_sec) + after->tv_nsec - before->tv_nsec;
+}
+
+void insSetStageTimer(insStageTimer_t timer)
+{
+	stageTimer = timer;
+}
+
 float * GetCartesianPosition(insNode_t * insNodeBlock)
 {
-	float * cartPosition;
 	struct timespec before,after;
-	long delta;
 
-	clock_gettime(CLOCK_MONOTONIC_RAW, &before);  //compute time taken for the entire trilateration process to occur.
+	clock_gettime(CLOCK_MONOTONIC_RAW, &before);  //time the filter and the solver separately for the stage timer.
 
 	computePLProcess(insNodeBlock);
 
+	clock_gettime(CLOCK_MONOTONIC_RAW, &after);
+	if (stageTimer != NULL)
+	{
+		stageTimer(INS_STAGE_FILTER, elapsedNs(&before, &after));  //reported as soon as it ends, so the timer can place it.
+	}
+
+	clock_gettime(CLOCK_MONOTONIC_RAW, &before);
+
 	insNodeBlock->trilaterationProcess(insNodeBlock);
 
 	clock_gettime(CLOCK_MONOTONIC_RAW, &after);
-	delta = 1000000000*(after.tv_sec - before.tv_sec) + after.tv_nsec - before.tv_nsec;
-	printf("[%s] - RSSI processing and positioning took: %ld ns\n", __func__, delta);
+	if (stageTimer != NULL)
+	{
+		stageTimer(INS_STAGE_SOLVE, elapsedNs(&before, &after));
+	}
 
 	destroyInsNode(insNodeBlock);
 
@@ -52,7 +73,12 @@ insNode_t *  createInsNodeListDevice(const char * deviceId)
 
 		if (strcmp(deviceId,looper->devName))  // if previous loop broke because the device did not exist in the nodelist...
 		{
-			looper->next = insNode = (insNode_t *)calloc(1,sizeof(insNode_t));
+			if ((insNode = insNodePoolAlloc()) == NULL)  //device blocks come from the slab pool, see InsNodePool.h
+			{
+				printf("[%s] WifiNode Device Block allocation failed!! \n",__func__);
+				return NULL;
+			}
+			looper->next = insNode;
 			looper = (insNode_t *)looper->next;
 			InsNodeDefine(looper,count,deviceId);
 			printf("[%s] New WifiNode Device Block Created ID: %s!! \n",__func__,deviceId);
@@ -70,6 +96,28 @@ insNode_t *  createInsNodeListDevice(const char * deviceId)
 	return insNode;
 }
 
+uint32_t removeInsNodeListDevice(const char * deviceId)
+{
+	insNode_t * previous = insNoderoot;
+	insNode_t * looper = (insNoderoot != NULL) ? (insNode_t *)insNoderoot->next : NULL;
+
+	while ((looper != NULL) && (strcmp(deviceId,looper->devName)))
+	{
+		previous = looper;
+		looper = (insNode_t *)looper->next;
+	}
+
+	if (looper == NULL)
+	{
+		return 1;
+	}
+
+	previous->next = looper->next;
+	insNodePoolFree(looper);
+
+	return 0;
+}
+
 void computePLProcess(insNode_t * insNodeBlock)
 {
 	uint32_t j = 0;
@@ -0,0 +1,53 @@
+#include "admission_controller.hpp"
+
+namespace ins_service
+{
+
+const size_t AdmissionController::kRouteClasses;
+
+// Base Retry-After of each route class in seconds. Devices retry on their own schedule, so uploads are
+// pushed back the furthest.
+static const uint32_t kRetryAfterSeconds[AdmissionController::kRouteClasses] = { 1, 2, 5 };
+
+AdmissionController::AdmissionController(uint32_t interactive_limit, uint32_t device_limit, uint32_t ingest_limit)
+    : limits_{ interactive_limit, device_limit, ingest_limit }
+    , retries_(0)
+{
+    for (size_t i = 0; i < kRouteClasses; ++i)
+    {
+        in_flight_[i].store(0);
+        shed_[i].store(0);
+    }
+}
+
+std::shared_ptr<AdmissionController::Ticket> AdmissionController::Admit(RouteClass route_class)
+{
+    size_t index = Index(route_class);
+
+    // Higher classes first: a lower class is shed while any of them is backing up.
+    for (size_t higher = 0; higher < index; ++higher)
+    {
+        if (in_flight_[higher].load() * 2 > limits_[higher])
+        {
+            ++shed_[index];
+            return nullptr;
+        }
+    }
+
+    if (++in_flight_[index] > limits_[index])
+    {
+        --in_flight_[index];
+        ++shed_[index];
+        return nullptr;
+    }
+    return std::shared_ptr<Ticket>(new Ticket(in_flight_[index]));
+}
+
+uint32_t AdmissionController::RetryAfter(RouteClass route_class)
+{
+    // Spread over [base, 2 * base) so that clients shed together do not all come back together.
+    uint32_t base = kRetryAfterSeconds[Index(route_class)];
+    return base + retries_++ % base;
+}
+
+} // namespace ins_service
@@ -0,0 +1,97 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include "arena.hpp"
+
+namespace ins_service
+{
+
+Arena::~Arena()
+{
+    for (auto& block : blocks_)
+        std::free(block.data);
+}
+
+void* Arena::Allocate(size_t size, size_t alignment)
+{
+    if (size == 0)
+        size = 1;
+
+    if (!blocks_.empty())
+    {
+        Block& block   = blocks_[current_];
+        auto   address = reinterpret_cast<uintptr_t>(block.data) + offset_;
+        size_t padding = (alignment - address % alignment) % alignment;
+        if (offset_ + padding + size <= block.size)
+        {
+            offset_ += padding + size;
+            return block.data + offset_ - size;
+        }
+
+        // Blocks left behind by a rewind are reused before anything new is allocated.
+        while (current_ + 1 < blocks_.size())
+        {
+            ++current_;
+            offset_ = 0;
+            if (size + alignment <= blocks_[current_].size)
+                return Allocate(size, alignment);
+        }
+    }
+
+    // Oversized requests get a block of their own so the regular block size stays small.
+    size_t block_size = std::max(block_size_, size + alignment);
+    char*  data       = static_cast<char*>(std::malloc(block_size));
+    if (data == nullptr)
+        throw std::bad_alloc();
+
+    current_ = blocks_.empty() ? 0 : blocks_.size();
+    offset_  = 0;
+    blocks_.push_back(Block{ data, block_size });
+    return Allocate(size, alignment);
+}
+
+const char* Arena::CopyString(const char* data, size_t length)
+{
+    char* copy = static_cast<char*>(Allocate(length + 1, 1));
+    std::memcpy(copy, data, length);
+    copy[length] = '\0';
+    return copy;
+}
+
+void Arena::Rewind(const Mark& mark)
+{
+    current_ = mark.block;
+    offset_  = mark.offset;
+    if (current_ != 0 || offset_ != 0)
+        return;
+
+    // Back to empty: keep enough blocks to serve the next request without touching malloc.
+    size_t retained = 0;
+    size_t keep     = 0;
+    while (keep < blocks_.size() && retained + blocks_[keep].size <= kRetainedBytes)
+        retained += blocks_[keep++].size;
+    keep = std::max<size_t>(keep, 1);
+    for (size_t i = keep; i < blocks_.size(); ++i)
+        std::free(blocks_[i].data);
+    if (keep < blocks_.size())
+        blocks_.resize(keep);
+}
+
+size_t Arena::BytesReserved() const
+{
+    size_t reserved = 0;
+    for (const auto& block : blocks_)
+        reserved += block.size;
+    return reserved;
+}
+
+Arena& ThreadArena()
+{
+    static thread_local Arena arena;
+    return arena;
+}
+
+} // namespace ins_service
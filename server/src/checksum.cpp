@@ -0,0 +1,63 @@
+#include <cstring>
+
+#include "checksum.hpp"
+
+namespace ins_service
+{
+
+namespace
+{
+// Slicing-by-8 lookup tables: table[k][b] is the CRC of byte b followed by k zero bytes.
+class Crc32Tables
+{
+public:
+    Crc32Tables()
+    {
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; ++bit)
+                crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+            table[0][i] = crc;
+        }
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            for (int k = 1; k < 8; ++k)
+                table[k][i] = (table[k - 1][i] >> 8) ^ table[0][table[k - 1][i] & 0xFF];
+        }
+    }
+
+    uint32_t table[8][256];
+};
+
+const Crc32Tables kTables;
+} // namespace
+
+uint32_t Crc32(const void* data, size_t length, uint32_t crc)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    crc                  = ~crc;
+
+    // Eight bytes per step, assumes a little-endian host like the rest of the on-disk formats.
+    while (length >= 8)
+    {
+        uint32_t low;
+        uint32_t high;
+        std::memcpy(&low, bytes, sizeof(low));
+        std::memcpy(&high, bytes + 4, sizeof(high));
+        low ^= crc;
+        crc = kTables.table[7][low & 0xFF] ^ kTables.table[6][(low >> 8) & 0xFF]
+              ^ kTables.table[5][(low >> 16) & 0xFF] ^ kTables.table[4][low >> 24]
+              ^ kTables.table[3][high & 0xFF] ^ kTables.table[2][(high >> 8) & 0xFF]
+              ^ kTables.table[1][(high >> 16) & 0xFF] ^ kTables.table[0][high >> 24];
+        bytes += 8;
+        length -= 8;
+    }
+
+    while (length-- > 0)
+        crc = (crc >> 8) ^ kTables.table[0][(crc ^ *bytes++) & 0xFF];
+
+    return ~crc;
+}
+
+} // namespace ins_service
@@ -0,0 +1,590 @@
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <set>
+#include <unordered_map>
+
+#include "checksum.hpp"
+#include "data_archive.hpp"
+#include "request_parser.hpp"
+
+namespace ins_service
+{
+
+namespace
+{
+/*
+ * Archive layout, all integers little-endian:
+ *
+ *   header  := magic[8] version:u32
+ *   block   := type:u8 rows:u32 payload_size:u32 crc32(payload):u32 payload
+ *   archive := header block* end_block
+ *
+ * Payloads store one column after the other. Strings and counts are varints, signed values are
+ * zigzag varints and timestamps are delta-encoded seconds since the epoch (0 stands for NULL).
+ */
+const char     kMagic[8]        = { 'I', 'N', 'S', 'A', 'R', 'C', 'H', '1' };
+const uint32_t kFormatVersion   = 1;
+const size_t   kBlockHeaderSize = 13;
+const size_t   kRowsPerBlock    = 4096;
+const uint32_t kMaxPayloadSize  = 64 * 1024 * 1024;
+
+enum BlockType
+{
+    END_BLOCK          = 0,
+    ACCESS_POINT_BLOCK = 1,
+    LOCATION_BLOCK     = 2,
+    READING_BLOCK      = 3
+};
+
+class BlockWriter
+{
+public:
+    void U8(uint8_t value)
+    {
+        buffer.push_back(static_cast<char>(value));
+    }
+
+    void U32(uint32_t value)
+    {
+        for (int i = 0; i < 4; ++i)
+            buffer.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+
+    void Varint(uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            buffer.push_back(static_cast<char>((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        buffer.push_back(static_cast<char>(value));
+    }
+
+    void ZigZag(int64_t value)
+    {
+        Varint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+    }
+
+    void Double(double value)
+    {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        for (int i = 0; i < 8; ++i)
+            buffer.push_back(static_cast<char>((bits >> (8 * i)) & 0xFF));
+    }
+
+    void String(const char* value, size_t length)
+    {
+        Varint(length);
+        buffer.append(value, length);
+    }
+
+    void String(const std::string& value)
+    {
+        String(value.data(), value.size());
+    }
+
+    template <size_t Capacity>
+    void String(const FixedString<Capacity>& value)
+    {
+        String(value.data(), value.size());
+    }
+
+    std::string buffer;
+};
+
+class BlockReader
+{
+public:
+    BlockReader(const std::string& buffer)
+        : pos_(reinterpret_cast<const uint8_t*>(buffer.data()))
+        , end_(pos_ + buffer.size())
+        , ok_(true)
+    {
+    }
+
+    bool Ok() const
+    {
+        return ok_ && pos_ == end_;
+    }
+
+    uint64_t Varint()
+    {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            if (pos_ == end_)
+                break;
+            uint8_t byte = *pos_++;
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0)
+                return value;
+        }
+        ok_ = false;
+        return 0;
+    }
+
+    int64_t ZigZag()
+    {
+        uint64_t value = Varint();
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+    double Double()
+    {
+        if (end_ - pos_ < 8)
+        {
+            ok_ = false;
+            return 0;
+        }
+        uint64_t bits = 0;
+        for (int i = 0; i < 8; ++i)
+            bits |= static_cast<uint64_t>(*pos_++) << (8 * i);
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    void String(std::string& value)
+    {
+        uint64_t length = Varint();
+        if (!ok_ || length > static_cast<uint64_t>(end_ - pos_))
+        {
+            ok_ = false;
+            value.clear();
+            return;
+        }
+        value.assign(reinterpret_cast<const char*>(pos_), length);
+        pos_ += length;
+    }
+
+    // Values longer than the capacity are rejected rather than truncated.
+    template <size_t Capacity>
+    void String(FixedString<Capacity>& value)
+    {
+        uint64_t length = Varint();
+        if (!ok_ || length > static_cast<uint64_t>(end_ - pos_) || length > Capacity)
+        {
+            ok_ = false;
+            value.Assign("", 0);
+            return;
+        }
+        value.Assign(reinterpret_cast<const char*>(pos_), length);
+        pos_ += length;
+    }
+
+private:
+    const uint8_t* pos_;
+    const uint8_t* end_;
+    bool           ok_;
+};
+
+uint32_t LoadU32(const char* bytes)
+{
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i)
+        value |= static_cast<uint32_t>(static_cast<uint8_t>(bytes[i])) << (8 * i);
+    return value;
+}
+
+// Maps an sqlite "YYYY-MM-DD HH:MM:SS" UTC timestamp to epoch seconds + 1, 0 for NULL.
+int64_t EncodeTimestamp(const std::string& timestamp)
+{
+    struct tm fields;
+    std::memset(&fields, 0, sizeof(fields));
+    if (timestamp.empty()
+        || sscanf(timestamp.c_str(),
+                  "%d-%d-%d %d:%d:%d",
+                  &fields.tm_year,
+                  &fields.tm_mon,
+                  &fields.tm_mday,
+                  &fields.tm_hour,
+                  &fields.tm_min,
+                  &fields.tm_sec)
+               != 6)
+    {
+        return 0;
+    }
+    fields.tm_year -= 1900;
+    fields.tm_mon -= 1;
+    return static_cast<int64_t>(timegm(&fields)) + 1;
+}
+
+void DecodeTimestamp(int64_t value, std::string& timestamp)
+{
+    if (value == 0)
+    {
+        timestamp.clear();
+        return;
+    }
+    time_t    seconds = static_cast<time_t>(value - 1);
+    struct tm fields;
+    char      text[32];
+    gmtime_r(&seconds, &fields);
+    timestamp.assign(text, strftime(text, sizeof(text), "%Y-%m-%d %H:%M:%S", &fields));
+}
+
+bool WriteBlock(std::ofstream& out, BlockType type, uint32_t rows, const std::string& payload)
+{
+    BlockWriter header;
+    header.U8(static_cast<uint8_t>(type));
+    header.U32(rows);
+    header.U32(static_cast<uint32_t>(payload.size()));
+    header.U32(Crc32(payload.data(), payload.size()));
+    out.write(header.buffer.data(), header.buffer.size());
+    out.write(payload.data(), payload.size());
+    return static_cast<bool>(out);
+}
+
+void EncodeAccessPoints(const std::vector<AccessPoint>& rows, size_t count, BlockWriter& block)
+{
+    for (size_t i = 0; i < count; ++i)
+        block.String(rows[i].mac_addr);
+    for (size_t i = 0; i < count; ++i)
+        block.Double(rows[i].pos.x);
+    for (size_t i = 0; i < count; ++i)
+        block.Double(rows[i].pos.y);
+    for (size_t i = 0; i < count; ++i)
+        block.Double(rows[i].pos.z);
+}
+
+void EncodeLocations(const std::vector<StoredLocation>& rows, size_t count, BlockWriter& block)
+{
+    for (size_t i = 0; i < count; ++i)
+        block.String(rows[i].device_id);
+    for (size_t i = 0; i < count; ++i)
+        block.String(rows[i].employee_id);
+    for (size_t i = 0; i < count; ++i)
+        block.Double(rows[i].pos.x);
+    for (size_t i = 0; i < count; ++i)
+        block.Double(rows[i].pos.y);
+    for (size_t i = 0; i < count; ++i)
+        block.Double(rows[i].pos.z);
+    for (size_t i = 0; i < count; ++i)
+        block.ZigZag(EncodeTimestamp(rows[i].timestamp));
+}
+
+// Readings repeat a handful of mac addresses, so that column is dictionary encoded.
+void EncodeReadings(const std::string&                        device_id,
+                    const std::vector<StoredReading>&         rows,
+                    size_t                                    count,
+                    std::unordered_map<MacAddress, uint32_t>& dictionary,
+                    std::vector<const MacAddress*>&           dictionary_order,
+                    BlockWriter&                              block)
+{
+    dictionary.clear();
+    dictionary_order.clear();
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto inserted = dictionary.emplace(rows[i].mac_addr, static_cast<uint32_t>(dictionary_order.size()));
+        if (inserted.second)
+            dictionary_order.push_back(&inserted.first->first);
+    }
+
+    block.String(device_id);
+    block.Varint(dictionary_order.size());
+    for (auto mac_addr : dictionary_order)
+        block.String(*mac_addr);
+    for (size_t i = 0; i < count; ++i)
+        block.Varint(dictionary[rows[i].mac_addr]);
+    for (size_t i = 0; i < count; ++i)
+        block.ZigZag(rows[i].rssi);
+
+    int64_t previous = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        int64_t timestamp = EncodeTimestamp(rows[i].timestamp);
+        block.ZigZag(timestamp - previous);
+        previous = timestamp;
+    }
+}
+
+bool DecodeAccessPoints(BlockReader& reader, uint32_t count, std::vector<AccessPoint>& rows)
+{
+    rows.assign(count, AccessPoint());
+    for (auto& row : rows)
+        reader.String(row.mac_addr);
+    for (auto& row : rows)
+        row.pos.x = reader.Double();
+    for (auto& row : rows)
+        row.pos.y = reader.Double();
+    for (auto& row : rows)
+        row.pos.z = reader.Double();
+    return reader.Ok();
+}
+
+bool DecodeLocations(BlockReader& reader, uint32_t count, std::vector<StoredLocation>& rows)
+{
+    rows.resize(count);
+    for (auto& row : rows)
+        reader.String(row.device_id);
+    for (auto& row : rows)
+        reader.String(row.employee_id);
+    for (auto& row : rows)
+        row.pos.x = reader.Double();
+    for (auto& row : rows)
+        row.pos.y = reader.Double();
+    for (auto& row : rows)
+        row.pos.z = reader.Double();
+    for (auto& row : rows)
+        DecodeTimestamp(reader.ZigZag(), row.timestamp);
+    return reader.Ok();
+}
+
+bool DecodeReadings(BlockReader&                reader,
+                    uint32_t                    count,
+                    std::string&                device_id,
+                    std::vector<MacAddress>&    dictionary,
+                    std::vector<StoredReading>& rows)
+{
+    reader.String(device_id);
+
+    uint64_t dictionary_size = reader.Varint();
+    if (dictionary_size > count)
+        return false;
+    dictionary.resize(dictionary_size);
+    for (auto& mac_addr : dictionary)
+        reader.String(mac_addr);
+
+    rows.resize(count);
+    for (auto& row : rows)
+    {
+        uint64_t index = reader.Varint();
+        if (index >= dictionary.size())
+            return false;
+        row.mac_addr = dictionary[index];
+    }
+    for (auto& row : rows)
+        row.rssi = static_cast<int32_t>(reader.ZigZag());
+
+    int64_t previous = 0;
+    for (auto& row : rows)
+    {
+        previous += reader.ZigZag();
+        DecodeTimestamp(previous, row.timestamp);
+    }
+
+    // The id is pasted into the name of the device table, so it takes the same check as on the request path.
+    DeviceId checked;
+    return reader.Ok() && ParseDeviceId(device_id, checked);
+}
+} // namespace
+
+bool DataArchive::Export(const std::string& filename)
+{
+    INS_LOG_DEBUG(console_, "+ DataArchive::Export");
+    auto started = std::chrono::steady_clock::now();
+
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    if (!out)
+    {
+        console_->error("Cannot open {0} for writing", filename);
+        return false;
+    }
+
+    BlockWriter header;
+    header.buffer.assign(kMagic, sizeof(kMagic));
+    header.U32(kFormatVersion);
+    out.write(header.buffer.data(), header.buffer.size());
+
+    bool        result = true;
+    BlockWriter block;
+    size_t      count  = 0;
+    size_t      blocks = 0;
+    size_t      total  = 0;
+
+    // Access points and locations: rows are staged in a block-sized buffer and flushed when full.
+    std::vector<AccessPoint> access_points(kRowsPerBlock, AccessPoint());
+    auto flush_access_points = [&]() {
+        block.buffer.clear();
+        EncodeAccessPoints(access_points, count, block);
+        result = WriteBlock(out, ACCESS_POINT_BLOCK, static_cast<uint32_t>(count), block.buffer) && result;
+        total += count;
+        count = 0;
+        ++blocks;
+    };
+    result = data_store_->VisitAccessPoints([&](const AccessPoint& access_point) {
+        access_points[count++] = access_point;
+        if (count == kRowsPerBlock)
+            flush_access_points();
+    }) && result;
+    if (count > 0)
+        flush_access_points();
+
+    std::vector<StoredLocation> locations(kRowsPerBlock);
+    auto flush_locations = [&]() {
+        block.buffer.clear();
+        EncodeLocations(locations, count, block);
+        result = WriteBlock(out, LOCATION_BLOCK, static_cast<uint32_t>(count), block.buffer) && result;
+        total += count;
+        count = 0;
+        ++blocks;
+    };
+    result = data_store_->VisitLocations([&](const StoredLocation& location) {
+        locations[count++] = location;
+        if (count == kRowsPerBlock)
+            flush_locations();
+    }) && result;
+    if (count > 0)
+        flush_locations();
+
+    // Readings, one run of blocks per device table.
+    std::vector<std::string> device_ids;
+    result = data_store_->GetDeviceIds(device_ids) && result;
+
+    std::vector<StoredReading>               readings(kRowsPerBlock);
+    std::unordered_map<MacAddress, uint32_t> dictionary;
+    std::vector<const MacAddress*>           dictionary_order;
+    for (auto const& device_id : device_ids)
+    {
+        auto flush_readings = [&]() {
+            block.buffer.clear();
+            EncodeReadings(device_id, readings, count, dictionary, dictionary_order, block);
+            result = WriteBlock(out, READING_BLOCK, static_cast<uint32_t>(count), block.buffer) && result;
+            total += count;
+            count = 0;
+            ++blocks;
+        };
+        result = data_store_->VisitReadings(device_id, [&](const StoredReading& reading) {
+            readings[count++] = reading;
+            if (count == kRowsPerBlock)
+                flush_readings();
+        }) && result;
+        if (count > 0)
+            flush_readings();
+    }
+
+    result = WriteBlock(out, END_BLOCK, 0, std::string()) && result;
+    out.close();
+    result = !out.fail() && result;
+
+    auto elapsed
+        = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started).count();
+    if (result)
+        console_->info("Exported {0} rows of {1} devices in {2} blocks to {3} ({4} ms)",
+                       total,
+                       device_ids.size(),
+                       blocks,
+                       filename,
+                       elapsed);
+    else
+        console_->error("Export to {0} failed", filename);
+
+    INS_LOG_DEBUG(console_, "- DataArchive::Export");
+    return result;
+}
+
+bool DataArchive::Import(const std::string& filename)
+{
+    INS_LOG_DEBUG(console_, "+ DataArchive::Import");
+    auto started = std::chrono::steady_clock::now();
+
+    std::ifstream in(filename, std::ios::binary);
+    if (!in)
+    {
+        console_->error("Cannot open {0} for reading", filename);
+        return false;
+    }
+
+    char header[sizeof(kMagic) + 4];
+    if (!in.read(header, sizeof(header)) || std::memcmp(header, kMagic, sizeof(kMagic)) != 0
+        || LoadU32(header + sizeof(kMagic)) != kFormatVersion)
+    {
+        console_->error("{0} is not a supported archive", filename);
+        return false;
+    }
+
+    size_t                      blocks = 0;
+    size_t                      total  = 0;
+    std::string                 payload;
+    std::string                 device_id;
+    std::vector<MacAddress>     dictionary;
+    std::vector<AccessPoint>    access_points;
+    std::vector<StoredLocation> locations;
+    std::vector<StoredReading>  readings;
+    std::set<std::string>       device_tables;
+
+    // One transaction for the whole archive: reading tables have no natural key, so a partial import could
+    // not be re-run without duplicating rows. A corrupt or truncated block rolls everything back.
+    bool result = data_store_->RunInTransaction([&]() {
+        while (true)
+        {
+            char block_header[kBlockHeaderSize];
+            if (!in.read(block_header, sizeof(block_header)))
+            {
+                console_->error("Archive is truncated after {0} blocks", blocks);
+                return false;
+            }
+
+            uint8_t  type = static_cast<uint8_t>(block_header[0]);
+            uint32_t rows = LoadU32(block_header + 1);
+            uint32_t size = LoadU32(block_header + 5);
+            uint32_t crc  = LoadU32(block_header + 9);
+            if (type == END_BLOCK)
+                return true;
+            if (size > kMaxPayloadSize || rows > kRowsPerBlock)
+            {
+                console_->error("Block {0} has an invalid header", blocks);
+                return false;
+            }
+
+            payload.resize(size);
+            if (!in.read(&payload[0], size))
+            {
+                console_->error("Archive is truncated in block {0}", blocks);
+                return false;
+            }
+            if (Crc32(payload.data(), payload.size()) != crc)
+            {
+                console_->error("Checksum mismatch in block {0}", blocks);
+                return false;
+            }
+
+            BlockReader reader(payload);
+            bool        loaded = false;
+            if (type == ACCESS_POINT_BLOCK)
+            {
+                loaded
+                    = DecodeAccessPoints(reader, rows, access_points) && data_store_->InsertAccessPoints(access_points);
+            }
+            else if (type == LOCATION_BLOCK)
+            {
+                loaded = DecodeLocations(reader, rows, locations) && data_store_->InsertLocations(locations);
+            }
+            else if (type == READING_BLOCK)
+            {
+                loaded = DecodeReadings(reader, rows, device_id, dictionary, readings);
+                if (loaded && device_tables.insert(device_id).second)
+                    loaded = data_store_->CreateDeviceTable(device_id);
+                loaded = loaded && data_store_->InsertReadings(device_id, readings);
+            }
+            if (!loaded)
+            {
+                console_->error("Cannot load block {0}", blocks);
+                return false;
+            }
+
+            total += rows;
+            ++blocks;
+        }
+    });
+
+    auto elapsed
+        = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started).count();
+    if (result)
+        console_->info("Imported {0} rows of {1} devices in {2} blocks from {3} ({4} ms)",
+                       total,
+                       device_tables.size(),
+                       blocks,
+                       filename,
+                       elapsed);
+    else
+        console_->error("Import from {0} failed, nothing was imported", filename);
+
+    INS_LOG_DEBUG(console_, "- DataArchive::Import");
+    return result;
+}
+
+} // namespace ins_service
@@ -2,16 +2,35 @@
 // Created by samueli on 2017-10-10.
 //
 
-#include <sstream>
+#include <cstdio>
+#include <cstring>
 
 #include "data_store.hpp"
+#include "tracer.hpp"
 
 namespace ins_service
 {
 
+namespace
+{
+const char* ColumnText(sqlite3_stmt* stmt, int column)
+{
+    const unsigned char* text = sqlite3_column_text(stmt, column);
+    return text != nullptr ? reinterpret_cast<const char*>(text) : "";
+}
+
+void BindTextOrNull(sqlite3_stmt* stmt, int index, const std::string& text)
+{
+    if (text.empty())
+        sqlite3_bind_null(stmt, index);
+    else
+        sqlite3_bind_text(stmt, index, text.c_str(), static_cast<int>(text.size()), SQLITE_STATIC);
+}
+} // namespace
+
 void DataStore::Init(const std::string& db_filename)
 {
-    console_->debug("+ DataStore::Init");
+    INS_LOG_DEBUG(console_, "+ DataStore::Init");
 
     int result = sqlite3_open(db_filename.c_str(), &database_);
     if (result != 0)
@@ -24,8 +43,12 @@ void DataStore::Init(const std::string& db_filename)
     {
         console_->error("Cannot create locations table");
     }
+    if (!CreateAccessPointTable())
+    {
+        console_->error("Cannot create access_points table");
+    }
 
-    console_->debug("- DataStore::Init");
+    INS_LOG_DEBUG(console_, "- DataStore::Init");
     return;
 }
 
@@ -37,7 +60,7 @@ void DataStore::Close()
 
 bool DataStore::CreateLocationTable()
 {
-    console_->debug("+ DataStore::CreateLocationTable");
+    INS_LOG_DEBUG(console_, "+ DataStore::CreateLocationTable");
 
     std::string sql = "CREATE TABLE IF NOT EXISTS locations(device_id INTEGER PRIMARY KEY,"
                       "employee_id TEXT,"
@@ -45,16 +68,16 @@ bool DataStore::CreateLocationTable()
                       "pos_y REAL,"
                       "pos_z REAL,"
                       "timestamp datatime default current_timestamp);";
-    console_->debug(sql);
+    INS_LOG_DEBUG(console_, sql);
     bool res = RunQuery(sql);
 
-    console_->debug("- DataStore::CreateLocationTable");
+    INS_LOG_DEBUG(console_, "- DataStore::CreateLocationTable");
     return res;
 }
 
 bool DataStore::CreateAccessPointTable()
 {
-    console_->debug("+ DataStore::CreateAccessPointTable");
+    INS_LOG_DEBUG(console_, "+ DataStore::CreateAccessPointTable");
 
     std::string sql = "CREATE TABLE IF NOT EXISTS access_points("
                       "mac_addr TEXT PRIMARY KEY,"
@@ -62,100 +85,109 @@ bool DataStore::CreateAccessPointTable()
                       "pos_y REAL,"
                       "pos_z REAL);";
 
-    console_->debug(sql);
+    INS_LOG_DEBUG(console_, sql);
     bool res = RunQuery(sql);
 
-    console_->debug("- DataStore::CreateAccessPointTable");
+    INS_LOG_DEBUG(console_, "- DataStore::CreateAccessPointTable");
     return res;
 }
 
 bool DataStore::CreateDeviceTable(const std::string& device_id)
 {
-    console_->debug("+ DataStore::CreateDeviceTable");
+    INS_LOG_DEBUG(console_, "+ DataStore::CreateDeviceTable");
 
     std::string sql = "CREATE TABLE IF NOT EXISTS dev_" + device_id + "(id INTEGER PRIMARY KEY,"
                                                                       "mac_addr TEXT, rssi REAL,"
                                                                       "timestamp datatime default current_timestamp);";
-    console_->debug(sql);
+    INS_LOG_DEBUG(console_, sql);
     bool res = RunQuery(sql);
 
-    console_->debug("- DataStore::CreateDeviceTable");
+    INS_LOG_DEBUG(console_, "- DataStore::CreateDeviceTable");
     return res;
 }
 
 bool DataStore::ClearDeviceTable(const std::string& device_id)
 {
-    console_->debug("+ DataStore::ClearDeviceTable");
+    INS_LOG_DEBUG(console_, "+ DataStore::ClearDeviceTable");
+    TraceSpan span("DataStore::ClearDeviceTable");
 
     std::string sql = "DELETE from dev_" + device_id;
-    console_->info(sql);
+    INS_LOG_DEBUG(console_, sql);
     bool res = RunQuery(sql);
 
-    console_->debug("- DataStore::ClearDeviceTable");
+    INS_LOG_DEBUG(console_, "- DataStore::ClearDeviceTable");
     return res;
 }
 
 bool DataStore::UpdateDeviceLocation(const std::string& device_id, Position pos)
 {
-    console_->debug("+ DataStore::UpdateDeviceLocation");
+    INS_LOG_DEBUG(console_, "+ DataStore::UpdateDeviceLocation");
+    TraceSpan span("DataStore::UpdateDeviceLocation");
 
     std::string sql = "INSERT OR REPLACE INTO locations (device_id, pos_x, pos_y, "
                       "pos_z, employee_id) VALUES ("
                       + device_id + "," + std::to_string(pos.x) + ", " + std::to_string(pos.y) + ", "
                       + std::to_string(pos.z) + ", (SELECT employee_id FROM locations WHERE device_id=" + device_id
                       + "));";
-    console_->debug(sql);
+    INS_LOG_DEBUG(console_, sql);
     bool res = RunQuery(sql);
 
-    console_->debug("- DataStore::UpdateDeviceLocation");
+    INS_LOG_DEBUG(console_, "- DataStore::UpdateDeviceLocation");
     return res;
 }
 
 bool DataStore::AssignDeviceToEmployee(const std::string& device_id, const std::string& employee_id)
 {
-    console_->debug("+ DataStore::AssignDeviceToEmployee");
+    INS_LOG_DEBUG(console_, "+ DataStore::AssignDeviceToEmployee");
 
     std::string sql = "INSERT OR REPLACE INTO locations (device_id, employee_id, pos_x, pos_y, pos_z) VALUES ("
                       + device_id + ",'" + employee_id + "',(SELECT pos_x FROM locations WHERE device_id=" + device_id
                       + "),(SELECT pos_y FROM locations WHERE device_id=" + device_id
                       + "),(SELECT pos_z FROM locations WHERE device_id=" + device_id + "));";
-    console_->debug(sql);
+    INS_LOG_DEBUG(console_, sql);
     bool res = RunQuery(sql);
 
-    console_->debug("- DataStore::AssignDeviceToEmployee");
+    INS_LOG_DEBUG(console_, "- DataStore::AssignDeviceToEmployee");
     return res;
 }
 
 bool DataStore::InsertRSSIReadings(const std::string& device_id, std::vector<AccessPointRssiPair> accesspoint_rssi_list)
 {
-    console_->debug("+ DataStore::InsertRSSIReadings");
+    ArenaScope               scope;
+    ArenaVector<RssiReading> readings(scope.Allocator<RssiReading>());
+    readings.reserve(accesspoint_rssi_list.size());
+    for (const auto& accesspoint_rssi : accesspoint_rssi_list)
+        readings.push_back(RssiReading{ accesspoint_rssi.first.mac_addr, accesspoint_rssi.second });
+    return InsertRSSIReadings(device_id, readings.data(), readings.size());
+}
 
-    // Construct multi-record insert sql
-    std::stringstream sql;
-    sql << "INSERT INTO ";
-    sql << "dev_" << device_id << " (";
-    sql << "mac_addr, rssi) ";
-    sql << "VALUES";
-    for (int i = 0; i < accesspoint_rssi_list.size(); ++i)
+bool DataStore::InsertRSSIReadings(const std::string& device_id, const RssiReading* readings, size_t count)
+{
+    INS_LOG_DEBUG(console_, "+ DataStore::InsertRSSIReadings");
+
+    // Construct multi-record insert sql, in the thread arena as it is gone once executed.
+    ArenaScope  scope;
+    ArenaString sql(scope.Allocator<char>());
+    sql.reserve(48 + device_id.size() + count * 32);
+    sql.append("INSERT INTO dev_").append(device_id.data(), device_id.size()).append(" (mac_addr, rssi) VALUES");
+    char rssi[16];
+    for (size_t i = 0; i < count; ++i)
     {
-        sql << "('" << accesspoint_rssi_list[i].first.mac_addr << "'," << accesspoint_rssi_list[i].second << ")";
-        if (i < (accesspoint_rssi_list.size() - 1))
-        {
-            sql << ",";
-        }
+        snprintf(rssi, sizeof(rssi), "%d", readings[i].rssi);
+        sql.append(i == 0 ? "('" : ",('").append(readings[i].mac_addr.c_str()).append("',").append(rssi).append(")");
     }
-    sql << ";";
+    sql.append(";");
 
-    console_->debug(sql.str());
-    bool res = RunQuery(sql.str());
+    INS_LOG_DEBUG(console_, sql.c_str());
+    bool res = RunQuery(sql.c_str());
 
-    console_->debug("- DataStore::InsertRSSIReadings");
+    INS_LOG_DEBUG(console_, "- DataStore::InsertRSSIReadings");
     return res;
 }
 
 bool DataStore::GetPosition(const std::string& id, QueryT query_by, Position& pos)
 {
-    console_->debug("+ DataStore::GetPosition");
+    INS_LOG_DEBUG(console_, "+ DataStore::GetPosition");
 
     bool        result = false;
     std::string sql;
@@ -194,19 +226,56 @@ bool DataStore::GetPosition(const std::string& id, QueryT query_by, Position& po
     }
     sqlite3_finalize(selectStmt);
 
-    console_->debug("- DataStore::GetPosition");
+    INS_LOG_DEBUG(console_, "- DataStore::GetPosition");
     return result;
 }
 
+std::vector<std::string> DataStore::GetEmployeeIds()
+{
+    INS_LOG_DEBUG(console_, "+ DataStore::GetEmployeeIds");
+
+    std::vector<std::string> employee_ids;
+    std::string              sql = "SELECT employee_id FROM locations WHERE employee_id IS NOT NULL;";
+
+    sqlite3_stmt* selectStmt;
+    sqlite3_prepare(database_, sql.c_str(), static_cast<int>(sql.length() + 1), &selectStmt, NULL);
+    while (1)
+    {
+        int state = sqlite3_step(selectStmt);
+        if (state == SQLITE_ROW)
+        {
+            employee_ids.emplace_back(reinterpret_cast<const char*>(sqlite3_column_text(selectStmt, 0)));
+        }
+        else if (state == SQLITE_DONE)
+        {
+            break;
+        }
+        else
+        {
+            console_->error("Failed to read from database");
+            break;
+        }
+    }
+    sqlite3_finalize(selectStmt);
+
+    INS_LOG_DEBUG(console_, "- DataStore::GetEmployeeIds");
+    return employee_ids;
+}
+
 bool DataStore::RunQuery(const std::string& sql)
+{
+    return RunQuery(sql.c_str());
+}
+
+bool DataStore::RunQuery(const char* sql)
 {
 #ifdef ENABLE_TESTS
     executing_sql_ = sql;
 #endif // ENABLE_TESTS
 
-    std::lock_guard<std::mutex> guard(database_lock_);
-    char*                       error_msg;
-    auto                        result = sqlite3_exec(database_, sql.c_str(), DbCallback, 0, &error_msg);
+    std::lock_guard<std::recursive_mutex> guard(database_lock_);
+    char*                                 error_msg;
+    auto                                  result = sqlite3_exec(database_, sql, nullptr, 0, &error_msg);
     if (result != SQLITE_OK)
     {
         console_->error("SQL error: {0}", error_msg);
@@ -215,43 +284,76 @@ bool DataStore::RunQuery(const std::string& sql)
     }
     else
     {
-        console_->info("SQL executed successfully");
+        INS_LOG_DEBUG(console_, "SQL executed successfully");
         return true;
     }
 }
 
-int DataStore::DbCallback(void* not_used, int argc, char** argv, char** azColName)
+bool DataStore::VisitDistinctAccessPoints(const std::string& device_id, const AccessPointVisitor& visitor)
 {
-    (void)not_used;
-    auto logger = spdlog::get(LOGGER_NAME);
-    if (logger == nullptr)
-        logger = spdlog::stdout_logger_mt(LOGGER_NAME);
-    logger->debug("+ DataStore::DbCallback");
-    for (int i = 0; i < argc; i++)
+    INS_LOG_DEBUG(console_, "+ DataStore::VisitDistinctAccessPoints");
+    TraceSpan span("DataStore::VisitDistinctAccessPoints");
+
+    std::string   sql = "SELECT DISTINCT mac_addr FROM dev_" + device_id + ";";
+    sqlite3_stmt* selectStmt;
+    if (sqlite3_prepare_v2(database_, sql.c_str(), static_cast<int>(sql.length() + 1), &selectStmt, NULL) != SQLITE_OK)
     {
-        logger->info("{0} = {1}", azColName[i], argv[i] ? argv[i] : "NULL");
+        console_->error("Failed to prepare query: {0}", sqlite3_errmsg(database_));
+        return false;
     }
-    logger->debug("- DataStore::DbCallback");
-    return 0;
+
+    bool result = true;
+    while (1)
+    {
+        int state = sqlite3_step(selectStmt);
+        if (state == SQLITE_ROW)
+        {
+            visitor(reinterpret_cast<const char*>(sqlite3_column_text(selectStmt, 0)));
+        }
+        else if (state == SQLITE_DONE)
+        {
+            break;
+        }
+        else
+        {
+            console_->error("Failed to read from database");
+            result = false;
+            break;
+        }
+    }
+    sqlite3_finalize(selectStmt);
+
+    INS_LOG_DEBUG(console_, "- DataStore::VisitDistinctAccessPoints");
+    return result;
 }
 
-std::vector<AccessPoint> DataStore::GetDistinctAccessPoints(const std::string& device_id)
+bool DataStore::VisitRSSISeries(const std::string& device_id,
+                                const AccessPoint& access_point,
+                                const RssiVisitor& visitor)
 {
-    console_->debug("+ DataStore::GetRSSIDataStream");
-
-    std::vector<AccessPoint> access_points;
-    std::string              sql = "SELECT DISTINCT mac_addr FROM dev_" + device_id + ";";
+    INS_LOG_DEBUG(console_, "+ DataStore::VisitRSSISeries");
+    TraceSpan span("DataStore::VisitRSSISeries");
 
+    std::string   sql = "SELECT rssi FROM dev_" + device_id + " WHERE mac_addr = ?;";
     sqlite3_stmt* selectStmt;
-    sqlite3_prepare(database_, sql.c_str(), static_cast<int>(sql.length() + 1), &selectStmt, NULL);
+    if (sqlite3_prepare_v2(database_, sql.c_str(), static_cast<int>(sql.length() + 1), &selectStmt, NULL) != SQLITE_OK)
+    {
+        console_->error("Failed to prepare query: {0}", sqlite3_errmsg(database_));
+        return false;
+    }
+    sqlite3_bind_text(selectStmt,
+                      1,
+                      access_point.mac_addr.c_str(),
+                      static_cast<int>(access_point.mac_addr.size()),
+                      SQLITE_STATIC);
+
+    bool result = true;
     while (1)
     {
         int state = sqlite3_step(selectStmt);
         if (state == SQLITE_ROW)
         {
-            AccessPoint ap(reinterpret_cast<const char*>(sqlite3_column_text(selectStmt, 0)));
-            access_points.push_back(ap);
-
+            visitor(sqlite3_column_int(selectStmt, 0));
         }
         else if (state == SQLITE_DONE)
         {
@@ -260,30 +362,149 @@ std::vector<AccessPoint> DataStore::GetDistinctAccessPoints(const std::string& d
         else
         {
             console_->error("Failed to read from database");
+            result = false;
+            break;
+        }
+    }
+    sqlite3_finalize(selectStmt);
+
+    INS_LOG_DEBUG(console_, "- DataStore::VisitRSSISeries");
+    return result;
+}
+
+bool DataStore::GetDistinctAccessPoints(const std::string& device_id, std::vector<AccessPoint>& access_points)
+{
+    access_points.clear();
+    return VisitDistinctAccessPoints(device_id,
+                                     [&access_points](const char* mac_addr) { access_points.emplace_back(mac_addr); });
+}
+
+bool DataStore::GetRSSISeriesFromDatabase(const std::string& device_id,
+                                          const AccessPoint& access_point,
+                                          std::vector<int32_t>& rssi_list)
+{
+    rssi_list.clear();
+    return VisitRSSISeries(device_id, access_point, [&rssi_list](int32_t rssi) { rssi_list.push_back(rssi); });
+}
+
+bool DataStore::GetRSSISeriesData(const std::string&                    device_id,
+                                  const std::vector<AccessPoint>&       access_points,
+                                  std::vector<AccessPointRssiListPair>& series)
+{
+    INS_LOG_DEBUG(console_, "+ DataStore::GetRSSISeriesData");
+    TraceSpan span("DataStore::GetRSSISeriesData");
+
+    // Recycle the caller's buffers so that the rssi vectors keep their capacity between calls.
+    if (series.size() > access_points.size())
+        series.erase(series.begin() + access_points.size(), series.end());
+    for (size_t i = 0; i < access_points.size(); ++i)
+    {
+        if (i < series.size())
+        {
+            series[i].first = access_points[i];
+            series[i].second.clear();
+        }
+        else
+        {
+            series.emplace_back(access_points[i], std::vector<int32_t>());
+        }
+    }
+
+    // A single scan of the device table serves every access point instead of one query per access point.
+    std::string   sql = "SELECT mac_addr, rssi FROM dev_" + device_id + ";";
+    sqlite3_stmt* selectStmt;
+    if (sqlite3_prepare_v2(database_, sql.c_str(), static_cast<int>(sql.length() + 1), &selectStmt, NULL) != SQLITE_OK)
+    {
+        console_->error("Failed to prepare query: {0}", sqlite3_errmsg(database_));
+        return false;
+    }
 
+    bool   result = true;
+    size_t hint   = 0;
+    while (1)
+    {
+        int state = sqlite3_step(selectStmt);
+        if (state == SQLITE_ROW)
+        {
+            const char* mac_addr = reinterpret_cast<const char*>(sqlite3_column_text(selectStmt, 0));
+            size_t      length   = static_cast<size_t>(sqlite3_column_bytes(selectStmt, 0));
+            if (mac_addr == nullptr || series.empty())
+                continue;
+
+            // Readings usually arrive grouped by access point, so start from the last match.
+            for (size_t n = 0; n < series.size(); ++n)
+            {
+                size_t i = (hint + n) % series.size();
+                if (series[i].first.mac_addr.Equals(mac_addr, length))
+                {
+                    series[i].second.push_back(sqlite3_column_int(selectStmt, 1));
+                    hint = i;
+                    break;
+                }
+            }
+        }
+        else if (state == SQLITE_DONE)
+        {
+            break;
+        }
+        else
+        {
+            console_->error("Failed to read from database");
+            result = false;
             break;
         }
     }
     sqlite3_finalize(selectStmt);
 
-    console_->debug("- DataStore::GetRSSIDataStream");
-    return access_points;
+    INS_LOG_DEBUG(console_, "- DataStore::GetRSSISeriesData");
+    return result;
 }
 
-std::vector<int32_t> DataStore::GetRSSISeriesFromDatabase(const std::string& device_id, AccessPoint access_point)
+bool DataStore::CollectRSSISeries(const std::string& device_id, ArenaVector<RssiSeries>& series)
 {
-    console_->debug(" + DataStore::GetRSSISeriesDatabase");
-    std::vector<int32_t> rssi_list;
-    std::string          sql = "SELECT rssi FROM dev_" + device_id + " where mac_addr ='" + access_point.mac_addr + "';";
-    sqlite3_stmt*        selectStmt;
-    sqlite3_prepare(database_, sql.c_str(), static_cast<int>(sql.length() + 1), &selectStmt, NULL);
+    INS_LOG_DEBUG(console_, "+ DataStore::CollectRSSISeries");
+    TraceSpan span("DataStore::CollectRSSISeries");
 
+    series.clear();
+    Arena& arena = series.get_allocator().arena();
+
+    // Access points are discovered during the scan, which saves the separate DISTINCT query.
+    ArenaString sql{ ArenaAllocator<char>(arena) };
+    sql.append("SELECT mac_addr, rssi FROM dev_").append(device_id.data(), device_id.size()).append(";");
+    sqlite3_stmt* selectStmt;
+    if (sqlite3_prepare_v2(database_, sql.c_str(), static_cast<int>(sql.length() + 1), &selectStmt, NULL) != SQLITE_OK)
+    {
+        console_->error("Failed to prepare query: {0}", sqlite3_errmsg(database_));
+        return false;
+    }
+
+    bool   result = true;
+    size_t hint   = 0;
     while (1)
     {
         int state = sqlite3_step(selectStmt);
         if (state == SQLITE_ROW)
         {
-            rssi_list.push_back(sqlite3_column_int(selectStmt, 0));
+            const char* mac_addr = reinterpret_cast<const char*>(sqlite3_column_text(selectStmt, 0));
+            size_t      length   = static_cast<size_t>(sqlite3_column_bytes(selectStmt, 0));
+            if (mac_addr == nullptr)
+                continue;
+
+            // Readings usually arrive grouped by access point, so start from the last match.
+            size_t match = series.size();
+            for (size_t n = 0; n < series.size(); ++n)
+            {
+                size_t i = (hint + n) % series.size();
+                if (series[i].mac_addr.Equals(mac_addr, length))
+                {
+                    match = i;
+                    break;
+                }
+            }
+            if (match == series.size())
+                series.emplace_back(MacAddress(mac_addr, length), ArenaAllocator<int32_t>(arena));
+            series[match].rssi.push_back(sqlite3_column_int(selectStmt, 1));
+            hint = match;
         }
         else if (state == SQLITE_DONE)
         {
@@ -292,28 +513,278 @@ std::vector<int32_t> DataStore::GetRSSISeriesFromDatabase(const std::string& dev
         else
         {
             console_->error("Failed to read from database");
+            result = false;
             break;
         }
     }
     sqlite3_finalize(selectStmt);
 
-    console_->debug(" - DataStore::GetRSSISeriesDatabase");
-    return rssi_list;
+    INS_LOG_DEBUG(console_, "- DataStore::CollectRSSISeries");
+    return result;
 }
 
-std::vector<AccessPointRssiListPair> DataStore::GetRSSISeriesData(const std::string&       dev,
-                                                              std::vector<AccessPoint> access_points)
+bool DataStore::GetDeviceIds(std::vector<std::string>& device_ids)
 {
-    console_->debug("+ DataStore::GetRSSISeriesData");
+    INS_LOG_DEBUG(console_, "+ DataStore::GetDeviceIds");
+
+    device_ids.clear();
+    bool res = RunStatement("SELECT substr(name, 5) FROM sqlite_master "
+                            "WHERE type='table' AND name LIKE 'dev\\_%' ESCAPE '\\' ORDER BY name;",
+                            [&device_ids](sqlite3_stmt* stmt) {
+                                device_ids.emplace_back(ColumnText(stmt, 0));
+                                return true;
+                            });
+
+    INS_LOG_DEBUG(console_, "- DataStore::GetDeviceIds");
+    return res;
+}
+
+bool DataStore::VisitReadings(const std::string& device_id, const ReadingVisitor& visitor)
+{
+    INS_LOG_DEBUG(console_, "+ DataStore::VisitReadings");
+
+    // The row object is reused so that its strings keep their capacity across rows.
+    StoredReading reading;
+
+    bool res = RunStatement("SELECT mac_addr, rssi, timestamp FROM dev_" + device_id + " ORDER BY id;",
+                            [&reading, &visitor](sqlite3_stmt* stmt) {
+                                reading.mac_addr  = ColumnText(stmt, 0);
+                                reading.rssi      = sqlite3_column_int(stmt, 1);
+                                reading.timestamp = ColumnText(stmt, 2);
+                                visitor(reading);
+                                return true;
+                            });
+
+    INS_LOG_DEBUG(console_, "- DataStore::VisitReadings");
+    return res;
+}
+
+bool DataStore::VisitLocations(const LocationVisitor& visitor)
+{
+    INS_LOG_DEBUG(console_, "+ DataStore::VisitLocations");
+
+    StoredLocation location;
+
+    bool res = RunStatement("SELECT device_id, employee_id, pos_x, pos_y, pos_z, timestamp FROM locations;",
+                            [&location, &visitor](sqlite3_stmt* stmt) {
+                                location.device_id   = ColumnText(stmt, 0);
+                                location.employee_id = ColumnText(stmt, 1);
+                                location.pos.x       = sqlite3_column_double(stmt, 2);
+                                location.pos.y       = sqlite3_column_double(stmt, 3);
+                                location.pos.z       = sqlite3_column_double(stmt, 4);
+                                location.timestamp   = ColumnText(stmt, 5);
+                                visitor(location);
+                                return true;
+                            });
+
+    INS_LOG_DEBUG(console_, "- DataStore::VisitLocations");
+    return res;
+}
 
-    std::vector<AccessPointRssiListPair> accesspoint_rssi_list_pair;
-    for (auto const& access_point : access_points)
+bool DataStore::VisitAccessPoints(const AccessPointPositionVisitor& visitor)
+{
+    INS_LOG_DEBUG(console_, "+ DataStore::VisitAccessPoints");
+
+    AccessPoint access_point("");
+
+    bool res = RunStatement("SELECT mac_addr, pos_x, pos_y, pos_z FROM access_points;",
+                            [&access_point, &visitor](sqlite3_stmt* stmt) {
+                                access_point.mac_addr = ColumnText(stmt, 0);
+                                access_point.pos.x    = sqlite3_column_double(stmt, 1);
+                                access_point.pos.y    = sqlite3_column_double(stmt, 2);
+                                access_point.pos.z    = sqlite3_column_double(stmt, 3);
+                                visitor(access_point);
+                                return true;
+                            });
+
+    INS_LOG_DEBUG(console_, "- DataStore::VisitAccessPoints");
+    return res;
+}
+
+bool DataStore::BeginTransaction()
+{
+    return RunQuery("BEGIN TRANSACTION;");
+}
+
+bool DataStore::CommitTransaction()
+{
+    return RunQuery("COMMIT;");
+}
+
+bool DataStore::RollbackTransaction()
+{
+    return RunQuery("ROLLBACK;");
+}
+
+bool DataStore::RunInTransaction(const std::function<bool()>& body)
+{
+    // Statements of body take the lock again on this thread, other writers wait for the commit.
+    std::lock_guard<std::recursive_mutex> guard(database_lock_);
+    if (!BeginTransaction())
+        return false;
+
+    if (body() && CommitTransaction())
+        return true;
+
+    RollbackTransaction();
+    return false;
+}
+
+bool DataStore::InsertReadings(const std::string& device_id, const std::vector<StoredReading>& readings)
+{
+    INS_LOG_DEBUG(console_, "+ DataStore::InsertReadings");
+
+    bool res = RunBatch("INSERT INTO dev_" + device_id + " (mac_addr, rssi, timestamp) VALUES (?, ?, ?);",
+                        readings.size(),
+                        [&readings](sqlite3_stmt* stmt, size_t i) {
+                            const StoredReading& reading = readings[i];
+                            sqlite3_bind_text(stmt,
+                                              1,
+                                              reading.mac_addr.c_str(),
+                                              static_cast<int>(reading.mac_addr.size()),
+                                              SQLITE_STATIC);
+                            sqlite3_bind_int(stmt, 2, reading.rssi);
+                            BindTextOrNull(stmt, 3, reading.timestamp);
+                        });
+
+    INS_LOG_DEBUG(console_, "- DataStore::InsertReadings");
+    return res;
+}
+
+bool DataStore::InsertLocations(const std::vector<StoredLocation>& locations)
+{
+    INS_LOG_DEBUG(console_, "+ DataStore::InsertLocations");
+
+    bool res = RunBatch("INSERT OR REPLACE INTO locations (device_id, employee_id, pos_x, pos_y, pos_z, timestamp) "
+                        "VALUES (?, ?, ?, ?, ?, ?);",
+                        locations.size(),
+                        [&locations](sqlite3_stmt* stmt, size_t i) {
+                            const StoredLocation& location = locations[i];
+                            sqlite3_bind_text(stmt,
+                                              1,
+                                              location.device_id.c_str(),
+                                              static_cast<int>(location.device_id.size()),
+                                              SQLITE_STATIC);
+                            BindTextOrNull(stmt, 2, location.employee_id);
+                            sqlite3_bind_double(stmt, 3, location.pos.x);
+                            sqlite3_bind_double(stmt, 4, location.pos.y);
+                            sqlite3_bind_double(stmt, 5, location.pos.z);
+                            BindTextOrNull(stmt, 6, location.timestamp);
+                        });
+
+    INS_LOG_DEBUG(console_, "- DataStore::InsertLocations");
+    return res;
+}
+
+bool DataStore::InsertAccessPoints(const std::vector<AccessPoint>& access_points)
+{
+    INS_LOG_DEBUG(console_, "+ DataStore::InsertAccessPoints");
+
+    bool res = RunBatch("INSERT OR REPLACE INTO access_points (mac_addr, pos_x, pos_y, pos_z) VALUES (?, ?, ?, ?);",
+                        access_points.size(),
+                        [&access_points](sqlite3_stmt* stmt, size_t i) {
+                            const AccessPoint& access_point = access_points[i];
+                            sqlite3_bind_text(stmt,
+                                              1,
+                                              access_point.mac_addr.c_str(),
+                                              static_cast<int>(access_point.mac_addr.size()),
+                                              SQLITE_STATIC);
+                            sqlite3_bind_double(stmt, 2, access_point.pos.x);
+                            sqlite3_bind_double(stmt, 3, access_point.pos.y);
+                            sqlite3_bind_double(stmt, 4, access_point.pos.z);
+                        });
+
+    INS_LOG_DEBUG(console_, "- DataStore::InsertAccessPoints");
+    return res;
+}
+
+bool DataStore::RunStatement(const std::string& sql, const std::function<bool(sqlite3_stmt*)>& on_row)
+{
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(database_, sql.c_str(), static_cast<int>(sql.length() + 1), &stmt, NULL) != SQLITE_OK)
+    {
+        console_->error("Failed to prepare query: {0}", sqlite3_errmsg(database_));
+        return false;
+    }
+
+    bool result = true;
+    while (1)
+    {
+        int state = sqlite3_step(stmt);
+        if (state == SQLITE_ROW)
+        {
+            if (!on_row(stmt))
+                break;
+        }
+        else if (state == SQLITE_DONE)
+        {
+            break;
+        }
+        else
+        {
+            console_->error("Failed to read from database");
+            result = false;
+            break;
+        }
+    }
+    sqlite3_finalize(stmt);
+    return result;
+}
+
+bool DataStore::RunBatch(const std::string&                                 sql,
+                         size_t                                             rows,
+                         const std::function<void(sqlite3_stmt*, size_t)>& bind)
+{
+#ifdef ENABLE_TESTS
+    executing_sql_ = sql;
+#endif // ENABLE_TESTS
+
+    // One prepared statement is stepped once per row, the caller decides the transaction scope.
+    std::lock_guard<std::recursive_mutex> guard(database_lock_);
+    sqlite3_stmt*                         stmt;
+    if (sqlite3_prepare_v2(database_, sql.c_str(), static_cast<int>(sql.length() + 1), &stmt, NULL) != SQLITE_OK)
     {
-        accesspoint_rssi_list_pair.emplace_back(std::make_pair(access_point, GetRSSISeriesFromDatabase(dev, access_point)));
+        console_->error("Failed to prepare query: {0}", sqlite3_errmsg(database_));
+        return false;
+    }
+
+    bool result = true;
+    for (size_t i = 0; i < rows; ++i)
+    {
+        bind(stmt, i);
+        if (sqlite3_step(stmt) != SQLITE_DONE)
+        {
+            console_->error("SQL error: {0}", sqlite3_errmsg(database_));
+            result = false;
+            break;
+        }
+        sqlite3_reset(stmt);
+        sqlite3_clear_bindings(stmt);
     }
+    sqlite3_finalize(stmt);
+    return result;
+}
+
+std::vector<AccessPoint> DataStore::GetDistinctAccessPoints(const std::string& device_id)
+{
+    std::vector<AccessPoint> access_points;
+    GetDistinctAccessPoints(device_id, access_points);
+    return access_points;
+}
 
-    console_->debug("- DataStore::GetRSSISeriesData");
-    return accesspoint_rssi_list_pair;
+std::vector<int32_t> DataStore::GetRSSISeriesFromDatabase(const std::string& device_id, const AccessPoint& access_point)
+{
+    std::vector<int32_t> rssi_list;
+    GetRSSISeriesFromDatabase(device_id, access_point, rssi_list);
+    return rssi_list;
+}
+
+std::vector<AccessPointRssiListPair> DataStore::GetRSSISeriesData(const std::string&              device_id,
+                                                                  const std::vector<AccessPoint>& access_points)
+{
+    std::vector<AccessPointRssiListPair> series;
+    GetRSSISeriesData(device_id, access_points, series);
+    return series;
 }
 
 } // namespace ins_service
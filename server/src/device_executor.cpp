@@ -0,0 +1,271 @@
+#include <future>
+
+#include "device_executor.hpp"
+#include "task_pool.hpp"
+
+namespace ins_service
+{
+
+const size_t DeviceExecutor::kActorBudget;
+const size_t DeviceExecutor::kDefaultMaxPending;
+
+// Upper bound on how long an idle shard sleeps before looking for work to steal again.
+static const std::chrono::milliseconds kIdleWait(20);
+
+DeviceExecutor::DeviceExecutor(size_t shard_count, size_t max_pending)
+    : running_(false)
+    , stop_(false)
+    , executed_(0)
+    , stolen_(0)
+    , next_thief_(0)
+    , max_pending_(max_pending)
+    , pending_(0)
+    , console_(spdlog::get(LOGGER_NAME))
+{
+    if (console_ == nullptr)
+        console_ = spdlog::stdout_logger_mt(LOGGER_NAME);
+
+    if (shard_count == 0)
+        shard_count = 1;
+    for (size_t i = 0; i < shard_count; ++i)
+        shards_.emplace_back(new Shard());
+}
+
+void DeviceExecutor::Start()
+{
+    INS_LOG_DEBUG(console_, "+ DeviceExecutor::Start");
+
+    if (!running_)
+    {
+        stop_    = false;
+        running_ = true;
+        for (size_t i = 0; i < shards_.size(); ++i)
+            shards_[i]->thread = std::thread(&DeviceExecutor::RunShard, this, i);
+        console_->info("Running device operations on {0} shards", shards_.size());
+    }
+
+    INS_LOG_DEBUG(console_, "- DeviceExecutor::Start");
+}
+
+void DeviceExecutor::Stop()
+{
+    if (running_)
+    {
+        stop_ = true;
+        for (auto& shard : shards_)
+        {
+            std::lock_guard<std::mutex> lock(shard->lock);
+            shard->ready.notify_all();
+        }
+        for (auto& shard : shards_)
+            shard->thread.join();
+        running_ = false;
+    }
+
+    Actor* actor;
+    while ((actor = NextActor(0)) != nullptr)
+        RunActor(actor);
+}
+
+void DeviceExecutor::Post(const DeviceId& device_id, Task task)
+{
+    Actor* actor;
+    ++pending_;
+    {
+        // The table lock is held until the task is in the mailbox, a retiring actor cannot be freed under it.
+        std::lock_guard<std::mutex> table(actors_lock_);
+        actor = FindActor(device_id);
+        std::lock_guard<std::mutex> lock(actor->lock);
+        actor->mailbox.push_back(std::move(task));
+        if (actor->scheduled)
+            return;
+        actor->scheduled = true;
+    }
+    Schedule(actor);
+}
+
+bool DeviceExecutor::TryPost(const DeviceId& device_id, Task task)
+{
+    if (!running_)
+    {
+        task();
+        return true;
+    }
+    if (pending_ >= max_pending_)
+        return false;
+
+    Post(device_id, std::move(task));
+    return true;
+}
+
+void DeviceExecutor::Execute(const DeviceId& device_id, const Task& task)
+{
+    if (!running_)
+    {
+        task();
+        return;
+    }
+
+    std::promise<void> done;
+    std::future<void>  result = done.get_future();
+    Post(device_id, [&task, &done] {
+        try
+        {
+            task();
+            done.set_value();
+        }
+        catch (...)
+        {
+            done.set_exception(std::current_exception());
+        }
+    });
+    result.get();
+}
+
+size_t DeviceExecutor::ShardOf(const DeviceId& device_id) const
+{
+    return std::hash<DeviceId>()(device_id) % shards_.size();
+}
+
+DeviceExecutorStats DeviceExecutor::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(actors_lock_);
+    return DeviceExecutorStats{ executed_.load(), stolen_.load(), actors_.size(), pending_.load() };
+}
+
+DeviceExecutor::Actor* DeviceExecutor::FindActor(const DeviceId& device_id)
+{
+    // Called with actors_lock_ held.
+    std::unique_ptr<Actor>& actor = actors_[device_id];
+    if (actor == nullptr)
+    {
+        actor.reset(new Actor());
+        actor->scheduled = false;
+        actor->home      = ShardOf(device_id);
+        actor->device_id = device_id;
+    }
+    return actor.get();
+}
+
+bool DeviceExecutor::Retire(Actor* actor)
+{
+    // Posts hold the table lock while they fill a mailbox, so an actor found empty here stays empty
+    // until it is gone, and the next post of the device creates a new one.
+    std::lock_guard<std::mutex> table(actors_lock_);
+    {
+        std::lock_guard<std::mutex> lock(actor->lock);
+        if (!actor->mailbox.empty())
+            return false;
+    }
+    actors_.erase(actor->device_id);
+    return true;
+}
+
+void DeviceExecutor::Schedule(Actor* actor)
+{
+    Shard& home = *shards_[actor->home];
+    size_t queued;
+    {
+        std::lock_guard<std::mutex> lock(home.lock);
+        home.runnable.push_back(actor);
+        queued = home.runnable.size();
+    }
+    home.ready.notify_one();
+
+    // The home shard has a backlog, wake another shard so it can steal.
+    if (queued > 1 && shards_.size() > 1)
+    {
+        size_t thief = (actor->home + 1 + next_thief_++ % (shards_.size() - 1)) % shards_.size();
+        std::lock_guard<std::mutex> lock(shards_[thief]->lock);
+        shards_[thief]->ready.notify_one();
+    }
+}
+
+DeviceExecutor::Actor* DeviceExecutor::NextActor(size_t shard)
+{
+    {
+        Shard&                      own = *shards_[shard];
+        std::lock_guard<std::mutex> lock(own.lock);
+        if (!own.runnable.empty())
+        {
+            Actor* actor = own.runnable.front();
+            own.runnable.pop_front();
+            return actor;
+        }
+    }
+
+    for (size_t i = 1; i < shards_.size(); ++i)
+    {
+        Shard&                      victim = *shards_[(shard + i) % shards_.size()];
+        std::lock_guard<std::mutex> lock(victim.lock);
+        if (!victim.runnable.empty())
+        {
+            Actor* actor = victim.runnable.back();
+            victim.runnable.pop_back();
+            ++stolen_;
+            return actor;
+        }
+    }
+    return nullptr;
+}
+
+void DeviceExecutor::RunActor(Actor* actor)
+{
+    for (size_t i = 0; i < kActorBudget; ++i)
+    {
+        Task task;
+        {
+            std::lock_guard<std::mutex> lock(actor->lock);
+            if (actor->mailbox.empty())
+                break;
+            task = std::move(actor->mailbox.front());
+            actor->mailbox.pop_front();
+        }
+        ++executed_;
+        // A throwing handler must not take the shard thread, and the process, down with it.
+        try
+        {
+            task();
+        }
+        catch (const std::exception& e)
+        {
+            console_->error("Device operation failed: {0}", e.what());
+        }
+        catch (...)
+        {
+            console_->error("Device operation failed with an unknown exception");
+        }
+        --pending_;
+    }
+
+    if (Retire(actor))
+        return;
+    // Budget used up with work left, go to the back of the home queue behind the other devices.
+    Schedule(actor);
+}
+
+void DeviceExecutor::RunShard(size_t shard)
+{
+    INS_LOG_DEBUG(console_, "+ DeviceExecutor::RunShard");
+
+    if (!ApplyThreadPriority(ThreadPriority::kBulk))
+        console_->warn("Unable to lower the priority of device shard {0}", shard);
+
+    while (!stop_)
+    {
+        Actor* actor = NextActor(shard);
+        if (actor != nullptr)
+        {
+            RunActor(actor);
+            continue;
+        }
+
+        Shard&                       own = *shards_[shard];
+        std::unique_lock<std::mutex> lock(own.lock);
+        own.ready.wait_for(lock, kIdleWait, [this, &own] { return stop_ || !own.runnable.empty(); });
+    }
+
+    INS_LOG_DEBUG(console_, "- DeviceExecutor::RunShard");
+}
+
+} // namespace ins_service
@@ -0,0 +1,102 @@
+#include <algorithm>
+#include <cmath>
+
+#include "device_rate_limiter.hpp"
+
+namespace ins_service
+{
+
+const size_t DeviceRateLimiter::kStripes;
+const size_t DeviceRateLimiter::kMaxBucketsPerStripe;
+
+DeviceRateLimiter::DeviceRateLimiter(double rate, double burst)
+    : rate_(std::max(rate, 0.0))
+    , burst_(std::max(burst, 1.0))
+    , stripes_(new Stripe[kStripes])
+    , throttled_(0)
+    , console_(spdlog::get(LOGGER_NAME))
+{
+    if (console_ == nullptr)
+        console_ = spdlog::stdout_logger_mt(LOGGER_NAME);
+}
+
+bool DeviceRateLimiter::TryAcquire(const DeviceId& device_id, Clock::time_point now)
+{
+    if (rate_ <= 0)
+        return true;
+
+    Stripe&                     stripe = StripeOf(device_id);
+    std::lock_guard<std::mutex> lock(stripe.lock);
+
+    auto found = stripe.buckets.find(device_id);
+    if (found == stripe.buckets.end())
+    {
+        if (stripe.buckets.size() >= kMaxBucketsPerStripe)
+            PruneFullBuckets(stripe, now);
+        found = stripe.buckets.emplace(device_id, Bucket{ burst_, now, 0 }).first;
+    }
+
+    Bucket& bucket = found->second;
+    Refill(bucket, now);
+    if (bucket.tokens >= 1)
+    {
+        bucket.tokens -= 1;
+        return true;
+    }
+
+    // Only the first rejection is logged, a flooding device would flood the log as well otherwise.
+    if (bucket.throttled++ == 0)
+        console_->warn("Device {0} uploads faster than {1}/s, throttling it", device_id, rate_);
+    ++throttled_;
+    return false;
+}
+
+uint32_t DeviceRateLimiter::RetryAfter() const
+{
+    if (rate_ <= 0)
+        return 1;
+    return std::max(1u, static_cast<uint32_t>(std::ceil(1 / rate_)));
+}
+
+uint64_t DeviceRateLimiter::Throttled(const DeviceId& device_id) const
+{
+    Stripe&                     stripe = StripeOf(device_id);
+    std::lock_guard<std::mutex> lock(stripe.lock);
+    auto                        found = stripe.buckets.find(device_id);
+    return found != stripe.buckets.end() ? found->second.throttled : 0;
+}
+
+size_t DeviceRateLimiter::BucketCount() const
+{
+    size_t count = 0;
+    for (size_t i = 0; i < kStripes; ++i)
+    {
+        std::lock_guard<std::mutex> lock(stripes_[i].lock);
+        count += stripes_[i].buckets.size();
+    }
+    return count;
+}
+
+void DeviceRateLimiter::Refill(Bucket& bucket, Clock::time_point now) const
+{
+    if (now <= bucket.refilled)
+        return;
+    double elapsed_s = std::chrono::duration<double>(now - bucket.refilled).count();
+    bucket.tokens    = std::min(burst_, bucket.tokens + elapsed_s * rate_);
+    bucket.refilled  = now;
+}
+
+void DeviceRateLimiter::PruneFullBuckets(Stripe& stripe, Clock::time_point now) const
+{
+    // A full bucket behaves exactly like a new one, so forgetting it changes nothing but the counters.
+    for (auto it = stripe.buckets.begin(); it != stripe.buckets.end();)
+    {
+        Refill(it->second, now);
+        if (it->second.tokens >= burst_)
+            it = stripe.buckets.erase(it);
+        else
+            ++it;
+    }
+}
+
+} // namespace ins_service
@@ -0,0 +1,75 @@
+#include <cstring>
+
+#include "device_record.hpp"
+
+namespace ins_service
+{
+
+void ToDeviceRecord(const insNode_t* node, DeviceRecord& record)
+{
+    std::memset(&record, 0, sizeof(record));
+    std::memcpy(record.dev_name, node->devName, DEV_NAME);
+    std::memcpy(record.mac_address, node->macAddress, DEV_NAME);
+    std::memcpy(record.position, node->nodeCartPosition, sizeof(record.position));
+    record.device_no = node->deviceNo;
+    record.wifi_no   = node->wifiNo;
+
+    for (int i = 0; i < MAXIMUM_NUMBER_NODES; ++i)
+    {
+        const wifiParams_t& wifi = node->wifiAccessPointNode[i];
+        AccessPointRecord&  ap   = record.access_points[i];
+
+        std::memcpy(ap.position, wifi.position, sizeof(ap.position));
+        ap.distance               = wifi.distance;
+        ap.est_received_power     = wifi.estReceivedPower;
+        ap.sample_count           = wifi.noSampleData;
+        ap.processed_sample_count = wifi.noProcessedSampleData;
+        ap.error_estimate         = wifi.wifiInitParams.initialErrorEstimate;
+        ap.error_measurement      = wifi.wifiInitParams.initialErrormeasurement;
+        ap.power_estimate         = wifi.wifiInitParams.initialpowerEstimate;
+        ap.estimate               = wifi.wifiInitParams.estimate;
+        ap.kalman_gain            = wifi.wifiInitParams.kalmanGain;
+        ap.path_loss_exponent     = wifi.pathLoss.nFactor;
+        ap.power_do               = wifi.pathLoss.powerdo;
+        ap.do_distance            = wifi.pathLoss.doDistance;
+        ap.power_d                = wifi.pathLoss.powerd;
+        ap.d_distance             = wifi.pathLoss.dDistance;
+    }
+}
+
+void FromDeviceRecord(const DeviceRecord& record, insNode_t* node)
+{
+    std::memcpy(node->macAddress, record.mac_address, DEV_NAME);
+    std::memcpy(node->nodeCartPosition, record.position, sizeof(record.position));
+    node->wifiNo = record.wifi_no;
+
+    for (int i = 0; i < MAXIMUM_NUMBER_NODES; ++i)
+    {
+        const AccessPointRecord& ap   = record.access_points[i];
+        wifiParams_t&            wifi = node->wifiAccessPointNode[i];
+
+        std::memcpy(wifi.position, ap.position, sizeof(ap.position));
+        wifi.macAddress                             = NULL;
+        wifi.distance                               = ap.distance;
+        wifi.estReceivedPower                       = ap.est_received_power;
+        wifi.noSampleData                           = ap.sample_count;
+        wifi.noProcessedSampleData                  = ap.processed_sample_count;
+        wifi.wifiInitParams.initialErrorEstimate    = ap.error_estimate;
+        wifi.wifiInitParams.initialErrormeasurement = ap.error_measurement;
+        wifi.wifiInitParams.initialpowerEstimate    = ap.power_estimate;
+        wifi.wifiInitParams.estimate                = ap.estimate;
+        wifi.wifiInitParams.kalmanGain              = ap.kalman_gain;
+        wifi.pathLoss.nFactor                       = ap.path_loss_exponent;
+        wifi.pathLoss.powerdo                       = ap.power_do;
+        wifi.pathLoss.doDistance                    = ap.do_distance;
+        wifi.pathLoss.powerd                        = ap.power_d;
+        wifi.pathLoss.dDistance                     = ap.d_distance;
+    }
+}
+
+bool IsValidDeviceRecord(const DeviceRecord& record)
+{
+    return strnlen(record.dev_name, DEV_NAME) < DEV_NAME && strnlen(record.mac_address, DEV_NAME) < DEV_NAME;
+}
+
+} // namespace ins_service
@@ -0,0 +1,240 @@
+#include <cstdio>
+#include <fcntl.h>
+#include <iterator>
+#include <unistd.h>
+
+#include "device_registry.hpp"
+
+extern insNode_t* insNoderoot;
+
+namespace ins_service
+{
+
+DeviceRegistry::~DeviceRegistry()
+{
+    if (spill_fd_ >= 0)
+    {
+        close(spill_fd_);
+        std::remove(spill_file_.c_str());
+    }
+}
+
+bool DeviceRegistry::Init()
+{
+    INS_LOG_DEBUG(console_, "+ DeviceRegistry::Init");
+
+    spill_fd_ = open(spill_file_.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (spill_fd_ < 0)
+    {
+        console_->error("Unable to open device spill file {0}", spill_file_);
+        return false;
+    }
+    console_->info("Keeping at most {0} devices in memory", max_resident_);
+
+    INS_LOG_DEBUG(console_, "- DeviceRegistry::Init");
+    return true;
+}
+
+insNode_t* DeviceRegistry::Acquire(const DeviceId& device_id, bool pin)
+{
+    std::lock_guard<std::mutex> lock(lock_);
+
+    auto resident = resident_.find(device_id);
+    if (resident != resident_.end())
+    {
+        lru_.splice(lru_.begin(), lru_, resident->second.lru);
+        if (pin)
+            ++resident->second.pins;
+        return resident->second.node;
+    }
+
+    insNode_t* node = MakeResident(device_id, true);
+    if (node == NULL)
+        return NULL;
+
+    auto spilled = spilled_.find(device_id);
+    if (spilled != spilled_.end())
+    {
+        DeviceRecord record;
+        if (ReadSlot(spilled->second, record))
+            FromDeviceRecord(record, node);
+        else
+            console_->error("Unable to rehydrate device {0}, starting from a clean state", device_id);
+
+        free_slots_.push_back(spilled->second);
+        spilled_.erase(spilled);
+    }
+
+    if (pin)
+        resident_[device_id].pins = 1;
+
+    EvictOverBudget();
+    return node;
+}
+
+bool DeviceRegistry::Touch(const DeviceId& device_id, bool pin)
+{
+    std::lock_guard<std::mutex> lock(lock_);
+
+    auto resident = resident_.find(device_id);
+    if (resident == resident_.end())
+        return false;
+
+    lru_.splice(lru_.begin(), lru_, resident->second.lru);
+    if (pin)
+        ++resident->second.pins;
+    return true;
+}
+
+void DeviceRegistry::Unpin(const DeviceId& device_id)
+{
+    std::lock_guard<std::mutex> lock(lock_);
+
+    auto resident = resident_.find(device_id);
+    if (resident != resident_.end() && resident->second.pins > 0)
+        --resident->second.pins;
+}
+
+void DeviceRegistry::Restore(const DeviceRecord& record)
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    DeviceId                    device_id(record.dev_name);
+
+    auto resident = resident_.find(device_id);
+    if (resident != resident_.end())
+    {
+        FromDeviceRecord(record, resident->second.node);
+        return;
+    }
+
+    auto spilled = spilled_.find(device_id);
+    if (spilled != spilled_.end())
+    {
+        WriteSlot(spilled->second, record);
+        return;
+    }
+
+    if (resident_.size() < max_resident_)
+    {
+        insNode_t* node = MakeResident(device_id, false);
+        if (node != NULL)
+            FromDeviceRecord(record, node);
+        return;
+    }
+
+    if (!Spill(device_id, record))
+        console_->error("Unable to spill restored device {0}", device_id);
+}
+
+void DeviceRegistry::VisitRecords(std::shared_timed_mutex&                          engine_lock,
+                                  const std::function<void(const DeviceRecord&)>& visitor)
+{
+    // Same order as the callers of Acquire(): engine lock, then registry lock. The registry stays locked
+    // for the spill file reads so no device moves between memory and the file while they run.
+    std::unique_lock<std::shared_timed_mutex> engine(engine_lock);
+    std::lock_guard<std::mutex>               lock(lock_);
+
+    DeviceRecord record;
+    for (auto const& device_id : lru_)
+    {
+        ToDeviceRecord(resident_[device_id].node, record);
+        visitor(record);
+    }
+    engine.unlock();
+
+    for (auto const& spilled : spilled_)
+    {
+        if (ReadSlot(spilled.second, record))
+            visitor(record);
+    }
+}
+
+size_t DeviceRegistry::ResidentCount() const
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    return resident_.size();
+}
+
+size_t DeviceRegistry::SpilledCount() const
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    return spilled_.size();
+}
+
+insNode_t* DeviceRegistry::MakeResident(const DeviceId& device_id, bool most_recent)
+{
+    insNode_t* node = createInsNodeListDevice(device_id.c_str());
+    if (node == NULL)
+        node = findWifiNode(insNoderoot, device_id.c_str()); // registered behind the registry's back
+    if (node == NULL)
+    {
+        console_->error("Unable to create device block for {0}", device_id);
+        return NULL;
+    }
+
+    auto lru = most_recent ? lru_.insert(lru_.begin(), device_id) : lru_.insert(lru_.end(), device_id);
+    resident_[device_id] = Entry{ node, lru, 0 };
+    return node;
+}
+
+void DeviceRegistry::EvictOverBudget()
+{
+    // Walk from the least recently active device, never evicting the most recent one.
+    auto victim = lru_.end();
+    while (resident_.size() > max_resident_ && std::prev(victim) != lru_.begin())
+    {
+        auto   current = std::prev(victim);
+        Entry& entry   = resident_[*current];
+        if (entry.pins > 0)
+        {
+            victim = current;
+            continue;
+        }
+
+        DeviceRecord record;
+        ToDeviceRecord(entry.node, record);
+        if (!Spill(*current, record))
+            console_->error("Unable to spill device {0}, its state will be rebuilt from history", *current);
+
+        removeInsNodeListDevice(current->c_str());
+        resident_.erase(*current);
+        victim = lru_.erase(current);
+    }
+}
+
+bool DeviceRegistry::Spill(const DeviceId& device_id, const DeviceRecord& record)
+{
+    uint32_t slot;
+    if (free_slots_.empty())
+    {
+        slot = slot_count_++;
+    }
+    else
+    {
+        slot = free_slots_.back();
+        free_slots_.pop_back();
+    }
+
+    if (!WriteSlot(slot, record))
+    {
+        free_slots_.push_back(slot);
+        return false;
+    }
+    spilled_[device_id] = slot;
+    return true;
+}
+
+bool DeviceRegistry::WriteSlot(uint32_t slot, const DeviceRecord& record)
+{
+    off_t offset = static_cast<off_t>(slot) * sizeof(DeviceRecord);
+    return spill_fd_ >= 0 && pwrite(spill_fd_, &record, sizeof(record), offset) == sizeof(record);
+}
+
+bool DeviceRegistry::ReadSlot(uint32_t slot, DeviceRecord& record)
+{
+    off_t offset = static_cast<off_t>(slot) * sizeof(DeviceRecord);
+    return spill_fd_ >= 0 && pread(spill_fd_, &record, sizeof(record), offset) == sizeof(record)
+           && IsValidDeviceRecord(record);
+}
+
+} // namespace ins_service
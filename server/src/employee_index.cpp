@@ -0,0 +1,387 @@
+#include <algorithm>
+#include <cctype>
+#include <queue>
+#include <unordered_set>
+
+#include "employee_index.hpp"
+
+namespace ins_service
+{
+
+namespace
+{
+// Minimum Dice coefficient between query and key trigrams for a fuzzy match.
+const double kFuzzyThreshold = 0.3;
+} // namespace
+
+void EmployeeIndex::Insert(const std::string& employee_id, const std::string& name)
+{
+    std::string id_key = Normalize(employee_id);
+    if (id_key.empty())
+        return;
+
+    // Replacing an entry is one step, concurrent inserts of an id must not both add it.
+    std::lock_guard<std::mutex> guard(lock_);
+    RemoveLocked(employee_id);
+
+    uint32_t entry;
+    if (!free_entries_.empty())
+    {
+        entry = free_entries_.back();
+        free_entries_.pop_back();
+        entries_[entry] = employee_id;
+    }
+    else
+    {
+        entry = static_cast<uint32_t>(entries_.size());
+        entries_.push_back(employee_id);
+        entry_keys_.emplace_back();
+    }
+    entry_by_id_[employee_id] = entry;
+
+    entry_keys_[entry].push_back(AddKey(entry, id_key));
+
+    std::string name_key = Normalize(name);
+    if (!name_key.empty() && name_key != id_key)
+        entry_keys_[entry].push_back(AddKey(entry, name_key));
+}
+
+void EmployeeIndex::Remove(const std::string& employee_id)
+{
+    std::lock_guard<std::mutex> guard(lock_);
+    RemoveLocked(employee_id);
+}
+
+void EmployeeIndex::RemoveLocked(const std::string& employee_id)
+{
+    auto it = entry_by_id_.find(employee_id);
+    if (it == entry_by_id_.end())
+        return;
+
+    uint32_t entry = it->second;
+    for (auto key : entry_keys_[entry])
+        DropKey(key);
+
+    entry_keys_[entry].clear();
+    entries_[entry].clear();
+    free_entries_.push_back(entry);
+    entry_by_id_.erase(it);
+}
+
+std::vector<EmployeeMatch> EmployeeIndex::Search(const std::string& query, size_t max_results) const
+{
+    std::vector<EmployeeMatch> matches;
+    std::string                needle = Normalize(query);
+    if (needle.empty() || max_results == 0)
+        return matches;
+
+    std::lock_guard<std::mutex> guard(lock_);
+
+    // Best score seen per entry, an entry may be reachable through several keys.
+    std::unordered_map<uint32_t, double> best;
+    auto offer = [&best](uint32_t entry, double score) {
+        auto it = best.find(entry);
+        if (it == best.end())
+            best.emplace(entry, score);
+        else if (it->second < score)
+            it->second = score;
+    };
+
+    // Prefix matches score in (0.5, 1.0], an exact key scores 1.0.
+    std::vector<uint32_t> prefix_keys;
+    CollectKeys(TrieFindPrefix(needle), prefix_keys, max_results);
+    for (auto key : prefix_keys)
+    {
+        const Key& k = keys_[key];
+        offer(k.entry, 0.5 + 0.5 * static_cast<double>(needle.size()) / k.text.size());
+    }
+
+    // Fuzzy matches score in [0.15, 0.5] so that they never outrank a prefix match.
+    if (best.size() < max_results)
+    {
+        std::vector<uint32_t>                  query_trigrams = Trigrams(needle);
+        std::unordered_map<uint32_t, uint32_t> shared;
+        for (auto trigram : query_trigrams)
+        {
+            auto posting = trigrams_.find(trigram);
+            if (posting == trigrams_.end())
+                continue;
+            for (auto key : posting->second)
+                ++shared[key];
+        }
+        for (auto const& candidate : shared)
+        {
+            const Key& k    = keys_[candidate.first];
+            double     dice = 2.0 * candidate.second / (query_trigrams.size() + k.trigram_count);
+            if (dice >= kFuzzyThreshold)
+                offer(k.entry, 0.5 * dice);
+        }
+    }
+
+    matches.reserve(best.size());
+    for (auto const& hit : best)
+        matches.push_back(EmployeeMatch{ entries_[hit.first], hit.second });
+
+    std::sort(matches.begin(), matches.end(), [](const EmployeeMatch& lhs, const EmployeeMatch& rhs) {
+        return lhs.score != rhs.score ? lhs.score > rhs.score : lhs.employee_id < rhs.employee_id;
+    });
+    if (matches.size() > max_results)
+        matches.resize(max_results);
+
+    return matches;
+}
+
+size_t EmployeeIndex::Size() const
+{
+    std::lock_guard<std::mutex> guard(lock_);
+    return entry_by_id_.size();
+}
+
+uint32_t EmployeeIndex::AddKey(uint32_t entry, const std::string& text)
+{
+    std::vector<uint32_t> key_trigrams = Trigrams(text);
+
+    uint32_t key;
+    if (!free_keys_.empty())
+    {
+        key = free_keys_.back();
+        free_keys_.pop_back();
+        keys_[key] = Key{ text, entry, static_cast<uint32_t>(key_trigrams.size()) };
+    }
+    else
+    {
+        key = static_cast<uint32_t>(keys_.size());
+        keys_.push_back(Key{ text, entry, static_cast<uint32_t>(key_trigrams.size()) });
+    }
+
+    TrieInsert(text, key);
+    for (auto trigram : key_trigrams)
+        trigrams_[trigram].push_back(key);
+
+    return key;
+}
+
+void EmployeeIndex::DropKey(uint32_t key)
+{
+    const std::string& text = keys_[key].text;
+
+    TrieErase(text, key);
+    for (auto trigram : Trigrams(text))
+    {
+        auto posting = trigrams_.find(trigram);
+        if (posting == trigrams_.end())
+            continue;
+        posting->second.erase(std::remove(posting->second.begin(), posting->second.end(), key),
+                              posting->second.end());
+        if (posting->second.empty())
+            trigrams_.erase(posting);
+    }
+
+    keys_[key].text.clear();
+    free_keys_.push_back(key);
+}
+
+void EmployeeIndex::TrieInsert(const std::string& text, uint32_t key)
+{
+    TrieNode* node = root_.get();
+    size_t    pos  = 0;
+
+    while (pos < text.size())
+    {
+        TrieNode* next = nullptr;
+        for (auto& child : node->children)
+        {
+            if (child->label[0] == text[pos])
+            {
+                next = child.get();
+                break;
+            }
+        }
+
+        if (next == nullptr)
+        {
+            std::unique_ptr<TrieNode> leaf(new TrieNode());
+            leaf->label = text.substr(pos);
+            leaf->keys.push_back(key);
+            node->children.push_back(std::move(leaf));
+            return;
+        }
+
+        size_t common = 0;
+        while (common < next->label.size() && pos + common < text.size()
+               && next->label[common] == text[pos + common])
+        {
+            ++common;
+        }
+
+        // Split the edge so that the shared part of the label becomes its own node.
+        if (common < next->label.size())
+        {
+            std::unique_ptr<TrieNode> tail(new TrieNode());
+            tail->label    = next->label.substr(common);
+            tail->children = std::move(next->children);
+            tail->keys     = std::move(next->keys);
+            next->label.resize(common);
+            next->children.clear();
+            next->keys.clear();
+            next->children.push_back(std::move(tail));
+        }
+
+        node = next;
+        pos += common;
+    }
+
+    node->keys.push_back(key);
+}
+
+void EmployeeIndex::TrieErase(const std::string& text, uint32_t key)
+{
+    std::vector<TrieNode*> path(1, root_.get());
+    size_t                 pos = 0;
+
+    while (pos < text.size())
+    {
+        TrieNode* next = nullptr;
+        for (auto& child : path.back()->children)
+        {
+            if (child->label[0] == text[pos])
+            {
+                next = child.get();
+                break;
+            }
+        }
+        if (next == nullptr || text.compare(pos, next->label.size(), next->label) != 0)
+            return;
+
+        path.push_back(next);
+        pos += next->label.size();
+    }
+
+    TrieNode* node = path.back();
+    node->keys.erase(std::remove(node->keys.begin(), node->keys.end(), key), node->keys.end());
+
+    // Leave the trie as TrieInsert() would have built it without the key: keyless leaves go, and a keyless
+    // node left with a single child is merged with it.
+    for (size_t i = path.size() - 1; i > 0; --i)
+    {
+        TrieNode* current = path[i];
+        if (!current->keys.empty())
+            break;
+
+        if (current->children.empty())
+        {
+            auto& siblings = path[i - 1]->children;
+            siblings.erase(std::find_if(siblings.begin(),
+                                        siblings.end(),
+                                        [current](const std::unique_ptr<TrieNode>& child) {
+                                            return child.get() == current;
+                                        }));
+            continue;
+        }
+
+        if (current->children.size() == 1)
+        {
+            std::unique_ptr<TrieNode> only = std::move(current->children.front());
+            current->label += only->label;
+            current->keys     = std::move(only->keys);
+            current->children = std::move(only->children);
+        }
+        break;
+    }
+}
+
+const EmployeeIndex::TrieNode* EmployeeIndex::TrieFindPrefix(const std::string& prefix) const
+{
+    const TrieNode* node = root_.get();
+    size_t          pos  = 0;
+
+    while (pos < prefix.size())
+    {
+        const TrieNode* next = nullptr;
+        for (auto const& child : node->children)
+        {
+            if (child->label[0] == prefix[pos])
+            {
+                next = child.get();
+                break;
+            }
+        }
+        if (next == nullptr)
+            return nullptr;
+
+        size_t length = std::min(next->label.size(), prefix.size() - pos);
+        if (next->label.compare(0, length, prefix, pos, length) != 0)
+            return nullptr;
+
+        node = next;
+        pos += length;
+    }
+
+    return node;
+}
+
+void EmployeeIndex::CollectKeys(const TrieNode* node, std::vector<uint32_t>& keys, size_t max_entries) const
+{
+    if (node == nullptr)
+        return;
+
+    // Prefix scores fall with the key length, so nodes are visited shortest keys first. Once max_entries
+    // employees are found the keys of the same length are still taken, ties are ranked by employee id.
+    typedef std::pair<size_t, const TrieNode*> Visit;
+    auto longer = [](const Visit& lhs, const Visit& rhs) { return lhs.first > rhs.first; };
+    std::priority_queue<Visit, std::vector<Visit>, decltype(longer)> pending(longer);
+    std::unordered_set<uint32_t>                                     entries;
+    size_t                                                           depth = 0;
+
+    pending.push(Visit(0, node));
+    while (!pending.empty())
+    {
+        Visit visit = pending.top();
+        if (entries.size() >= max_entries && visit.first > depth)
+            break;
+        pending.pop();
+        depth = visit.first;
+
+        for (auto key : visit.second->keys)
+        {
+            keys.push_back(key);
+            entries.insert(keys_[key].entry);
+        }
+        for (auto const& child : visit.second->children)
+            pending.push(Visit(visit.first + child->label.size(), child.get()));
+    }
+}
+
+std::string EmployeeIndex::Normalize(const std::string& text)
+{
+    size_t begin = text.find_first_not_of(" \t");
+    if (begin == std::string::npos)
+        return std::string();
+    size_t end = text.find_last_not_of(" \t");
+
+    std::string normalized = text.substr(begin, end - begin + 1);
+    for (auto& c : normalized)
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return normalized;
+}
+
+std::vector<uint32_t> EmployeeIndex::Trigrams(const std::string& text)
+{
+    // Pad so that short keys still produce trigrams and word boundaries weigh in.
+    std::string           padded = "  " + text + " ";
+    std::vector<uint32_t> trigrams;
+    trigrams.reserve(padded.size() - 2);
+
+    for (size_t i = 0; i + 2 < padded.size(); ++i)
+    {
+        trigrams.push_back(static_cast<uint32_t>(static_cast<unsigned char>(padded[i])) << 16
+                           | static_cast<uint32_t>(static_cast<unsigned char>(padded[i + 1])) << 8
+                           | static_cast<uint32_t>(static_cast<unsigned char>(padded[i + 2])));
+    }
+
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+    return trigrams;
+}
+
+} // namespace ins_service
@@ -0,0 +1,213 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <mutex>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#include "checksum.hpp"
+#include "engine_snapshot.hpp"
+
+namespace ins_service
+{
+
+namespace
+{
+/*
+ * Snapshot layout, native byte order (a snapshot is only ever read back by the host that wrote it):
+ *
+ *   snapshot := SnapshotHeader DeviceRecord[device_count]
+ *
+ * The checksum covers the records.
+ */
+const char     kMagic[8]      = { 'I', 'N', 'S', 'S', 'N', 'A', 'P', '1' };
+const uint32_t kFormatVersion = 1;
+
+struct SnapshotHeader
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint32_t device_count;
+    uint32_t checksum;
+    int64_t  created_at;
+};
+
+bool WriteAll(int fd, const void* data, size_t size)
+{
+    const char* cursor = static_cast<const char*>(data);
+    while (size > 0)
+    {
+        ssize_t written = write(fd, cursor, size);
+        if (written < 0)
+            return false;
+        cursor += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+// Read-only mapping of a whole file, unmapped on destruction.
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::string& filename)
+        : data_(nullptr)
+        , size_(0)
+    {
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0)
+            return;
+
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0)
+        {
+            void* data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED)
+            {
+                data_ = static_cast<const char*>(data);
+                size_ = static_cast<size_t>(st.st_size);
+            }
+        }
+        close(fd);
+    }
+
+    ~MappedFile()
+    {
+        if (data_ != nullptr)
+            munmap(const_cast<char*>(data_), size_);
+    }
+
+    const char* Data() const
+    {
+        return data_;
+    }
+
+    size_t Size() const
+    {
+        return size_;
+    }
+
+private:
+    const char* data_;
+    size_t      size_;
+};
+} // namespace
+
+bool EngineSnapshot::Save(const std::string&       filename,
+                          std::shared_timed_mutex& engine_lock,
+                          DeviceRegistry&          device_registry)
+{
+    INS_LOG_DEBUG(console_, "+ EngineSnapshot::Save");
+
+    std::vector<DeviceRecord> records;
+    device_registry.VisitRecords(engine_lock, [&records](const DeviceRecord& record) { records.push_back(record); });
+
+    SnapshotHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version      = kFormatVersion;
+    header.record_size  = sizeof(DeviceRecord);
+    header.device_count = static_cast<uint32_t>(records.size());
+    header.checksum     = Crc32(records.data(), records.size() * sizeof(DeviceRecord));
+    header.created_at   = static_cast<int64_t>(std::time(nullptr));
+
+    // Write next to the old snapshot and rename over it, a crash mid-write never leaves a torn file.
+    std::string temp_filename = filename + ".tmp";
+    int         fd            = open(temp_filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        console_->error("Unable to open engine snapshot {0} for writing", temp_filename);
+        return false;
+    }
+
+    bool result = WriteAll(fd, &header, sizeof(header))
+                  && WriteAll(fd, records.data(), records.size() * sizeof(DeviceRecord)) && fsync(fd) == 0;
+    result = (close(fd) == 0) && result;
+    result = result && std::rename(temp_filename.c_str(), filename.c_str()) == 0;
+
+    if (!result)
+    {
+        console_->error("Unable to write engine snapshot {0}", filename);
+        std::remove(temp_filename.c_str());
+        return false;
+    }
+
+    console_->info("Saved engine snapshot of {0} devices to {1}", records.size(), filename);
+    INS_LOG_DEBUG(console_, "- EngineSnapshot::Save");
+    return true;
+}
+
+bool EngineSnapshot::Restore(const std::string&       filename,
+                             std::shared_timed_mutex& engine_lock,
+                             DeviceRegistry&          device_registry)
+{
+    INS_LOG_DEBUG(console_, "+ EngineSnapshot::Restore");
+
+    auto       started = std::chrono::steady_clock::now();
+    MappedFile file(filename);
+    if (file.Data() == nullptr)
+    {
+        console_->info("No engine snapshot at {0}, starting cold", filename);
+        return false;
+    }
+
+    SnapshotHeader header;
+    if (file.Size() < sizeof(header))
+    {
+        console_->error("Engine snapshot {0} is truncated", filename);
+        return false;
+    }
+    std::memcpy(&header, file.Data(), sizeof(header));
+
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kFormatVersion
+        || header.record_size != sizeof(DeviceRecord))
+    {
+        console_->error("Engine snapshot {0} has an unsupported format", filename);
+        return false;
+    }
+
+    size_t records_size = static_cast<size_t>(header.device_count) * sizeof(DeviceRecord);
+    if (file.Size() != sizeof(header) + records_size)
+    {
+        console_->error("Engine snapshot {0} is truncated", filename);
+        return false;
+    }
+
+    // The header size keeps the records aligned within the page-aligned mapping.
+    auto records = reinterpret_cast<const DeviceRecord*>(file.Data() + sizeof(header));
+    if (Crc32(records, records_size) != header.checksum)
+    {
+        console_->error("Engine snapshot {0} failed its checksum", filename);
+        return false;
+    }
+
+    for (uint32_t i = 0; i < header.device_count; ++i)
+    {
+        if (!IsValidDeviceRecord(records[i]))
+        {
+            console_->error("Engine snapshot {0} contains an invalid device record", filename);
+            return false;
+        }
+    }
+
+    {
+        std::unique_lock<std::shared_timed_mutex> lock(engine_lock);
+        for (uint32_t i = 0; i < header.device_count; ++i)
+            device_registry.Restore(records[i]);
+    }
+
+    auto elapsed
+        = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started).count();
+    console_->info(
+        "Restored engine snapshot of {0} devices from {1} in {2} us", header.device_count, filename, elapsed);
+
+    INS_LOG_DEBUG(console_, "- EngineSnapshot::Restore");
+    return true;
+}
+
+} // namespace ins_service
@@ -3,7 +3,9 @@
 //
 
 #include "ins_service.hpp"
-#include <sstream>
+
+#include <algorithm>
+#include <cstdlib>
 
 
 extern insNode_t * insNoderoot;
@@ -11,15 +13,62 @@ extern insNode_t * insNoderoot;
 namespace ins_service
 {
 
-int IndoorNavigationService::Init(Pistache::Address addr, int thread_count)
+// Upper bound on the number of matches returned by /employees/search.
+static const size_t kMaxSearchResults = 10;
+
+// Upper bound on the number of readings in one /set_rssi request.
+static const size_t kMaxReadingsPerRequest = IngestRecord::kMaxReadings;
+
+// Stage timer of the localization engine, see insSetStageTimer(); stages are reported as they end.
+static void RecordEngineStage(insStage_t stage, long duration_ns)
+{
+    DefaultMetrics().RecordStage(stage == INS_STAGE_FILTER ? Stage::kFilter : Stage::kSolve,
+                                 std::chrono::nanoseconds(duration_ns));
+
+    Tracer::Clock::time_point now = Tracer::Clock::now();
+    DefaultTracer().Record(stage == INS_STAGE_FILTER ? "WifiNode::computePLProcess" : "WifiNode::trilaterationProcess",
+                           CurrentTrace(),
+                           now - std::chrono::nanoseconds(duration_ns),
+                           now);
+}
+
+int IndoorNavigationService::Init(Pistache::Address addr, int thread_count, const ServiceOptions& options)
 {
-    console_->debug("+ IndoorNavigationService::Init");
+    INS_LOG_DEBUG(console_, "+ IndoorNavigationService::Init");
+
+    options_ = options;
 
     data_store_ = std::make_shared<DataStore>();
     data_store_->Init("../ins.db");
 
+    storage_writer_ = std::make_shared<StorageWriter>(data_store_, options_.ingest_queue_capacity);
+
+    position_index_ = std::make_shared<PositionIndex>();
+    position_index_->Load(*data_store_);
+
+    size_t device_shards = options_.device_shards;
+    if (device_shards == 0)
+        device_shards = std::max(1u, std::thread::hardware_concurrency());
+    device_executor_ = std::make_shared<DeviceExecutor>(device_shards, options_.device_queue_limit);
+
+    upload_limiter_ = std::make_shared<DeviceRateLimiter>(options_.upload_rate, options_.upload_burst);
+
+    admission_ = std::make_shared<AdmissionController>(
+        options_.max_inflight_reads, options_.max_inflight_device_ops, options_.max_inflight_uploads);
+
+    // Lookups from the apps get their own pool, so device traffic never queues in front of them.
+    read_pool_ = std::make_shared<TaskPool>(
+        "read", options_.read_threads, options_.read_queue_limit, ThreadPriority::kInteractive);
+
     localization_ = std::make_shared<Localization>();
 
+    employee_index_ = std::make_shared<EmployeeIndex>();
+    for (auto const& employee_id : data_store_->GetEmployeeIds())
+    {
+        employee_index_->Insert(employee_id);
+    }
+    console_->info("Indexed {0} employees for search", employee_index_->Size());
+
     http_end_point_ = std::make_shared<Pistache::Http::Endpoint>(addr);
     auto opts
         = Pistache::Http::Endpoint::options().threads(thread_count).flags(Pistache::Tcp::Options::InstallSignalHandler);
@@ -27,38 +76,104 @@ int IndoorNavigationService::Init(Pistache::Address addr, int thread_count)
     HttpEndpointInit(http_end_point_, opts);
 
     lcfg_initialize("WifiNodeLCFG.xml");
+    insSetStageTimer(&RecordEngineStage);
+    tracer_->SetSampleEvery(options_.trace_sample_every);
+    if (options_.enable_profiler)
+        profiler_ = std::make_shared<Profiler>();
+
+    size_t max_resident_devices
+        = static_cast<size_t>(options_.device_memory_budget_mb) * 1024 * 1024 / sizeof(insNode_t);
+    // Pre-fault device blocks before the registry (or the snapshot restore) starts taking them.
+    uint32_t prefault_devices
+        = static_cast<uint32_t>(std::min<size_t>(options_.prefault_devices, max_resident_devices));
+    if (insNodePoolInit(INS_NODE_POOL_SLAB_BLOCKS, prefault_devices) != 0)
+    {
+        console_->error("Failed to pre-fault {0} device blocks", prefault_devices);
+    }
+    device_registry_ = std::make_shared<DeviceRegistry>(max_resident_devices, options_.spill_file);
+    device_registry_->Init();
+
+    engine_snapshot_ = std::make_shared<EngineSnapshot>();
+    if (!options_.snapshot_file.empty())
+    {
+        engine_snapshot_->Restore(options_.snapshot_file, engine_lock_, *device_registry_);
+    }
 
     SetupRoutes();
 
-    console_->debug("- IndoorNavigationService::Init");
+    INS_LOG_DEBUG(console_, "- IndoorNavigationService::Init");
     return 0;
 }
 
 void IndoorNavigationService::Start()
 {
-    console_->debug("+ IndoorNavigationService::Start");
+    INS_LOG_DEBUG(console_, "+ IndoorNavigationService::Start");
+
+    storage_writer_->Start();
+    device_executor_->Start();
+    read_pool_->Start();
+    position_index_->Start();
 
     HttpEndpointSetHandler(http_end_point_, router_);
     console_->info("Indoor Navigation Service now running ...");
     HttpEndpointServe(http_end_point_);
 
-    console_->debug("- IndoorNavigationService::Start");
+    if (!options_.snapshot_file.empty() && options_.snapshot_interval_s > 0)
+    {
+        snapshot_stop_   = false;
+        snapshot_thread_ = std::thread(&IndoorNavigationService::RunSnapshots, this);
+    }
+
+    INS_LOG_DEBUG(console_, "- IndoorNavigationService::Start");
 }
 
 void IndoorNavigationService::Shutdown()
 {
-    console_->debug("+ IndoorNavigationService::Shutdown");
+    INS_LOG_DEBUG(console_, "+ IndoorNavigationService::Shutdown");
 
     console_->info("Indoor Navigation Service is shutting down ...");
+    // A running profile is cut short and answered while the endpoint still serves.
+    profiler_.reset();
     HttpEndpointShutdown(http_end_point_);
+
+    // Finish pending requests, then store whatever they queued before the database goes away.
+    read_pool_->Stop();
+    device_executor_->Stop();
+    position_index_->Stop();
+    DeviceExecutorStats executor_stats = device_executor_->GetStats();
+    console_->info("Device shards ran {0} operations, {1} stolen", executor_stats.executed, executor_stats.stolen);
+    console_->info("Shed {0} lookups, {1} device operations and {2} uploads over their limits",
+                   admission_->Shed(RouteClass::kInteractive),
+                   admission_->Shed(RouteClass::kDevice),
+                   admission_->Shed(RouteClass::kIngest));
+    console_->info("Throttled {0} uploads of devices over their rate", upload_limiter_->Throttled());
+    storage_writer_->Stop();
+    console_->info("Ingest queue stopped with {0} uploads pending", storage_writer_->Depth());
+
+    StopSnapshots();
+    if (!options_.snapshot_file.empty())
+    {
+        engine_snapshot_->Save(options_.snapshot_file, engine_lock_, *device_registry_);
+    }
+
     data_store_->Close();
 
-    console_->debug("- IndoorNavigationService::Shutdown");
+    insNodePoolStats_t pool_stats;
+    insNodePoolGetStats(&pool_stats);
+    console_->info("Device pool: {0} of {1} blocks in use ({2} peak) in {3} slabs, {4} allocations, {5} releases",
+                   pool_stats.inUse,
+                   pool_stats.capacity,
+                   pool_stats.highWater,
+                   pool_stats.slabs,
+                   pool_stats.allocations,
+                   pool_stats.releases);
+
+    INS_LOG_DEBUG(console_, "- IndoorNavigationService::Shutdown");
 }
 
 void IndoorNavigationService::SetupRoutes()
 {
-    console_->debug("+ IndoorNavigationService::SetupRoutes");
+    INS_LOG_DEBUG(console_, "+ IndoorNavigationService::SetupRoutes");
 
     Pistache::Rest::Routes::Post(
         router_,
@@ -83,169 +198,633 @@ void IndoorNavigationService::SetupRoutes()
                                 "/get_employee_pos/:employee_id",
                                 Pistache::Rest::Routes::bind(&IndoorNavigationService::GetEmployeePosition, this));
 
+    Pistache::Rest::Routes::Get(router_,
+                                "/employees/search",
+                                Pistache::Rest::Routes::bind(&IndoorNavigationService::SearchEmployees, this));
+
     Pistache::Rest::Routes::Get(
         router_, "/ready", Pistache::Rest::Routes::bind(&IndoorNavigationService::HandleReady, this));
 
+    Pistache::Rest::Routes::Get(
+        router_, "/metrics", Pistache::Rest::Routes::bind(&IndoorNavigationService::HandleMetrics, this));
+
+    Pistache::Rest::Routes::Get(
+        router_, "/debug/trace", Pistache::Rest::Routes::bind(&IndoorNavigationService::HandleTrace, this));
+
+    Pistache::Rest::Routes::Get(
+        router_, "/debug/profile", Pistache::Rest::Routes::bind(&IndoorNavigationService::HandleProfile, this));
+
     Pistache::Rest::Routes::Get(router_, "/auth", Pistache::Rest::Routes::bind(&IndoorNavigationService::Auth, this));
 
-    console_->debug("- IndoorNavigationService::SetupRoutes");
+    INS_LOG_DEBUG(console_, "- IndoorNavigationService::SetupRoutes");
 }
 
 void IndoorNavigationService::SetReceivedSignalStrengths(const Pistache::Rest::Request& request,
                                                          Pistache::Http::ResponseWriter response)
 {
-    console_->debug("+ IndoorNavigationService::SetReceivedSignalStrengths");
-
-    std::string device_id = request.param(":device_id").as<std::string>();
+    INS_LOG_DEBUG(console_, "+ IndoorNavigationService::SetReceivedSignalStrengths");
 
-    std::vector<AccessPointRssiPair> accesspoint_rssi_pair_list;
+    auto writer = std::make_shared<MeteredResponse>(*metrics_, Route::kSetRssi, std::move(response));
 
-    //Read and insert first datapoint.
-    AccessPoint access_point(request.param(":mac_addr1").as<std::string>());
-    accesspoint_rssi_pair_list.push_back(std::make_pair(access_point, request.param(":rssi1").as<int32_t>()));
+    uint64_t   trace = tracer_->StartTrace();
+    TraceScope trace_scope(trace);
+    TraceSpan  span("IndoorNavigationService::SetReceivedSignalStrengths");
 
-    //Read and insert other datapoints.
-    for (int i = 2; i <= 10; ++i)
+    // The path is parsed in place into fixed-size ids and readings, without copying it.
+    DeviceId device_id;
+    if (!ParseUploadDeviceId(request.resource(), device_id))
     {
-        std::stringstream mac_addr_key, rssi_key;
-        mac_addr_key << ":mac_addr" << i;
-        rssi_key << ":rssi" << i;
-        if (request.hasParam(mac_addr_key.str()) && request.hasParam(rssi_key.str()))
-        {
-            AccessPoint ap(request.param(mac_addr_key.str()).as<std::string>());
-            accesspoint_rssi_pair_list.push_back(std::make_pair(ap, request.param(rssi_key.str()).as<int32_t>()));
-        }
-        else
-        {
-            break;
-        }
+        writer->send(Pistache::Http::Code::Bad_Request, "{result:error}");
+        return;
     }
 
-    // @TODO Keep class aware of created device tables to avoid always calling this function.
-    if (!data_store_->CreateDeviceTable(device_id))
+    // A flooding device is turned away before any of its readings are parsed or stored.
+    if (!upload_limiter_->TryAcquire(device_id))
     {
-        response.send(Pistache::Http::Code::Internal_Server_Error, "{result:error}");
+        writer->headers().addRaw(
+            Pistache::Http::Header::Raw("Retry-After", std::to_string(upload_limiter_->RetryAfter())));
+        writer->send(Pistache::Http::Code::Too_Many_Requests, "{result:error}");
         return;
     }
-    if (!data_store_->InsertRSSIReadings(device_id, accesspoint_rssi_pair_list))
+
+    RssiReading readings[kMaxReadingsPerRequest];
+    size_t      count = 0;
+    if (!ParseRssiUpload(request.resource(), device_id, readings, kMaxReadingsPerRequest, count))
     {
-        response.send(Pistache::Http::Code::Internal_Server_Error, "{result:error}");
+        writer->send(Pistache::Http::Code::Bad_Request, "{result:error}");
         return;
     }
 
-    (void)createInsNodeListDevice((const char *)device_id.c_str());
-
-    console_->debug("- IndoorNavigationService::SetReceivedSignalStrengths");
+    auto ticket = admission_->Admit(RouteClass::kIngest);
+    if (ticket == nullptr)
+    {
+        SendBusy(*writer, RouteClass::kIngest, "{result:error}");
+        return;
+    }
 
-    response.send(Pistache::Http::Code::Ok, "{result:success}");
+#ifdef INS_ENABLE_COROUTINES
+    IngestRecord upload;
+    upload.device_id = device_id;
+    upload.count     = static_cast<uint32_t>(count);
+    std::copy(readings, readings + count, upload.readings);
+    StoreUpload(upload, writer, ticket, trace);
+#else
+    Tracer::Clock::time_point queued = Tracer::Clock::now();
+
+    bool posted
+        = device_executor_->TryPost(device_id, [this, device_id, readings, count, writer, ticket, trace, queued] {
+        RunRequest(*writer, "{result:error}", [&] {
+            TraceScope trace_scope(trace);
+            tracer_->Record("DeviceExecutor::queue", trace, queued, Tracer::Clock::now());
+
+            // Readings are stored by the storage thread; a full queue means storage is not keeping up.
+            if (!storage_writer_->Submit(device_id, readings, count))
+            {
+                SendBusy(*writer, RouteClass::kIngest, "{result:error}");
+                return;
+            }
+            ActivateDevice(device_id);
+            writer->send(Pistache::Http::Code::Ok, "{result:success}");
+        });
+    });
+    if (!posted)
+        SendBusy(*writer, RouteClass::kIngest, "{result:error}");
+#endif // INS_ENABLE_COROUTINES
+
+    INS_LOG_DEBUG(console_, "- IndoorNavigationService::SetReceivedSignalStrengths");
 }
 
 void IndoorNavigationService::ResolveDevicePosition(const Pistache::Rest::Request& request,
                                                     Pistache::Http::ResponseWriter response)
 {
-    console_->debug("+ IndoorNavigationService::ResolveDevicePosition");
+    INS_LOG_DEBUG(console_, "+ IndoorNavigationService::ResolveDevicePosition");
 
-    std::string device_id = request.param(":device_id").as<std::string>();
+    auto writer = std::make_shared<MeteredResponse>(*metrics_, Route::kResolvePos, std::move(response));
 
-    Position pos = localization_->ProcessRSSIDataSet(device_id);
-    if (!data_store_->UpdateDeviceLocation(device_id, pos))
+    uint64_t   trace = tracer_->StartTrace();
+    TraceScope trace_scope(trace);
+    TraceSpan  span("IndoorNavigationService::ResolveDevicePosition");
+
+    // Ids that FixedString would truncate, or that cannot name a device table, are refused up front.
+    std::string device_id = request.param(":device_id").as<std::string>();
+    DeviceId    id;
+    if (!ParseDeviceId(device_id, id))
     {
-        response.send(Pistache::Http::Code::Internal_Server_Error, "{result:error}");
+        writer->send(Pistache::Http::Code::Bad_Request, "{result:error}");
         return;
     }
 
-    response.send(Pistache::Http::Code::Ok, "{result:success}");
+    auto ticket = admission_->Admit(RouteClass::kDevice);
+    if (ticket == nullptr)
+    {
+        SendBusy(*writer, RouteClass::kDevice, "{result:error}");
+        return;
+    }
 
-    console_->debug("- IndoorNavigationService::ResolveDevicePosition");
+    // The device's actor is the only thread touching its node, the engine lock only guards the device
+    // list shared with other devices and the registry has a lock of its own.
+#ifdef INS_ENABLE_COROUTINES
+    ResolvePosition(device_id, writer, ticket, trace);
+#else
+    Tracer::Clock::time_point queued = Tracer::Clock::now();
+
+    // Uploads of the device posted before this request reach the storage queue on its actor; the wait for
+    // storage happens off the shard, which keeps running other devices meanwhile.
+    bool posted = device_executor_->TryPost(id, [this, id, device_id, writer, ticket, trace, queued] {
+        storage_writer_->OnStored([this, id, device_id, writer, ticket, trace, queued] {
+            bool resumed = device_executor_->TryPost(id, [this, device_id, writer, ticket, trace, queued] {
+                RunRequest(*writer, "{result:error}", [&] {
+                    // Queueing and the wait for storage make one span.
+                    TraceScope trace_scope(trace);
+                    tracer_->Record("IndoorNavigationService::wait", trace, queued, Tracer::Clock::now());
+
+                    if (!ResolveAndStorePosition(device_id))
+                    {
+                        writer->send(Pistache::Http::Code::Internal_Server_Error, "{result:error}");
+                        return;
+                    }
+                    writer->send(Pistache::Http::Code::Ok, "{result:success}");
+                });
+            });
+            if (!resumed)
+                SendBusy(*writer, RouteClass::kDevice, "{result:error}");
+        });
+    });
+    if (!posted)
+        SendBusy(*writer, RouteClass::kDevice, "{result:error}");
+#endif // INS_ENABLE_COROUTINES
+
+    INS_LOG_DEBUG(console_, "- IndoorNavigationService::ResolveDevicePosition");
 }
+
 void IndoorNavigationService::ResetDevicePosition(const Pistache::Rest::Request& request,
                                                   Pistache::Http::ResponseWriter response)
 {
-    console_->debug("+ IndoorNavigationService::ResetDeviceLocation");
+    INS_LOG_DEBUG(console_, "+ IndoorNavigationService::ResetDeviceLocation");
+
+    auto writer = std::make_shared<MeteredResponse>(*metrics_, Route::kResetPos, std::move(response));
+
+    uint64_t   trace = tracer_->StartTrace();
+    TraceScope trace_scope(trace);
+    TraceSpan  span("IndoorNavigationService::ResetDevicePosition");
 
+    // Ids that FixedString would truncate, or that cannot name a device table, are refused up front.
     std::string device_id = request.param(":device_id").as<std::string>();
-    if (!data_store_->ClearDeviceTable(device_id))
+    DeviceId    id;
+    if (!ParseDeviceId(device_id, id))
+    {
+        writer->send(Pistache::Http::Code::Bad_Request, "{result:error}");
+        return;
+    }
+
+    auto ticket = admission_->Admit(RouteClass::kDevice);
+    if (ticket == nullptr)
+    {
+        SendBusy(*writer, RouteClass::kDevice, "{result:error}");
+        return;
+    }
+
+#ifdef INS_ENABLE_COROUTINES
+    ResetPosition(device_id, writer, ticket, trace);
+#else
+    Tracer::Clock::time_point queued = Tracer::Clock::now();
+
+    // Queued readings predate the reset, they are stored first so they are cleared too.
+    bool posted = device_executor_->TryPost(id, [this, id, device_id, writer, ticket, trace, queued] {
+        storage_writer_->OnStored([this, id, device_id, writer, ticket, trace, queued] {
+            bool resumed = device_executor_->TryPost(id, [this, device_id, writer, ticket, trace, queued] {
+                RunRequest(*writer, "{result:error}", [&] {
+                    // Queueing and the wait for storage make one span.
+                    TraceScope trace_scope(trace);
+                    tracer_->Record("IndoorNavigationService::wait", trace, queued, Tracer::Clock::now());
+
+                    if (!data_store_->ClearDeviceTable(device_id))
+                    {
+                        writer->send(Pistache::Http::Code::Internal_Server_Error, "{result:error}");
+                        return;
+                    }
+                    writer->send(Pistache::Http::Code::Ok, "{result:success}");
+                });
+            });
+            if (!resumed)
+                SendBusy(*writer, RouteClass::kDevice, "{result:error}");
+        });
+    });
+    if (!posted)
+        SendBusy(*writer, RouteClass::kDevice, "{result:error}");
+#endif // INS_ENABLE_COROUTINES
+
+    INS_LOG_DEBUG(console_, "- IndoorNavigationService::ResetDeviceLocation");
+}
+
+void IndoorNavigationService::SendBusy(MeteredResponse& writer, RouteClass route_class, const std::string& body)
+{
+    writer.headers().addRaw(
+        Pistache::Http::Header::Raw("Retry-After", std::to_string(admission_->RetryAfter(route_class))));
+    writer.send(Pistache::Http::Code::Service_Unavailable, body);
+}
+
+void IndoorNavigationService::RunRequest(MeteredResponse&             writer,
+                                         const std::string&           error_body,
+                                         const std::function<void()>& body)
+{
+    try
+    {
+        body();
+        return;
+    }
+    catch (const std::exception& e)
+    {
+        console_->error("Request failed: {0}", e.what());
+    }
+    catch (...)
+    {
+        console_->error("Request failed with an unknown exception");
+    }
+    if (!writer.sent())
+        writer.send(Pistache::Http::Code::Internal_Server_Error, error_body);
+}
+
+void IndoorNavigationService::ActivateDevice(const DeviceId& device_id, bool pin)
+{
+    // A resident device only moves up the registry. The engine lock is taken exclusively when the device list
+    // changes, to create or rehydrate the device and evict others.
+    if (device_registry_->Touch(device_id, pin))
+        return;
+
+    std::unique_lock<std::shared_timed_mutex> lock(engine_lock_);
+    (void)device_registry_->Acquire(device_id, pin);
+}
+
+bool IndoorNavigationService::ResolveAndStorePosition(const std::string& device_id)
+{
+    TraceSpan span("IndoorNavigationService::ResolveAndStorePosition");
+
+    // Registers (or rehydrates) and pins the device up front so it cannot be evicted while it is being
+    // processed, and unpins it however processing ends.
+    class PinnedDevice
+    {
+    public:
+        PinnedDevice(IndoorNavigationService& service, const std::string& device_id)
+            : service_(service)
+            , device_id_(device_id)
+        {
+            service_.ActivateDevice(device_id_, true);
+        }
+
+        ~PinnedDevice()
+        {
+            service_.device_registry_->Unpin(device_id_);
+        }
+
+    private:
+        IndoorNavigationService& service_;
+        DeviceId                 device_id_;
+    };
+
+    Position pos;
+    {
+        PinnedDevice pinned(*this, device_id);
+        pos = localization_->ProcessRSSIDataSet(device_id, engine_lock_);
+    }
+
+    if (!data_store_->UpdateDeviceLocation(device_id, pos))
+        return false;
+
+    position_index_->UpdateDevicePosition(DeviceId(device_id), pos);
+    return true;
+}
+
+#ifdef INS_ENABLE_COROUTINES
+DetachedTask IndoorNavigationService::StoreUpload(IngestRecord upload,
+                                                  std::shared_ptr<MeteredResponse>             writer,
+                                                  std::shared_ptr<AdmissionController::Ticket> ticket,
+                                                  uint64_t                                     trace)
+{
+    Tracer::Clock::time_point queued = Tracer::Clock::now();
+    if (!co_await ResumeOnDevice(*device_executor_, upload.device_id))
     {
-        response.send(Pistache::Http::Code::Internal_Server_Error, "{result:error}");
+        SendBusy(*writer, RouteClass::kIngest, "{result:error}");
+        co_return;
     }
-    response.send(Pistache::Http::Code::Ok, "{result:success}");
+    // The rest runs on the device's actor without suspending, the scope ends on this thread.
+    RunRequest(*writer, "{result:error}", [&] {
+        TraceScope trace_scope(trace);
+        tracer_->Record("DeviceExecutor::queue", trace, queued, Tracer::Clock::now());
 
-    console_->debug("- IndoorNavigationService::ResetDeviceLocation");
+        if (!storage_writer_->Submit(upload.device_id, upload.readings, upload.count))
+        {
+            SendBusy(*writer, RouteClass::kIngest, "{result:error}");
+            return;
+        }
+        ActivateDevice(upload.device_id);
+        writer->send(Pistache::Http::Code::Ok, "{result:success}");
+    });
 }
 
+DetachedTask IndoorNavigationService::ResolvePosition(std::string device_id,
+                                                      std::shared_ptr<MeteredResponse>             writer,
+                                                      std::shared_ptr<AdmissionController::Ticket> ticket,
+                                                      uint64_t                                     trace)
+{
+    Tracer::Clock::time_point queued = Tracer::Clock::now();
+    // Uploads of the device posted before this request reach the storage queue on its actor; the wait
+    // for storage happens off the shard, which keeps running other devices meanwhile.
+    if (!co_await ResumeOnDevice(*device_executor_, DeviceId(device_id)))
+    {
+        SendBusy(*writer, RouteClass::kDevice, "{result:error}");
+        co_return;
+    }
+    co_await ResumeWhenStored(*storage_writer_);
+    if (!co_await ResumeOnDevice(*device_executor_, DeviceId(device_id)))
+    {
+        SendBusy(*writer, RouteClass::kDevice, "{result:error}");
+        co_return;
+    }
+    // Queueing and the wait for storage make one span, the rest runs without suspending.
+    RunRequest(*writer, "{result:error}", [&] {
+        TraceScope trace_scope(trace);
+        tracer_->Record("IndoorNavigationService::wait", trace, queued, Tracer::Clock::now());
+
+        if (!ResolveAndStorePosition(device_id))
+        {
+            writer->send(Pistache::Http::Code::Internal_Server_Error, "{result:error}");
+            return;
+        }
+        writer->send(Pistache::Http::Code::Ok, "{result:success}");
+    });
+}
+
+DetachedTask IndoorNavigationService::ResetPosition(std::string device_id,
+                                                    std::shared_ptr<MeteredResponse>             writer,
+                                                    std::shared_ptr<AdmissionController::Ticket> ticket,
+                                                    uint64_t                                     trace)
+{
+    Tracer::Clock::time_point queued = Tracer::Clock::now();
+    // Queued readings predate the reset, they are stored first so they are cleared too.
+    if (!co_await ResumeOnDevice(*device_executor_, DeviceId(device_id)))
+    {
+        SendBusy(*writer, RouteClass::kDevice, "{result:error}");
+        co_return;
+    }
+    co_await ResumeWhenStored(*storage_writer_);
+    if (!co_await ResumeOnDevice(*device_executor_, DeviceId(device_id)))
+    {
+        SendBusy(*writer, RouteClass::kDevice, "{result:error}");
+        co_return;
+    }
+    // Queueing and the wait for storage make one span, the rest runs without suspending.
+    RunRequest(*writer, "{result:error}", [&] {
+        TraceScope trace_scope(trace);
+        tracer_->Record("IndoorNavigationService::wait", trace, queued, Tracer::Clock::now());
+
+        if (!data_store_->ClearDeviceTable(device_id))
+        {
+            writer->send(Pistache::Http::Code::Internal_Server_Error, "{result:error}");
+            return;
+        }
+        writer->send(Pistache::Http::Code::Ok, "{result:success}");
+    });
+}
+#endif // INS_ENABLE_COROUTINES
+
 void IndoorNavigationService::GetDevicePosition(const Pistache::Rest::Request& request,
                                                 Pistache::Http::ResponseWriter response)
 {
-    console_->debug("+ IndoorNavigationService::GetDevicePosition");
+    INS_LOG_DEBUG(console_, "+ IndoorNavigationService::GetDevicePosition");
 
-    std::string device_id = request.param(":device_id").as<std::string>();
+    auto writer = std::make_shared<MeteredResponse>(*metrics_, Route::kGetDevicePos, std::move(response));
 
-    Position pos;
-    if (data_store_->GetPosition(device_id, QueryT::DEVICE, pos))
+    std::string device_id = request.param(":device_id").as<std::string>();
+    DeviceId    id;
+    if (!ParseDeviceId(device_id, id))
     {
-        response.send(Pistache::Http::Code::Ok,
-                      "{device_id:" + device_id + ",pos_x:" + std::to_string(pos.x) + ",pos_y:" + std::to_string(pos.y)
-                          + ",pos_z:"
-                          + std::to_string(pos.z)
-                          + "}");
-        console_->info("X-{:03.3}, Y-{:03.3}, Z-{:03.3}, ", pos.x, pos.y, pos.z);
+        writer->send(Pistache::Http::Code::Bad_Request, "{error: invalid device_id}");
+        return;
     }
-    else
+
+    auto ticket = admission_->Admit(RouteClass::kInteractive);
+    if (ticket == nullptr)
     {
-        response.send(Pistache::Http::Code::Internal_Server_Error, "{error: device_id not found}");
+        SendBusy(*writer, RouteClass::kInteractive, "{error: server busy}");
+        return;
     }
 
-    console_->debug("- IndoorNavigationService::GetDevicePosition");
+    bool posted = read_pool_->TrySubmit([this, device_id, id, writer, ticket] {
+        RunRequest(*writer, "{error: internal error}", [&] {
+            Position pos;
+            if (position_index_->GetDevicePosition(id, pos))
+            {
+                writer->send(Pistache::Http::Code::Ok,
+                             "{device_id:" + device_id + ",pos_x:" + std::to_string(pos.x) + ",pos_y:"
+                                 + std::to_string(pos.y)
+                                 + ",pos_z:"
+                                 + std::to_string(pos.z)
+                                 + "}");
+                INS_LOG_DEBUG(console_, "X-{:03.3}, Y-{:03.3}, Z-{:03.3}, ", pos.x, pos.y, pos.z);
+            }
+            else
+            {
+                writer->send(Pistache::Http::Code::Internal_Server_Error, "{error: device_id not found}");
+            }
+        });
+    });
+    if (!posted)
+        SendBusy(*writer, RouteClass::kInteractive, "{error: server busy}");
+
+    INS_LOG_DEBUG(console_, "- IndoorNavigationService::GetDevicePosition");
 }
 
 void IndoorNavigationService::GetEmployeePosition(const Pistache::Rest::Request& request,
                                                   Pistache::Http::ResponseWriter response)
 {
-    console_->debug("+ IndoorNavigationService::GetEmployeePosition");
+    INS_LOG_DEBUG(console_, "+ IndoorNavigationService::GetEmployeePosition");
+
+    auto writer = std::make_shared<MeteredResponse>(*metrics_, Route::kGetEmployeePos, std::move(response));
 
     std::string employee_id = request.param(":employee_id").as<std::string>();
 
-    Position pos;
-    if (data_store_->GetPosition(employee_id, QueryT::EMPLOYEE, pos))
+    auto ticket = admission_->Admit(RouteClass::kInteractive);
+    if (ticket == nullptr)
     {
-        response.send(Pistache::Http::Code::Ok,
-                      "{employee_id:" + employee_id + ",pos_x:" + std::to_string(pos.x) + ",pos_y:"
-                          + std::to_string(pos.y)
-                          + ",pos_z:"
-                          + std::to_string(pos.z)
-                          + "}");
-        console_->info("X-{:03.3}, Y-{:03.3}, Z-{:03.3}, ", pos.x, pos.y, pos.z);
+        SendBusy(*writer, RouteClass::kInteractive, "{error: server busy}");
+        return;
     }
-    else
+
+    bool posted = read_pool_->TrySubmit([this, employee_id, writer, ticket] {
+        RunRequest(*writer, "{error: internal error}", [&] {
+            Position pos;
+            if (position_index_->GetEmployeePosition(employee_id, pos))
+            {
+                writer->send(Pistache::Http::Code::Ok,
+                             "{employee_id:" + employee_id + ",pos_x:" + std::to_string(pos.x) + ",pos_y:"
+                                 + std::to_string(pos.y)
+                                 + ",pos_z:"
+                                 + std::to_string(pos.z)
+                                 + "}");
+                INS_LOG_DEBUG(console_, "X-{:03.3}, Y-{:03.3}, Z-{:03.3}, ", pos.x, pos.y, pos.z);
+            }
+            else
+            {
+                writer->send(Pistache::Http::Code::Internal_Server_Error, "{error: employee_id not found}");
+            }
+        });
+    });
+    if (!posted)
+        SendBusy(*writer, RouteClass::kInteractive, "{error: server busy}");
+
+    INS_LOG_DEBUG(console_, "- IndoorNavigationService::GetEmployeePosition");
+}
+
+void IndoorNavigationService::SearchEmployees(const Pistache::Rest::Request& request,
+                                              Pistache::Http::ResponseWriter response)
+{
+    INS_LOG_DEBUG(console_, "+ IndoorNavigationService::SearchEmployees");
+
+    auto writer = std::make_shared<MeteredResponse>(*metrics_, Route::kSearchEmployees, std::move(response));
+
+    auto query = request.query().get("q");
+    if (query.isEmpty() || query.get().empty())
+    {
+        writer->send(Pistache::Http::Code::Bad_Request, "{error: query parameter q is required}");
+        return;
+    }
+
+    auto ticket = admission_->Admit(RouteClass::kInteractive);
+    if (ticket == nullptr)
+    {
+        SendBusy(*writer, RouteClass::kInteractive, "{error: server busy}");
+        return;
+    }
+
+    std::string prefix = query.get();
+    bool        posted = read_pool_->TrySubmit([this, prefix, writer, ticket] {
+        RunRequest(*writer, "{error: internal error}", [&] {
+            // All matches are read from the same version of the index.
+            auto        positions = position_index_->Read();
+            std::string body      = "[";
+            for (auto const& match : employee_index_->Search(prefix, kMaxSearchResults))
+            {
+                Position pos{ 0, 0, 0 };
+                positions->FindEmployee(match.employee_id, pos);
+                if (body.size() > 1)
+                    body += ",";
+                body += "{employee_id:" + match.employee_id + ",score:" + std::to_string(match.score)
+                        + ",pos_x:" + std::to_string(pos.x) + ",pos_y:" + std::to_string(pos.y)
+                        + ",pos_z:" + std::to_string(pos.z) + "}";
+            }
+            body += "]";
+
+            writer->send(Pistache::Http::Code::Ok, body);
+        });
+    });
+    if (!posted)
+        SendBusy(*writer, RouteClass::kInteractive, "{error: server busy}");
+
+    INS_LOG_DEBUG(console_, "- IndoorNavigationService::SearchEmployees");
+}
+
+void IndoorNavigationService::HandleMetrics(const Pistache::Rest::Request& request,
+                                            Pistache::Http::ResponseWriter response)
+{
+    INS_LOG_DEBUG(console_, "+ IndoorNavigationService::HandleMetrics");
+
+    // Served on the HTTP thread and never shed, a scrape has to get through when the server is busiest.
+    std::string body;
+    metrics_->Render(body);
+
+    Metrics::RenderHeader(body, "ins_ingest_queue_depth", "gauge", "Uploads waiting for the storage thread.");
+    Metrics::RenderValue(body, "ins_ingest_queue_depth", "", storage_writer_->Depth());
+    Metrics::RenderHeader(body, "ins_device_ops_pending", "gauge", "Device operations waiting for a shard.");
+    Metrics::RenderValue(body, "ins_device_ops_pending", "", device_executor_->GetStats().pending);
+    Metrics::RenderHeader(body, "ins_read_queue_depth", "gauge", "Lookups waiting for the read pool.");
+    Metrics::RenderValue(body, "ins_read_queue_depth", "", read_pool_->Depth());
+
+    Metrics::RenderHeader(body, "ins_requests_shed_total", "counter", "Requests shed over their limits, by class.");
+    Metrics::RenderValue(
+        body, "ins_requests_shed_total", "class=\"interactive\"", admission_->Shed(RouteClass::kInteractive));
+    Metrics::RenderValue(
+        body, "ins_requests_shed_total", "class=\"device\"", admission_->Shed(RouteClass::kDevice));
+    Metrics::RenderValue(
+        body, "ins_requests_shed_total", "class=\"ingest\"", admission_->Shed(RouteClass::kIngest));
+    Metrics::RenderHeader(body, "ins_uploads_throttled_total", "counter", "Uploads of devices over their rate.");
+    Metrics::RenderValue(body, "ins_uploads_throttled_total", "", upload_limiter_->Throttled());
+
+    response.send(Pistache::Http::Code::Ok, body);
+
+    INS_LOG_DEBUG(console_, "- IndoorNavigationService::HandleMetrics");
+}
+
+void IndoorNavigationService::HandleTrace(const Pistache::Rest::Request& request,
+                                          Pistache::Http::ResponseWriter response)
+{
+    INS_LOG_DEBUG(console_, "+ IndoorNavigationService::HandleTrace");
+    (void)request;
+
+    // Spans stay in their rings, every dump holds the latest spans of each thread.
+    std::string body;
+    tracer_->Dump(body);
+    response.send(Pistache::Http::Code::Ok, body);
+
+    INS_LOG_DEBUG(console_, "- IndoorNavigationService::HandleTrace");
+}
+
+void IndoorNavigationService::HandleProfile(const Pistache::Rest::Request& request,
+                                            Pistache::Http::ResponseWriter response)
+{
+    INS_LOG_DEBUG(console_, "+ IndoorNavigationService::HandleProfile");
+
+    if (profiler_ == nullptr)
+    {
+        response.send(Pistache::Http::Code::Not_Found, "{error: profiler not enabled}");
+        return;
+    }
+
+    uint32_t seconds = 10;
+    auto     query   = request.query().get("seconds");
+    if (!query.isEmpty())
     {
-        response.send(Pistache::Http::Code::Internal_Server_Error, "{error: employee_id not found}");
+        seconds = static_cast<uint32_t>(std::strtoul(query.get().c_str(), nullptr, 10));
+        if (seconds == 0 || seconds > Profiler::kMaxSeconds)
+        {
+            response.send(Pistache::Http::Code::Bad_Request, "{error: seconds must be 1 to 60}");
+            return;
+        }
     }
 
-    console_->debug("- IndoorNavigationService::GetEmployeePosition");
+    // The profiler's thread answers once the profile is taken, no HTTP thread waits for it.
+    auto writer  = std::make_shared<Pistache::Http::ResponseWriter>(std::move(response));
+    bool started = profiler_->Start(std::chrono::seconds(seconds), [writer](const std::string& stacks) {
+        writer->send(Pistache::Http::Code::Ok, stacks);
+    });
+    if (!started)
+        writer->send(Pistache::Http::Code::Conflict, "{error: a profile is already running}");
+
+    INS_LOG_DEBUG(console_, "- IndoorNavigationService::HandleProfile");
 }
 
 void IndoorNavigationService::HandleReady(const Pistache::Rest::Request& request,
                                           Pistache::Http::ResponseWriter response)
 {
-    console_->debug("+ IndoorNavigationService::HandleReady");
+    INS_LOG_DEBUG(console_, "+ IndoorNavigationService::HandleReady");
     (void)request;
     response.send(Pistache::Http::Code::Ok, "1");
-    console_->debug("- IndoorNavigationService::HandleReady");
+    INS_LOG_DEBUG(console_, "- IndoorNavigationService::HandleReady");
 }
 
 void IndoorNavigationService::Auth(const Pistache::Rest::Request& request, Pistache::Http::ResponseWriter response)
 {
-    console_->debug("+ IndoorNavigationService::Auth");
+    INS_LOG_DEBUG(console_, "+ IndoorNavigationService::Auth");
     // TODO
     PrintCookies(request);
     response.cookies().add(Pistache::Http::Cookie("lang", "en-US"));
     response.send(Pistache::Http::Code::Ok);
-    console_->debug("- IndoorNavigationService::Auth");
+    INS_LOG_DEBUG(console_, "- IndoorNavigationService::Auth");
 }
 
 void IndoorNavigationService::PrintCookies(const Pistache::Rest::Request& request)
 {
-    console_->debug("- IndoorNavigationService::PrintCookies");
+    INS_LOG_DEBUG(console_, "- IndoorNavigationService::PrintCookies");
     auto cookies = request.cookies();
     std::cout << "Cookies: [" << std::endl;
     const std::string indent(4, ' ');
@@ -254,7 +833,36 @@ void IndoorNavigationService::PrintCookies(const Pistache::Rest::Request& reques
         std::cout << indent << c.name << " = " << c.value << std::endl;
     }
     std::cout << "]" << std::endl;
-    console_->debug("- IndoorNavigationService::PrintCookies");
+    INS_LOG_DEBUG(console_, "- IndoorNavigationService::PrintCookies");
+}
+
+void IndoorNavigationService::RunSnapshots()
+{
+    INS_LOG_DEBUG(console_, "+ IndoorNavigationService::RunSnapshots");
+
+    std::unique_lock<std::mutex> lock(snapshot_lock_);
+    while (!snapshot_cv_.wait_for(
+        lock, std::chrono::seconds(options_.snapshot_interval_s), [this] { return snapshot_stop_; }))
+    {
+        lock.unlock();
+        engine_snapshot_->Save(options_.snapshot_file, engine_lock_, *device_registry_);
+        lock.lock();
+    }
+
+    INS_LOG_DEBUG(console_, "- IndoorNavigationService::RunSnapshots");
+}
+
+void IndoorNavigationService::StopSnapshots()
+{
+    if (!snapshot_thread_.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(snapshot_lock_);
+        snapshot_stop_ = true;
+    }
+    snapshot_cv_.notify_all();
+    snapshot_thread_.join();
 }
 
 } // namespace ins_service
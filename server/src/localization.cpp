@@ -7,25 +7,30 @@
  * Last edited: - 18th July 2018
  ************************************************************************************************************************/
 
+#include <algorithm>
+
 #include "localization.hpp"
 #include "data_store.hpp"
+#include "metrics.hpp"
+#include "tracer.hpp"
 
 extern insNode_t * insNoderoot;
 
 namespace ins_service {
 
 wifiParams_t * Localization::FillNodeDataPoints(wifiParams_t * wifiNodeBlock,
-		AccessPointRssiListPair mac_rssi_) {
+		const RssiSeries& mac_rssi_) {
 	initKalmanParams(wifiNodeBlock);
 
-	wifiNodeBlock->macAddress =
-			const_cast<char *>(mac_rssi_.first.mac_addr.c_str());
+	//points into the request arena; GetCartesianPosition() ends with destroyInsNode(), which clears it
+	//before ProcessRSSIDataSet rewinds the arena.
+	wifiNodeBlock->macAddress = const_cast<char *>(mac_rssi_.mac_addr.c_str());
 
-	wifiNodeBlock->noSampleData = mac_rssi_.second.size();
+	wifiNodeBlock->noSampleData = mac_rssi_.rssi.size();
 
-	for (int i = 0; i < mac_rssi_.second.size(); ++i) {     //copy rssi values into nodelist
+	for (int i = 0; i < mac_rssi_.rssi.size(); ++i) {     //copy rssi values into nodelist
 		wifiNodeBlock->rssisampledata[(i % NUMBER_SAMPLES)] =
-				(float) mac_rssi_.second[i];
+				(float) mac_rssi_.rssi[i];
 	}
 
 	loadLCFGParams(wifiNodeBlock);  //get the lcfg params into the nodelist.
@@ -34,26 +39,25 @@ wifiParams_t * Localization::FillNodeDataPoints(wifiParams_t * wifiNodeBlock,
 }
 
 insNode_t * Localization::FillNodesDataPoints(const char * device_id,
-		std::vector<AccessPointRssiListPair> mac_rssi_list) {
+		const ArenaVector<RssiSeries>& mac_rssi_list) {
+	TraceSpan span("Localization::FillNodesDataPoints");
 	insNode_t * insNode;
 
 	if ((insNode = findWifiNode(insNoderoot, device_id)) == NULL) {
 		insNode = createInsNodeListDevice(device_id); // check to make sure nodeblock exits!!
 	}
 
-	std::string msg = "Number of distinct mac addresses received from device: "
-			+ std::string(device_id) + " is: "
-			+ std::to_string(mac_rssi_list.size()) + " with: "
-			+ std::to_string(mac_rssi_list[0].second.size()) + " data points.";
-	console_->debug(msg);
+	INS_LOG_DEBUG(console_, "Number of distinct mac addresses received from device: {0} is: {1} with: {2} data points.",
+			device_id, mac_rssi_list.size(), mac_rssi_list[0].rssi.size());
 
-	for (int i = 0; i < mac_rssi_list.size(); ++i) {
+	size_t count = std::min<size_t>(mac_rssi_list.size(), MAXIMUM_NUMBER_NODES);  //the node only has room for this many.
+	for (size_t i = 0; i < count; ++i) {
 		FillNodeDataPoints(&insNode->wifiAccessPointNode[i], mac_rssi_list[i]); //Load lcfg values into memory
 	}
 	return insNode;
 }
 
-Position Localization::ProcessRSSIDataSet(const std::string& device_id) {
+Position Localization::ProcessRSSIDataSet(const std::string& device_id, std::shared_timed_mutex& engine_lock) {
 	float * posit;
 	const char * buff = device_id.c_str();
 	Position pos;
@@ -65,15 +69,19 @@ Position Localization::ProcessRSSIDataSet(const std::string& device_id) {
 #else
 	data_store_->Init("../ins.db");
 #endif // ENABLE_TESTS
-	console_->debug("+ Localization::ProcessRSSIDataSet");
-
-	std::vector<AccessPoint> distn = data_store_->GetDistinctAccessPoints(  //get all distinct access points and their rssi values.
-			device_id);
-
-	if (distn.size() >= TRILATERAT_NUMBER_NODES) {
-		std::vector<AccessPointRssiListPair> mac_rssi_list =
-				data_store_->GetRSSISeriesData(device_id, distn);
-
+	INS_LOG_DEBUG(console_, "+ Localization::ProcessRSSIDataSet");
+	TraceSpan span("Localization::ProcessRSSIDataSet");  //the data store and engine stages nest in it.
+
+	// Series, MAC addresses and query text are request scratch, the thread arena drops them on return.
+	ArenaScope scope;
+	ArenaVector<RssiSeries> mac_rssi_list(scope.Allocator<RssiSeries>());
+	mac_rssi_list.reserve(MAXIMUM_NUMBER_NODES);
+	Metrics::Clock::time_point fetch_start = Metrics::Clock::now();
+	data_store_->CollectRSSISeries(device_id, mac_rssi_list);  //one pass over the device table groups every series.
+	DefaultMetrics().RecordStage(Stage::kDbFetch, Metrics::Clock::now() - fetch_start);  //the engine times the rest.
+
+	if (mac_rssi_list.size() >= TRILATERAT_NUMBER_NODES) {
+		std::shared_lock<std::shared_timed_mutex> lock(engine_lock);
 		posit = GetCartesianPosition(FillNodesDataPoints(buff, mac_rssi_list));
 
 		pos = {posit[0],posit[1],posit[2]};
@@ -87,7 +95,7 @@ Position Localization::ProcessRSSIDataSet(const std::string& device_id) {
 
 	data_store_->Close();
 
-	console_->debug("- Localization::ProcessRSSIDataSet");
+	INS_LOG_DEBUG(console_, "- Localization::ProcessRSSIDataSet");
 
 	return pos;
 }
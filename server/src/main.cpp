@@ -2,8 +2,14 @@
 // Created by samueli on 2017-10-02.
 //
 
+#include "data_archive.hpp"
 #include "ins_service.hpp"
+#include <cctype>
+#include <cmath>
 #include <csignal>
+#include <getopt.h>
+#include <limits>
+#include <stdexcept>
 
 volatile sig_atomic_t is_server_running = 1;
 
@@ -12,22 +18,237 @@ void kill_server(int sig)
     is_server_running = 0;
 }
 
+// Offline bulk export/import of the service database: ins_server --export|--import <archive>
+int RunArchiveCommand(const std::string& command, const std::string& filename)
+{
+    auto data_store = std::make_shared<ins_service::DataStore>();
+    data_store->Init("../ins.db");
+
+    ins_service::DataArchive archive(data_store);
+    bool result = (command == "--export") ? archive.Export(filename) : archive.Import(filename);
+
+    data_store->Close();
+    return result ? 0 : 1;
+}
+
+// Parses a whole decimal number that fits T; false, leaving value alone, for anything else.
+template <typename T>
+bool ParseCount(const char* text, T& value)
+{
+    if (!std::isdigit(static_cast<unsigned char>(text[0])))
+        return false;
+    try
+    {
+        size_t             used;
+        unsigned long long parsed = std::stoull(text, &used);
+        if (text[used] != '\0' || parsed > static_cast<unsigned long long>(std::numeric_limits<T>::max()))
+            return false;
+        value = static_cast<T>(parsed);
+        return true;
+    }
+    catch (const std::logic_error&)
+    {
+        return false;
+    }
+}
+
+// Parses a finite, non-negative decimal number; false, leaving value alone, for anything else.
+bool ParseRate(const char* text, double& value)
+{
+    try
+    {
+        size_t used;
+        double parsed = std::stod(text, &used);
+        if (text[used] != '\0' || !std::isfinite(parsed) || parsed < 0)
+            return false;
+        value = parsed;
+        return true;
+    }
+    catch (const std::logic_error&)
+    {
+        return false;
+    }
+}
+
+void PrintUsage(const char* program)
+{
+    std::cerr << "usage: " << program << " [--snapshot-file <file>] [--snapshot-interval <seconds>]"
+              << " [--spill-file <file>] [--device-memory-mb <mb>] [--prefault-devices <count>]"
+              << " [--ingest-queue <uploads>] [--device-shards <count>] [--device-queue <operations>]"
+              << " [--read-threads <count>] [--read-queue <requests>] [--max-reads <requests>]"
+              << " [--max-device-ops <requests>] [--max-uploads <requests>] [--upload-rate <per second>]"
+              << " [--upload-burst <uploads>] [--trace-sample <requests>] [--log-queue <messages>]"
+              << " [--profiler] [port [threads]]" << std::endl
+              << "       " << program << " --export|--import <archive>" << std::endl;
+}
+
 int main(int argc, char* argv[])
 {
-    spdlog::set_level(spdlog::level::debug);
+    enum
+    {
+        OPT_EXPORT = 256,
+        OPT_IMPORT,
+        OPT_SNAPSHOT_FILE,
+        OPT_SNAPSHOT_INTERVAL,
+        OPT_SPILL_FILE,
+        OPT_DEVICE_MEMORY,
+        OPT_PREFAULT_DEVICES,
+        OPT_INGEST_QUEUE,
+        OPT_DEVICE_SHARDS,
+        OPT_DEVICE_QUEUE,
+        OPT_READ_THREADS,
+        OPT_READ_QUEUE,
+        OPT_MAX_READS,
+        OPT_MAX_DEVICE_OPS,
+        OPT_MAX_UPLOADS,
+        OPT_UPLOAD_RATE,
+        OPT_UPLOAD_BURST,
+        OPT_TRACE_SAMPLE,
+        OPT_LOG_QUEUE,
+        OPT_PROFILER
+    };
+
+    static const struct option long_options[]
+        = { { "export", required_argument, nullptr, OPT_EXPORT },
+            { "import", required_argument, nullptr, OPT_IMPORT },
+            { "snapshot-file", required_argument, nullptr, OPT_SNAPSHOT_FILE },
+            { "snapshot-interval", required_argument, nullptr, OPT_SNAPSHOT_INTERVAL },
+            { "spill-file", required_argument, nullptr, OPT_SPILL_FILE },
+            { "device-memory-mb", required_argument, nullptr, OPT_DEVICE_MEMORY },
+            { "prefault-devices", required_argument, nullptr, OPT_PREFAULT_DEVICES },
+            { "ingest-queue", required_argument, nullptr, OPT_INGEST_QUEUE },
+            { "device-shards", required_argument, nullptr, OPT_DEVICE_SHARDS },
+            { "device-queue", required_argument, nullptr, OPT_DEVICE_QUEUE },
+            { "read-threads", required_argument, nullptr, OPT_READ_THREADS },
+            { "read-queue", required_argument, nullptr, OPT_READ_QUEUE },
+            { "max-reads", required_argument, nullptr, OPT_MAX_READS },
+            { "max-device-ops", required_argument, nullptr, OPT_MAX_DEVICE_OPS },
+            { "max-uploads", required_argument, nullptr, OPT_MAX_UPLOADS },
+            { "upload-rate", required_argument, nullptr, OPT_UPLOAD_RATE },
+            { "upload-burst", required_argument, nullptr, OPT_UPLOAD_BURST },
+            { "trace-sample", required_argument, nullptr, OPT_TRACE_SAMPLE },
+            { "log-queue", required_argument, nullptr, OPT_LOG_QUEUE },
+            { "profiler", no_argument, nullptr, OPT_PROFILER },
+            { nullptr, 0, nullptr, 0 } };
+
+    ins_service::ServiceOptions options;
+    std::string                 archive_command;
+    std::string                 archive_file;
+    uint32_t                    log_queue = 0;
+
+    int  opt;
+    int  index = 0;
+    bool valid = true;
+    while (valid && (opt = getopt_long(argc, argv, "", long_options, &index)) != -1)
+    {
+        switch (opt)
+        {
+            case OPT_EXPORT:
+                archive_command = "--export";
+                archive_file    = optarg;
+                break;
+            case OPT_IMPORT:
+                archive_command = "--import";
+                archive_file    = optarg;
+                break;
+            case OPT_SNAPSHOT_FILE:
+                options.snapshot_file = optarg;
+                break;
+            case OPT_SNAPSHOT_INTERVAL:
+                valid = ParseCount(optarg, options.snapshot_interval_s);
+                break;
+            case OPT_SPILL_FILE:
+                options.spill_file = optarg;
+                break;
+            case OPT_DEVICE_MEMORY:
+                valid = ParseCount(optarg, options.device_memory_budget_mb);
+                break;
+            case OPT_PREFAULT_DEVICES:
+                valid = ParseCount(optarg, options.prefault_devices);
+                break;
+            case OPT_INGEST_QUEUE:
+                valid = ParseCount(optarg, options.ingest_queue_capacity);
+                break;
+            case OPT_DEVICE_SHARDS:
+                valid = ParseCount(optarg, options.device_shards);
+                break;
+            case OPT_DEVICE_QUEUE:
+                valid = ParseCount(optarg, options.device_queue_limit);
+                break;
+            case OPT_READ_THREADS:
+                valid = ParseCount(optarg, options.read_threads);
+                break;
+            case OPT_READ_QUEUE:
+                valid = ParseCount(optarg, options.read_queue_limit);
+                break;
+            case OPT_MAX_READS:
+                valid = ParseCount(optarg, options.max_inflight_reads);
+                break;
+            case OPT_MAX_DEVICE_OPS:
+                valid = ParseCount(optarg, options.max_inflight_device_ops);
+                break;
+            case OPT_MAX_UPLOADS:
+                valid = ParseCount(optarg, options.max_inflight_uploads);
+                break;
+            case OPT_UPLOAD_RATE:
+                valid = ParseRate(optarg, options.upload_rate);
+                break;
+            case OPT_UPLOAD_BURST:
+                valid = ParseRate(optarg, options.upload_burst);
+                break;
+            case OPT_TRACE_SAMPLE:
+                valid = ParseCount(optarg, options.trace_sample_every);
+                break;
+            case OPT_LOG_QUEUE:
+                valid = ParseCount(optarg, log_queue);
+                break;
+            case OPT_PROFILER:
+                options.enable_profiler = true;
+                break;
+            default:
+                valid = false;
+                break;
+        }
+        if (!valid && opt != '?')
+            std::cerr << argv[0] << ": invalid value '" << optarg << "' for --" << long_options[index].name << std::endl;
+    }
 
-    Pistache::Port port(9080);
-    int            thread_count = 2;
+    uint16_t port         = 9080;
+    int      thread_count = 2;
 
-    if (argc >= 2)
+    if (valid && optind < argc)
     {
-        port = static_cast<uint16_t>(std::stol(argv[1]));
+        valid = ParseCount(argv[optind], port) && port > 0;
 
-        if (argc == 3)
-            thread_count = static_cast<int>(std::stol(argv[2]));
+        if (valid && optind + 1 < argc)
+            valid = ParseCount(argv[optind + 1], thread_count) && thread_count > 0;
+    }
+    if (!valid)
+    {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    if (!archive_command.empty())
+    {
+        spdlog::set_level(spdlog::level::info);
+        return RunArchiveCommand(archive_command, archive_file);
     }
 
-    Pistache::Address addr(Pistache::Ipv4::any(), port);
+    // Loggers created from here on hand their messages to a writer thread through a bounded queue instead
+    // of formatting and writing them on the request threads; a full queue blocks until it has room.
+    if (log_queue > 0)
+    {
+        // spdlog only takes queues of a power of two, at least 2, messages; round up to the next one.
+        size_t size = 2;
+        while (size < log_queue)
+            size <<= 1;
+        spdlog::set_async_mode(
+            size, spdlog::async_overflow_policy::block_retry, nullptr, std::chrono::seconds(1));
+    }
+    spdlog::set_level(static_cast<spdlog::level::level_enum>(INS_LOG_LEVEL));
+
+    Pistache::Address addr(Pistache::Ipv4::any(), Pistache::Port(port));
     auto              console = spdlog::stdout_logger_mt("main_console");
 
     console->info("Indoor Navigation System service setting up on {1}:{0:d}", addr.port(), addr.host());
@@ -35,7 +256,7 @@ int main(int argc, char* argv[])
     console->info("Using {0} threads", thread_count);
 
     ins_service::IndoorNavigationService ins;
-    ins.Init(addr, thread_count);
+    ins.Init(addr, thread_count, options);
 
     // Register abort & terminate signals respectively
     std::signal(SIGINT, kill_server);
@@ -47,6 +268,6 @@ int main(int argc, char* argv[])
     while (is_server_running)
         sleep(1);
 
-    // shutdown server
+    // shutdown server (saves the engine snapshot)
     ins.Shutdown();
-}
\ No newline at end of file
+}
@@ -0,0 +1,201 @@
+#include "metrics.hpp"
+
+namespace ins_service
+{
+
+const size_t   Metrics::kBuckets;
+const uint32_t Metrics::kBucketBoundsUs[Metrics::kBuckets]
+    = { 50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000, 2500000, 5000000 };
+
+namespace
+{
+const char* const kRouteNames[static_cast<size_t>(Route::kCount)]
+    = { "set_rssi", "resolve_pos", "reset_pos", "get_device_pos", "get_employee_pos", "employees_search" };
+
+const char* const kStageNames[static_cast<size_t>(Stage::kCount)] = { "db_fetch", "filter", "solve" };
+
+const char* const kStatusClasses[3] = { "2xx", "4xx", "5xx" };
+
+std::atomic<uint64_t> g_next_metrics_id(1);
+
+// Shard of the Metrics instance this thread recorded into last; instances are told apart by id as a
+// new instance may reuse the address of a destroyed one.
+struct ShardCache
+{
+    uint64_t owner;
+    void*    shard;
+};
+
+thread_local ShardCache t_shard_cache = { 0, nullptr };
+
+size_t Index(Route route)
+{
+    return static_cast<size_t>(route);
+}
+
+std::string Label(const char* name, const char* value)
+{
+    return std::string(name) + "=\"" + value + "\"";
+}
+} // namespace
+
+Metrics::Metrics()
+    : id_(g_next_metrics_id++)
+{
+}
+
+void Metrics::StartRequest(Route route)
+{
+    LocalShard().started[Index(route)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void Metrics::EndRequest(Route route, int status, Clock::duration elapsed)
+{
+    Shard& shard = LocalShard();
+    shard.ended[Index(route)].fetch_add(1, std::memory_order_relaxed);
+    if (status == 0)
+        return;
+
+    size_t status_class = status < 400 ? 0 : status < 500 ? 1 : 2;
+    shard.responses[Index(route)][status_class].fetch_add(1, std::memory_order_relaxed);
+    Add(shard.requests[Index(route)], elapsed);
+}
+
+void Metrics::RecordStage(Stage stage, Clock::duration elapsed)
+{
+    Add(LocalShard().stages[static_cast<size_t>(stage)], elapsed);
+}
+
+void Metrics::Render(std::string& out) const
+{
+    const size_t routes = static_cast<size_t>(Route::kCount);
+    const size_t stages = static_cast<size_t>(Stage::kCount);
+
+    uint64_t        in_flight[routes]    = {};
+    uint64_t        responses[routes][3] = {};
+    HistogramTotals requests[routes]     = {};
+    HistogramTotals stage_totals[stages] = {};
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        for (auto const& entry : shards_)
+        {
+            const Shard& shard = *entry.second;
+            for (size_t r = 0; r < routes; ++r)
+            {
+                // Start and end of a request may be recorded by different threads, only the sum is exact.
+                in_flight[r] += shard.started[r].load(std::memory_order_relaxed);
+                in_flight[r] -= shard.ended[r].load(std::memory_order_relaxed);
+                for (size_t c = 0; c < 3; ++c)
+                    responses[r][c] += shard.responses[r][c].load(std::memory_order_relaxed);
+                Merge(shard.requests[r], requests[r]);
+            }
+            for (size_t s = 0; s < stages; ++s)
+                Merge(shard.stages[s], stage_totals[s]);
+        }
+    }
+
+    out += "# HELP ins_requests_total Requests answered, by route and status class.\n";
+    out += "# TYPE ins_requests_total counter\n";
+    for (size_t r = 0; r < routes; ++r)
+    {
+        for (size_t c = 0; c < 3; ++c)
+        {
+            out += "ins_requests_total{" + Label("route", kRouteNames[r]) + "," + Label("code", kStatusClasses[c])
+                   + "} " + std::to_string(responses[r][c]) + "\n";
+        }
+    }
+
+    out += "# HELP ins_requests_in_flight Requests accepted and not answered yet, by route.\n";
+    out += "# TYPE ins_requests_in_flight gauge\n";
+    for (size_t r = 0; r < routes; ++r)
+    {
+        // Reading the shards one by one can see an end before its start.
+        int64_t value = static_cast<int64_t>(in_flight[r]);
+        out += "ins_requests_in_flight{" + Label("route", kRouteNames[r]) + "} "
+               + std::to_string(value < 0 ? 0 : value) + "\n";
+    }
+
+    out += "# HELP ins_request_duration_seconds Time from accepting a request to answering it, by route.\n";
+    out += "# TYPE ins_request_duration_seconds histogram\n";
+    for (size_t r = 0; r < routes; ++r)
+        RenderHistogram(out, "ins_request_duration_seconds", Label("route", kRouteNames[r]), requests[r]);
+
+    out += "# HELP ins_stage_duration_seconds Time spent in each stage of a position resolution.\n";
+    out += "# TYPE ins_stage_duration_seconds histogram\n";
+    for (size_t s = 0; s < stages; ++s)
+        RenderHistogram(out, "ins_stage_duration_seconds", Label("stage", kStageNames[s]), stage_totals[s]);
+}
+
+void Metrics::RenderHeader(std::string& out, const char* name, const char* type, const char* help)
+{
+    out += std::string("# HELP ") + name + " " + help + "\n";
+    out += std::string("# TYPE ") + name + " " + type + "\n";
+}
+
+void Metrics::RenderValue(std::string& out, const char* name, const std::string& labels, uint64_t value)
+{
+    out += name;
+    if (!labels.empty())
+        out += "{" + labels + "}";
+    out += " " + std::to_string(value) + "\n";
+}
+
+Metrics::Shard& Metrics::LocalShard()
+{
+    ShardCache& cache = t_shard_cache;
+    if (cache.owner != id_)
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        std::unique_ptr<Shard>&     shard = shards_[std::this_thread::get_id()];
+        if (shard == nullptr)
+            shard.reset(new Shard());
+        cache.owner = id_;
+        cache.shard = shard.get();
+    }
+    return *static_cast<Shard*>(cache.shard);
+}
+
+void Metrics::Add(Histogram& histogram, Clock::duration elapsed)
+{
+    int64_t elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    if (elapsed_ns < 0)
+        elapsed_ns = 0;
+
+    size_t bucket = 0;
+    while (bucket < kBuckets && static_cast<uint64_t>(elapsed_ns) > kBucketBoundsUs[bucket] * 1000ULL)
+        ++bucket;
+    histogram.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    histogram.sum_ns.fetch_add(static_cast<uint64_t>(elapsed_ns), std::memory_order_relaxed);
+}
+
+void Metrics::Merge(const Histogram& histogram, HistogramTotals& totals)
+{
+    for (size_t b = 0; b <= kBuckets; ++b)
+        totals.buckets[b] += histogram.buckets[b].load(std::memory_order_relaxed);
+    totals.sum_ns += histogram.sum_ns.load(std::memory_order_relaxed);
+}
+
+void Metrics::RenderHistogram(std::string&           out,
+                              const char*            name,
+                              const std::string&     labels,
+                              const HistogramTotals& totals)
+{
+    // Buckets are recorded individually and rendered cumulatively, as the format expects.
+    uint64_t count = 0;
+    for (size_t b = 0; b <= kBuckets; ++b)
+    {
+        count += totals.buckets[b];
+        std::string bound = b < kBuckets ? std::to_string(kBucketBoundsUs[b] / 1e6) : std::string("+Inf");
+        out += std::string(name) + "_bucket{" + labels + ",le=\"" + bound + "\"} " + std::to_string(count) + "\n";
+    }
+    out += std::string(name) + "_sum{" + labels + "} " + std::to_string(totals.sum_ns / 1e9) + "\n";
+    out += std::string(name) + "_count{" + labels + "} " + std::to_string(count) + "\n";
+}
+
+Metrics& DefaultMetrics()
+{
+    static Metrics metrics;
+    return metrics;
+}
+
+} // namespace ins_service
@@ -0,0 +1,117 @@
+#include "position_index.hpp"
+
+namespace ins_service
+{
+
+const uint32_t PositionIndex::kDefaultPublishIntervalMs;
+
+bool PositionSnapshot::FindDevice(const DeviceId& device_id, Position& pos) const
+{
+    auto device = devices.find(device_id);
+    if (device == devices.end())
+        return false;
+    pos = device->second.pos;
+    return true;
+}
+
+bool PositionSnapshot::FindEmployee(const std::string& employee_id, Position& pos) const
+{
+    auto employee = employees.find(employee_id);
+    return employee != employees.end() && FindDevice(employee->second, pos);
+}
+
+bool PositionIndex::Load(DataStore& data_store)
+{
+    INS_LOG_DEBUG(console_, "+ PositionIndex::Load");
+
+    std::unique_ptr<PositionSnapshot> loaded(new PositionSnapshot());
+    bool res = data_store.VisitLocations([&loaded](const StoredLocation& location) {
+        loaded->devices[location.device_id] = PositionSnapshot::Location{ location.employee_id, location.pos };
+        if (!location.employee_id.empty())
+            loaded->employees[location.employee_id] = location.device_id;
+    });
+    if (!res)
+    {
+        console_->error("Unable to load device locations, positions are served as they are resolved");
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(writer_lock_);
+    loaded->version = Read()->version + 1;
+    console_->info(
+        "Indexed positions of {0} devices and {1} employees", loaded->devices.size(), loaded->employees.size());
+    snapshot_.Publish(std::move(loaded));
+
+    INS_LOG_DEBUG(console_, "- PositionIndex::Load");
+    return true;
+}
+
+void PositionIndex::Start(uint32_t publish_interval_ms)
+{
+    if (publisher_.joinable())
+        return;
+
+    stop_      = false;
+    publisher_ = std::thread(&PositionIndex::Run, this, publish_interval_ms);
+}
+
+void PositionIndex::Stop()
+{
+    if (publisher_.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(publisher_lock_);
+            stop_ = true;
+        }
+        publisher_cv_.notify_all();
+        publisher_.join();
+    }
+    Publish();
+}
+
+void PositionIndex::UpdateDevicePosition(const DeviceId& device_id, const Position& pos)
+{
+    std::lock_guard<std::mutex> lock(pending_lock_);
+    pending_[device_id] = pos;
+}
+
+void PositionIndex::Publish()
+{
+    std::lock_guard<std::mutex>            lock(writer_lock_);
+    std::unordered_map<DeviceId, Position> updates;
+    {
+        std::lock_guard<std::mutex> pending(pending_lock_);
+        if (pending_.empty())
+            return;
+        updates.swap(pending_);
+    }
+
+    // Copy the current version; employees keep their device, as UpdateDeviceLocation() does.
+    std::unique_ptr<PositionSnapshot> next;
+    {
+        ReadGuard current = Read();
+        next.reset(new PositionSnapshot(*current));
+    }
+    ++next->version;
+    for (auto const& update : updates)
+        next->devices[update.first].pos = update.second;
+
+    snapshot_.Publish(std::move(next));
+}
+
+void PositionIndex::Run(uint32_t publish_interval_ms)
+{
+    INS_LOG_DEBUG(console_, "+ PositionIndex::Run");
+
+    std::unique_lock<std::mutex> lock(publisher_lock_);
+    while (!publisher_cv_.wait_for(lock, std::chrono::milliseconds(publish_interval_ms), [this] { return stop_; }))
+    {
+        lock.unlock();
+        Publish();
+        lock.lock();
+    }
+
+    INS_LOG_DEBUG(console_, "- PositionIndex::Run");
+}
+
+} // namespace ins_service
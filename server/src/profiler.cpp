@@ -0,0 +1,229 @@
+#include <algorithm>
+#include <cerrno>
+#include <cinttypes>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <map>
+#include <sys/time.h>
+#include <unordered_map>
+
+#include "profiler.hpp"
+
+namespace ins_service
+{
+
+const uint32_t Profiler::kFrequencyHz;
+const uint32_t Profiler::kMaxSeconds;
+const size_t   Profiler::kMaxFrames;
+const size_t   Profiler::kMaxSamples;
+
+namespace
+{
+// Innermost frames of every sample: the signal handler and the kernel's signal trampoline.
+const int kSignalFrames = 2;
+
+// Profiler holding the process wide profile, and the one its signal handler records into while armed.
+std::atomic<Profiler*> g_owner(nullptr);
+std::atomic<Profiler*> g_sampling(nullptr);
+std::atomic<int>       g_handlers_running(0);
+
+std::string Symbolize(void* address)
+{
+    char    name[64];
+    Dl_info info;
+    bool    found = dladdr(address, &info) != 0;
+    if (found && info.dli_sname != nullptr)
+    {
+        int         status    = 0;
+        char*       demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+        std::string symbol    = (status == 0 && demangled != nullptr) ? demangled : info.dli_sname;
+        free(demangled);
+        return symbol;
+    }
+    if (found && info.dli_fname != nullptr)
+    {
+        // Functions of the executable only have names when it exports its symbols (-rdynamic).
+        const char* module = strrchr(info.dli_fname, '/');
+        snprintf(name,
+                 sizeof(name),
+                 "%s+0x%" PRIxPTR,
+                 module != nullptr ? module + 1 : info.dli_fname,
+                 reinterpret_cast<uintptr_t>(address) - reinterpret_cast<uintptr_t>(info.dli_fbase));
+        return name;
+    }
+    snprintf(name, sizeof(name), "0x%" PRIxPTR, reinterpret_cast<uintptr_t>(address));
+    return name;
+}
+} // namespace
+
+Profiler::Profiler()
+    : capacity_(0)
+    , next_(0)
+    , stop_(false)
+    , console_(spdlog::get(LOGGER_NAME))
+{
+    if (console_ == nullptr)
+        console_ = spdlog::stdout_logger_mt(LOGGER_NAME);
+}
+
+Profiler::~Profiler()
+{
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        stop_ = true;
+    }
+    stop_cv_.notify_all();
+    if (thread_.joinable())
+        thread_.join();
+}
+
+bool Profiler::Start(std::chrono::seconds duration, DoneCallback done)
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    Profiler*                   expected = nullptr;
+    if (stop_ || !g_owner.compare_exchange_strong(expected, this))
+        return false;
+
+    // A previous profile of this instance has already released the process, only its thread is left.
+    if (thread_.joinable())
+        thread_.join();
+
+    duration = std::max(std::chrono::seconds(1), std::min(duration, std::chrono::seconds(kMaxSeconds)));
+    thread_  = std::thread(&Profiler::Run, this, duration, std::move(done));
+    return true;
+}
+
+void Profiler::Run(std::chrono::seconds duration, DoneCallback done)
+{
+    INS_LOG_DEBUG(console_, "+ Profiler::Run");
+
+    // Every CPU can take kFrequencyHz samples per second.
+    size_t cpus = std::max(1u, std::thread::hardware_concurrency());
+    capacity_   = std::min<size_t>(kMaxSamples, duration.count() * kFrequencyHz * cpus);
+    samples_.reset(new Sample[capacity_]);
+    next_.store(0);
+
+    std::string stacks;
+    if (Arm())
+    {
+        {
+            std::unique_lock<std::mutex> lock(lock_);
+            stop_cv_.wait_for(lock, duration, [this] { return stop_; });
+        }
+        Disarm();
+
+        size_t taken = next_.load();
+        size_t count = std::min(taken, capacity_);
+        if (taken > count)
+            console_->warn("Profile dropped {0} of {1} samples, the buffer holds {2}", taken - count, taken, count);
+        Collapse(count, stacks);
+        console_->info("Profiled {0} samples", count);
+    }
+    samples_.reset();
+
+    done(stacks);
+    g_owner.store(nullptr);
+
+    INS_LOG_DEBUG(console_, "- Profiler::Run");
+}
+
+bool Profiler::Arm()
+{
+    // The first backtrace() loads the unwinder, which must not happen inside the signal handler.
+    void* warm_up[1];
+    (void)backtrace(warm_up, 1);
+
+    g_sampling.store(this);
+
+    // The handler stays installed after the profile: a tick still pending when the timer stops must not
+    // reach the default action of SIGPROF, which terminates the process.
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = &Profiler::OnSignal;
+    action.sa_flags   = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(SIGPROF, &action, nullptr) != 0)
+    {
+        console_->error("Profiler could not install its SIGPROF handler: {0}", strerror(errno));
+        g_sampling.store(nullptr);
+        return false;
+    }
+
+    struct itimerval timer;
+    timer.it_interval.tv_sec  = 0;
+    timer.it_interval.tv_usec = 1000000 / kFrequencyHz;
+    timer.it_value            = timer.it_interval;
+    if (setitimer(ITIMER_PROF, &timer, nullptr) != 0)
+    {
+        console_->error("Profiler could not start its timer: {0}", strerror(errno));
+        g_sampling.store(nullptr);
+        return false;
+    }
+    return true;
+}
+
+void Profiler::Disarm()
+{
+    struct itimerval timer;
+    memset(&timer, 0, sizeof(timer));
+    (void)setitimer(ITIMER_PROF, &timer, nullptr);
+
+    // Handlers count themselves in before looking for a profiler, so once none is running no handler can
+    // still be writing a sample.
+    g_sampling.store(nullptr);
+    while (g_handlers_running.load() != 0)
+        std::this_thread::yield();
+}
+
+void Profiler::Collapse(size_t count, std::string& out) const
+{
+    std::map<std::string, uint64_t>        stacks;
+    std::unordered_map<void*, std::string> names;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const Sample& sample = samples_[i];
+        std::string   stack;
+        for (int frame = sample.depth - 1; frame >= kSignalFrames; --frame)
+        {
+            auto name = names.find(sample.frames[frame]);
+            if (name == names.end())
+                name = names.emplace(sample.frames[frame], Symbolize(sample.frames[frame])).first;
+            if (!stack.empty())
+                stack += ';';
+            stack += name->second;
+        }
+        if (!stack.empty())
+            ++stacks[stack];
+    }
+
+    for (auto const& stack : stacks)
+        out += stack.first + " " + std::to_string(stack.second) + "\n";
+}
+
+void Profiler::OnSignal(int signal)
+{
+    (void)signal;
+    int saved_errno = errno;
+
+    g_handlers_running.fetch_add(1);
+    Profiler* profiler = g_sampling.load();
+    if (profiler != nullptr)
+    {
+        size_t slot = profiler->next_.fetch_add(1, std::memory_order_relaxed);
+        if (slot < profiler->capacity_)
+        {
+            Sample& sample = profiler->samples_[slot];
+            sample.depth   = backtrace(sample.frames, static_cast<int>(kMaxFrames));
+        }
+    }
+    g_handlers_running.fetch_sub(1);
+
+    errno = saved_errno;
+}
+
+} // namespace ins_service
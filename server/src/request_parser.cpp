@@ -0,0 +1,132 @@
+#include "request_parser.hpp"
+
+namespace ins_service
+{
+
+namespace
+{
+bool IsHexDigit(char c)
+{
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+bool IsIdentifierChar(char c)
+{
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+} // namespace
+
+bool PathSegments::Next(StringView& segment)
+{
+    while (pos_ != end_ && *pos_ == '/')
+        ++pos_;
+    if (pos_ == end_)
+        return false;
+
+    const char* begin = pos_;
+    while (pos_ != end_ && *pos_ != '/')
+        ++pos_;
+    segment = StringView(begin, static_cast<size_t>(pos_ - begin));
+    return true;
+}
+
+bool ParseInt32(const StringView& text, int32_t& value)
+{
+    size_t i        = 0;
+    bool   negative = false;
+    if (i < text.size() && (text[i] == '-' || text[i] == '+'))
+        negative = text[i++] == '-';
+    if (i == text.size())
+        return false;
+
+    int64_t magnitude = 0;
+    for (; i < text.size(); ++i)
+    {
+        if (text[i] < '0' || text[i] > '9')
+            return false;
+        magnitude = magnitude * 10 + (text[i] - '0');
+        if (magnitude > 2147483648LL)
+            return false;
+    }
+    if (!negative && magnitude > 2147483647LL)
+        return false;
+
+    value = static_cast<int32_t>(negative ? -magnitude : magnitude);
+    return true;
+}
+
+bool ParseRssi(const StringView& text, int32_t& rssi)
+{
+    size_t integer_length = 0;
+    while (integer_length < text.size() && text[integer_length] != '.')
+        ++integer_length;
+
+    for (size_t i = integer_length + 1; i < text.size(); ++i)
+    {
+        if (text[i] < '0' || text[i] > '9')
+            return false;
+    }
+    return ParseInt32(StringView(text.data(), integer_length), rssi);
+}
+
+bool ParseMacAddress(const StringView& text, MacAddress& mac_addr)
+{
+    if (text.size() != MacAddress::kCapacity)
+        return false;
+    for (size_t i = 0; i < text.size(); ++i)
+    {
+        bool separator = i % 3 == 2;
+        if (separator ? text[i] != ':' : !IsHexDigit(text[i]))
+            return false;
+    }
+    mac_addr.Assign(text.data(), text.size());
+    return true;
+}
+
+bool ParseDeviceId(const StringView& text, DeviceId& device_id)
+{
+    if (text.empty() || text.size() > DeviceId::kCapacity)
+        return false;
+    for (size_t i = 0; i < text.size(); ++i)
+    {
+        if (!IsIdentifierChar(text[i]))
+            return false;
+    }
+    device_id.Assign(text.data(), text.size());
+    return true;
+}
+
+bool ParseUploadDeviceId(const StringView& resource, DeviceId& device_id)
+{
+    PathSegments segments(resource);
+    StringView   route;
+    StringView   segment;
+    return segments.Next(route) && segments.Next(segment) && ParseDeviceId(segment, device_id);
+}
+
+bool ParseRssiUpload(const StringView& resource,
+                     DeviceId&         device_id,
+                     RssiReading*      readings,
+                     size_t            capacity,
+                     size_t&           count)
+{
+    PathSegments segments(resource);
+    StringView   route;
+    StringView   segment;
+    count = 0;
+
+    if (!segments.Next(route) || !segments.Next(segment) || !ParseDeviceId(segment, device_id))
+        return false;
+
+    StringView mac_addr;
+    StringView rssi;
+    while (count < capacity && segments.Next(mac_addr) && segments.Next(rssi))
+    {
+        if (!ParseMacAddress(mac_addr, readings[count].mac_addr) || !ParseRssi(rssi, readings[count].rssi))
+            return false;
+        ++count;
+    }
+    return count > 0;
+}
+
+} // namespace ins_service
@@ -0,0 +1,220 @@
+#include <algorithm>
+
+#include "storage_writer.hpp"
+#include "task_pool.hpp"
+
+namespace ins_service
+{
+
+const size_t IngestRecord::kMaxReadings;
+const size_t StorageWriter::kDefaultCapacity;
+const size_t StorageWriter::kMaxBatch;
+
+// Upper bound on how long an idle storage thread sleeps without being woken by a producer.
+static const std::chrono::milliseconds kIdleWait(100);
+
+void StorageWriter::Start()
+{
+    INS_LOG_DEBUG(console_, "+ StorageWriter::Start");
+
+    if (!thread_.joinable())
+    {
+        stop_   = false;
+        thread_ = std::thread(&StorageWriter::Run, this);
+    }
+
+    INS_LOG_DEBUG(console_, "- StorageWriter::Start");
+}
+
+void StorageWriter::Stop()
+{
+    if (thread_.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(lock_);
+            stop_ = true;
+        }
+        wake_cv_.notify_all();
+        thread_.join();
+    }
+
+    while (DrainBatch() > 0)
+    {
+    }
+    RunStoredCallbacks(true);
+}
+
+bool StorageWriter::Submit(const DeviceId& device_id, const RssiReading* readings, size_t count)
+{
+    if (count == 0 || count > IngestRecord::kMaxReadings)
+    {
+        console_->error("Rejecting upload of {0} readings for device {1}", count, device_id);
+        return false;
+    }
+
+    IngestRecord record;
+    record.device_id = device_id;
+    record.count     = static_cast<uint32_t>(count);
+    std::copy(readings, readings + count, record.readings);
+    if (!ring_.TryPush(record))
+    {
+        console_->warn("Ingest queue full ({0} uploads), dropping upload of device {1}", ring_.Capacity(), device_id);
+        return false;
+    }
+
+    // Producers only take the lock when the storage thread went to sleep on an empty queue.
+    if (waiting_.load())
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        wake_cv_.notify_one();
+    }
+    return true;
+}
+
+void StorageWriter::Flush()
+{
+    size_t target = ring_.Pushed();
+    if (!thread_.joinable())
+    {
+        while (DrainBatch() > 0)
+        {
+        }
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(lock_);
+    wake_cv_.notify_one();
+    stored_cv_.wait(lock, [this, target] { return stored_ >= target || stop_; });
+}
+
+void StorageWriter::OnStored(std::function<void()> callback)
+{
+    size_t target = ring_.Pushed();
+    if (thread_.joinable())
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        if (stored_ < target && !stop_)
+        {
+            stored_callbacks_.push_back(StoredCallback{ target, std::move(callback) });
+            wake_cv_.notify_one();
+            return;
+        }
+    }
+    else
+    {
+        while (DrainBatch() > 0)
+        {
+        }
+    }
+    callback();
+}
+
+void StorageWriter::Run()
+{
+    INS_LOG_DEBUG(console_, "+ StorageWriter::Run");
+
+    if (!ApplyThreadPriority(ThreadPriority::kBulk))
+        console_->warn("Unable to lower the priority of the storage thread");
+
+    std::unique_lock<std::mutex> lock(lock_);
+    while (!stop_)
+    {
+        lock.unlock();
+        size_t drained = DrainBatch();
+        lock.lock();
+        if (drained > 0)
+            continue;
+
+        waiting_ = true;
+        wake_cv_.wait_for(lock, kIdleWait, [this] { return stop_ || ring_.Depth() > 0; });
+        waiting_ = false;
+    }
+
+    INS_LOG_DEBUG(console_, "- StorageWriter::Run");
+}
+
+size_t StorageWriter::DrainBatch()
+{
+    size_t drained = 0;
+    {
+        std::lock_guard<std::mutex> drain(drain_lock_);
+
+        IngestRecord record;
+        batch_.clear();
+        while (batch_.size() < kMaxBatch && ring_.TryPop(record))
+            batch_.push_back(record);
+        if (batch_.empty())
+            return 0;
+        drained = batch_.size();
+
+        // One transaction per batch, which holds the database until it commits so that writes of other
+        // threads stay out of it.
+        new_tables_.clear();
+        bool committed = data_store_->RunInTransaction([this]() {
+            for (auto const& upload : batch_)
+                StoreRecord(upload);
+            return true;
+        });
+        if (!committed)
+        {
+            // Tables created by a rolled back batch are gone with it; the uploads are stored one by one instead.
+            console_->warn("Unable to store a batch of {0} uploads in one transaction, storing them one by one",
+                           drained);
+            for (auto const& device_id : new_tables_)
+                known_tables_.erase(device_id);
+            for (auto const& upload : batch_)
+                StoreRecord(upload);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(lock_);
+            stored_ += drained;
+        }
+    }
+    stored_cv_.notify_all();
+    RunStoredCallbacks(false);
+    return drained;
+}
+
+void StorageWriter::RunStoredCallbacks(bool all)
+{
+    std::vector<StoredCallback> ready;
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        size_t                      kept = 0;
+        for (auto& waiting : stored_callbacks_)
+        {
+            if (all || waiting.target <= stored_)
+                ready.push_back(std::move(waiting));
+            else
+                stored_callbacks_[kept++] = std::move(waiting);
+        }
+        stored_callbacks_.resize(kept);
+    }
+
+    // Outside the lock, callbacks are free to submit or flush again.
+    for (auto& waiting : ready)
+        waiting.callback();
+}
+
+void StorageWriter::StoreRecord(const IngestRecord& record)
+{
+    // Numeric device ids fit the small string buffer, so this copy does not allocate.
+    const std::string device_name = record.device_id.str();
+
+    if (known_tables_.count(record.device_id) == 0)
+    {
+        if (!data_store_->CreateDeviceTable(device_name))
+        {
+            console_->error("Unable to create table of device {0}, dropping {1} readings", device_name, record.count);
+            return;
+        }
+        known_tables_.insert(record.device_id);
+        new_tables_.push_back(record.device_id);
+    }
+
+    if (!data_store_->InsertRSSIReadings(device_name, record.readings, record.count))
+        console_->error("Unable to store {0} readings of device {1}", record.count, device_name);
+}
+
+} // namespace ins_service
@@ -0,0 +1,193 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+#include "synthetic_building.hpp"
+
+namespace ins_service
+{
+
+const uint32_t SyntheticBuilding::kMaxFloors;
+const uint32_t SyntheticBuilding::kMaxAccessPointsPerFloor;
+const uint32_t SyntheticBuilding::kConfigBlocksPerFloor;
+const char     SyntheticBuilding::kUnusedMacAddress[] = "ff:ff:ff:ff:ff:ff";
+
+namespace
+{
+// Gaussian deviation, none for a deviation of 0 which std::normal_distribution does not take.
+float Deviation(std::mt19937& random, float deviation)
+{
+    if (deviation <= 0.0f)
+        return 0.0f;
+    std::normal_distribution<float> distribution(0.0f, deviation);
+    return distribution(random);
+}
+
+void AppendBlock(std::string& out, uint32_t block, const SyntheticAccessPoint* access_point)
+{
+    char text[512];
+    snprintf(text,
+             sizeof(text),
+             "\t\t<wifiNodeBlock%u>\n"
+             "\t\t\t<_3DPosition>\n"
+             "\t\t\t\t<x>%.3f</x>\n"
+             "\t\t\t\t<y>%.3f</y>\n"
+             "\t\t\t\t<z>%.1f</z>\n"
+             "\t\t\t</_3DPosition>\n"
+             "\t\t\t<arbitraryDistance>%.3f</arbitraryDistance>\n"
+             "\t\t\t<macAddress>%s</macAddress>\n"
+             "\t\t\t<powerAtArbitraryDistance>%.3f</powerAtArbitraryDistance>\n"
+             "\t\t\t<powerTransmit>%.3f</powerTransmit>\n"
+             "\t\t</wifiNodeBlock%u>\n",
+             block,
+             access_point != nullptr ? access_point->pos.x : 0.0,
+             access_point != nullptr ? access_point->pos.y : 0.0,
+             access_point != nullptr ? access_point->pos.z : 0.0,
+             access_point != nullptr ? access_point->arbitrary_distance : 5.0,
+             access_point != nullptr ? access_point->mac_addr.c_str() : SyntheticBuilding::kUnusedMacAddress,
+             access_point != nullptr ? access_point->power_at_arbitrary_distance : -65.0,
+             access_point != nullptr ? access_point->power_transmit : -50.0,
+             block);
+    out += text;
+}
+} // namespace
+
+SyntheticBuilding::SyntheticBuilding(const BuildingOptions& options)
+    : options_(options)
+{
+    options_.floors                  = std::max(1u, std::min(options_.floors, kMaxFloors));
+    options_.access_points_per_floor = std::min(options_.access_points_per_floor, kMaxAccessPointsPerFloor);
+
+    std::mt19937                          random(options_.seed);
+    std::uniform_int_distribution<int>    mac_byte(0, 255);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    // Access points sit in the cells of a grid roughly as fine along both sides of the floor, moved
+    // around within the middle of their cell.
+    uint32_t count   = options_.access_points_per_floor;
+    uint32_t columns = std::max(1u,
+                                static_cast<uint32_t>(std::ceil(
+                                    std::sqrt(count * options_.width_m / std::max(options_.depth_m, 1.0f)))));
+    uint32_t rows    = std::max(1u, (count + columns - 1) / columns);
+    float    cell_x  = options_.width_m / columns;
+    float    cell_y  = options_.depth_m / rows;
+    for (uint32_t floor = 1; floor <= options_.floors; ++floor)
+    {
+        for (uint32_t block = 1; block <= count; ++block)
+        {
+            SyntheticAccessPoint access_point;
+            char                 mac_addr[18];
+            snprintf(mac_addr,
+                     sizeof(mac_addr),
+                     "02:%02x:%02x:%02x:%02x:%02x",
+                     mac_byte(random),
+                     mac_byte(random),
+                     mac_byte(random),
+                     floor,
+                     block);
+            access_point.mac_addr = MacAddress(mac_addr);
+            access_point.floor    = floor;
+            access_point.block    = block;
+
+            float transmit = options_.power_transmit_dbm + Deviation(random, options_.transmit_spread_db);
+
+            uint32_t cell                   = block - 1;
+            access_point.pos.x              = cell_x * ((cell % columns) + 0.25f + 0.5f * unit(random));
+            access_point.pos.y              = cell_y * ((cell / columns) + 0.25f + 0.5f * unit(random));
+            access_point.pos.z              = floor;
+            access_point.power_transmit     = transmit;
+            access_point.arbitrary_distance = options_.arbitrary_distance_m;
+            access_point.power_at_arbitrary_distance
+                = access_point.power_transmit
+                  - 10.0f * options_.path_loss_exponent * std::log10(options_.arbitrary_distance_m);
+            access_points_.push_back(access_point);
+        }
+    }
+
+    // Desks keep a metre away from the walls.
+    std::uniform_real_distribution<float> desk_x(std::min(1.0f, options_.width_m / 2),
+                                                 std::max(options_.width_m - 1.0f, options_.width_m / 2));
+    std::uniform_real_distribution<float> desk_y(std::min(1.0f, options_.depth_m / 2),
+                                                 std::max(options_.depth_m - 1.0f, options_.depth_m / 2));
+    for (uint32_t floor = 1; floor <= options_.floors; ++floor)
+    {
+        for (uint32_t desk = 0; desk < options_.desks_per_floor; ++desk)
+        {
+            Position pos = { desk_x(random), desk_y(random), static_cast<double>(floor) };
+            desks_.push_back(pos);
+        }
+    }
+}
+
+std::string SyntheticBuilding::LocalConfig() const
+{
+    std::string out = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                      "<WifiNodes xsi:noNamespaceSchemaLocation=\"wifiNode.xsd\" "
+                      "xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\">\n";
+
+    // The engine looks up every block of every floor, so all of them have to exist.
+    auto access_point = access_points_.begin();
+    for (uint32_t floor = 1; floor <= kMaxFloors; ++floor)
+    {
+        out += "\t<wifiFloor" + std::to_string(floor) + ">\n";
+        for (uint32_t block = 1; block <= kConfigBlocksPerFloor; ++block)
+        {
+            bool used = access_point != access_points_.end() && access_point->floor == floor
+                        && access_point->block == block;
+            AppendBlock(out, block, used ? &*access_point++ : nullptr);
+        }
+        out += "\t</wifiFloor" + std::to_string(floor) + ">\n";
+    }
+    out += "</WifiNodes>\n";
+    return out;
+}
+
+bool SyntheticBuilding::WriteLocalConfig(const std::string& filename) const
+{
+    std::ofstream file(filename, std::ios::out | std::ios::trunc);
+    if (!file)
+        return false;
+    file << LocalConfig();
+    return static_cast<bool>(file.flush());
+}
+
+float SyntheticBuilding::MeanRssi(const SyntheticAccessPoint& access_point, const Position& pos) const
+{
+    double dx       = access_point.pos.x - pos.x;
+    double dy       = access_point.pos.y - pos.y;
+    double dz       = (access_point.pos.z - pos.z) * options_.floor_height_m;
+    double distance = std::max(1.0, std::sqrt(dx * dx + dy * dy + dz * dz));
+    return access_point.power_transmit
+           - 10.0f * options_.path_loss_exponent * static_cast<float>(std::log10(distance));
+}
+
+std::vector<AccessPointRssiListPair> SyntheticBuilding::SimulateReadings(const Position& pos,
+                                                                         size_t           samples,
+                                                                         std::mt19937&    random) const
+{
+    std::vector<std::pair<float, const SyntheticAccessPoint*>> heard;
+    for (auto const& access_point : access_points_)
+    {
+        float rssi = MeanRssi(access_point, pos);
+        if (rssi >= options_.sensitivity_dbm)
+            heard.emplace_back(rssi, &access_point);
+    }
+    std::stable_sort(heard.begin(), heard.end(), [](const std::pair<float, const SyntheticAccessPoint*>& lhs,
+                                                    const std::pair<float, const SyntheticAccessPoint*>& rhs) {
+        return lhs.first > rhs.first;
+    });
+    heard.resize(std::min<size_t>(heard.size(), MAXIMUM_NUMBER_NODES));
+
+    std::vector<AccessPointRssiListPair> series;
+    for (auto const& access_point : heard)
+    {
+        std::vector<int32_t> rssi(samples);
+        for (auto& reading : rssi)
+            reading = static_cast<int32_t>(std::lround(access_point.first + Deviation(random, options_.noise_db)));
+        series.emplace_back(AccessPoint(access_point.second->mac_addr, access_point.second->pos), std::move(rssi));
+    }
+    return series;
+}
+
+} // namespace ins_service
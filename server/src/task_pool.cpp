@@ -0,0 +1,109 @@
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "task_pool.hpp"
+
+namespace ins_service
+{
+
+bool ApplyThreadPriority(ThreadPriority priority)
+{
+    // Linux keeps a nice value per thread when it is addressed by thread id.
+    int   niceness = priority == ThreadPriority::kBulk ? kBulkThreadNiceness : 0;
+    pid_t tid      = static_cast<pid_t>(syscall(SYS_gettid));
+    return setpriority(PRIO_PROCESS, static_cast<id_t>(tid), niceness) == 0;
+}
+
+void TaskPool::Start()
+{
+    INS_LOG_DEBUG(console_, "+ TaskPool::Start");
+
+    if (!running_)
+    {
+        stop_    = false;
+        running_ = true;
+        for (size_t i = 0; i < thread_count_; ++i)
+            threads_.emplace_back(&TaskPool::Run, this);
+        console_->info("Running {0} pool on {1} threads, queueing up to {2} tasks", name_, thread_count_, queue_limit_);
+    }
+
+    INS_LOG_DEBUG(console_, "- TaskPool::Start");
+}
+
+void TaskPool::Stop()
+{
+    if (!running_)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        stop_ = true;
+    }
+    ready_.notify_all();
+    for (auto& thread : threads_)
+        thread.join();
+    threads_.clear();
+    running_ = false;
+}
+
+bool TaskPool::TrySubmit(Task task)
+{
+    if (!running_)
+    {
+        task();
+        return true;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        if (queue_.size() >= queue_limit_)
+        {
+            ++rejected_;
+            return false;
+        }
+        queue_.push_back(std::move(task));
+    }
+    ready_.notify_one();
+    return true;
+}
+
+size_t TaskPool::Depth() const
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    return queue_.size();
+}
+
+void TaskPool::Run()
+{
+    if (!ApplyThreadPriority(priority_))
+        console_->warn("Unable to set the thread priority of the {0} pool", name_);
+
+    std::unique_lock<std::mutex> lock(lock_);
+    for (;;)
+    {
+        ready_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+        if (queue_.empty())
+            break;
+
+        Task task = std::move(queue_.front());
+        queue_.pop_front();
+        lock.unlock();
+        // A throwing task must not take the pool thread, and the process, down with it.
+        try
+        {
+            task();
+        }
+        catch (const std::exception& e)
+        {
+            console_->error("Task of the {0} pool failed: {1}", name_, e.what());
+        }
+        catch (...)
+        {
+            console_->error("Task of the {0} pool failed with an unknown exception", name_);
+        }
+        lock.lock();
+    }
+}
+
+} // namespace ins_service
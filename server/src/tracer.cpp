@@ -0,0 +1,159 @@
+#include <cinttypes>
+#include <cstdio>
+
+#include "tracer.hpp"
+
+namespace ins_service
+{
+
+const size_t Tracer::kRingSpans;
+
+namespace
+{
+std::atomic<uint64_t> g_next_tracer_id(1);
+
+// Ring of the Tracer instance this thread recorded into last; instances are told apart by id as a new
+// instance may reuse the address of a destroyed one.
+struct RingCache
+{
+    uint64_t owner;
+    void*    ring;
+};
+
+thread_local RingCache t_ring_cache = { 0, nullptr };
+
+thread_local uint64_t t_current_trace = 0;
+
+int64_t SinceEpochNs(Tracer::Clock::time_point time)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+} // namespace
+
+Tracer::Tracer()
+    : id_(g_next_tracer_id++)
+    , sample_every_(0)
+    , requests_(0)
+{
+}
+
+void Tracer::SetSampleEvery(uint32_t every)
+{
+    sample_every_.store(every, std::memory_order_relaxed);
+}
+
+uint64_t Tracer::StartTrace()
+{
+    uint32_t every = sample_every_.load(std::memory_order_relaxed);
+    if (every == 0)
+        return 0;
+
+    uint64_t request = requests_.fetch_add(1, std::memory_order_relaxed);
+    if (request % every != 0)
+        return 0;
+    return request / every + 1;
+}
+
+void Tracer::Record(const char* name, uint64_t trace_id, Clock::time_point start, Clock::time_point end)
+{
+    if (trace_id == 0)
+        return;
+
+    Ring&                       ring = LocalRing();
+    std::lock_guard<std::mutex> lock(ring.lock);
+    Span&                       span = ring.spans[ring.next++ % kRingSpans];
+    span.name                        = name;
+    span.trace_id                    = trace_id;
+    span.start_ns                    = SinceEpochNs(start);
+    span.duration_ns                 = SinceEpochNs(end) - span.start_ns;
+}
+
+void Tracer::Dump(std::string& out) const
+{
+    char event[256];
+    bool first = true;
+
+    out += "{\"traceEvents\":[";
+    std::lock_guard<std::mutex> lock(lock_);
+    for (auto const& entry : rings_)
+    {
+        Ring&                       ring = *entry.second;
+        std::lock_guard<std::mutex> ring_lock(ring.lock);
+        uint64_t                    begin = ring.next > kRingSpans ? ring.next - kRingSpans : 0;
+        for (uint64_t i = begin; i < ring.next; ++i)
+        {
+            // Names are literals of this code base, they never need escaping.
+            const Span& span = ring.spans[i % kRingSpans];
+            snprintf(event,
+                     sizeof(event),
+                     "%s{\"name\":\"%s\",\"cat\":\"ins\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+                     "\"pid\":1,\"tid\":%" PRIu32 ",\"args\":{\"trace\":%" PRIu64 "}}",
+                     first ? "" : ",",
+                     span.name,
+                     span.start_ns / 1e3,
+                     span.duration_ns / 1e3,
+                     ring.tid,
+                     span.trace_id);
+            out += event;
+            first = false;
+        }
+    }
+    out += "],\"displayTimeUnit\":\"ms\"}";
+}
+
+Tracer::Ring& Tracer::LocalRing()
+{
+    RingCache& cache = t_ring_cache;
+    if (cache.owner != id_)
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        std::unique_ptr<Ring>&      ring = rings_[std::this_thread::get_id()];
+        if (ring == nullptr)
+        {
+            ring.reset(new Ring());
+            ring->tid  = static_cast<uint32_t>(rings_.size());
+            ring->next = 0;
+        }
+        cache.owner = id_;
+        cache.ring  = ring.get();
+    }
+    return *static_cast<Ring*>(cache.ring);
+}
+
+Tracer& DefaultTracer()
+{
+    static Tracer tracer;
+    return tracer;
+}
+
+uint64_t CurrentTrace()
+{
+    return t_current_trace;
+}
+
+TraceScope::TraceScope(uint64_t trace_id)
+    : previous_(t_current_trace)
+{
+    t_current_trace = trace_id;
+}
+
+TraceScope::~TraceScope()
+{
+    t_current_trace = previous_;
+}
+
+TraceSpan::TraceSpan(const char* name)
+    : name_(name)
+    , trace_id_(t_current_trace)
+{
+    if (trace_id_ != 0)
+        start_ = Tracer::Clock::now();
+}
+
+TraceSpan::~TraceSpan()
+{
+    if (trace_id_ != 0)
+        DefaultTracer().Record(name_, trace_id_, start_, Tracer::Clock::now());
+}
+
+} // namespace ins_service
@@ -0,0 +1,11 @@
+#include <InsNodePool.h>
+
+uint32_t insNodePoolInit(uint32_t blocksPerSlab, uint32_t prefaultBlocks)
+{
+	return 0;
+}
+
+void insNodePoolGetStats(insNodePoolStats_t * stats)
+{
+	memset(stats, 0, sizeof(insNodePoolStats_t));
+}
@@ -4,6 +4,10 @@
 insNode_t insNoderootP;
 insNode_t * insNoderoot = &insNoderootP;
 
+void insSetStageTimer(insStageTimer_t timer)
+{
+}
+
 float * GetCartesianPosition(insNode_t * insNodeBlock)
 {
 	float * mock_position;
@@ -17,3 +21,10 @@ insNode_t *  createInsNodeListDevice(const char * deviceId)
 
 	return mock_insNode;
 }
+
+insNode_t * findWifiNode(insNode_t * insNoderoot, const char * deviceId)
+{
+	insNode_t * mock_insNode = NULL;
+
+	return mock_insNode;
+}
@@ -36,12 +36,24 @@ bool DataStore::InsertRSSIReadings(const std::string&       dev,
     return g_mocked_data_store_->InsertRSSIReadings(dev, accesspoint_rssi_pair);
 }
 
+bool DataStore::InsertRSSIReadings(const std::string& dev, const RssiReading* readings, size_t count)
+{
+    EXPECT_TRUE(g_mocked_data_store_ != nullptr);
+    return g_mocked_data_store_->InsertRSSIReadings(dev, readings, count);
+}
+
 bool DataStore::GetPosition(const std::string& id, QueryT query, Position& pos)
 {
     EXPECT_TRUE(g_mocked_data_store_ != nullptr);
     return g_mocked_data_store_->GetPosition(id, query, pos);
 }
 
+std::vector<std::string> DataStore::GetEmployeeIds()
+{
+    EXPECT_TRUE(g_mocked_data_store_ != nullptr);
+    return g_mocked_data_store_->GetEmployeeIds();
+}
+
 bool DataStore::CreateDeviceTable(const std::string& dev)
 {
     EXPECT_TRUE(g_mocked_data_store_ != nullptr);
@@ -54,19 +66,133 @@ bool DataStore::ClearDeviceTable(const std::string& dev)
     return g_mocked_data_store_->ClearDeviceTable(dev);
 }
 
+bool DataStore::VisitDistinctAccessPoints(const std::string& dev, const AccessPointVisitor& visitor)
+{
+    EXPECT_TRUE(g_mocked_data_store_ != nullptr);
+    return g_mocked_data_store_->VisitDistinctAccessPoints(dev, visitor);
+}
+
+bool DataStore::VisitRSSISeries(const std::string& dev, const AccessPoint& access_point, const RssiVisitor& visitor)
+{
+    EXPECT_TRUE(g_mocked_data_store_ != nullptr);
+    return g_mocked_data_store_->VisitRSSISeries(dev, access_point, visitor);
+}
+
+bool DataStore::GetDistinctAccessPoints(const std::string& dev, std::vector<AccessPoint>& access_points)
+{
+    EXPECT_TRUE(g_mocked_data_store_ != nullptr);
+    return g_mocked_data_store_->GetDistinctAccessPoints(dev, access_points);
+}
+
+bool DataStore::GetRSSISeriesFromDatabase(const std::string&    device_id,
+                                          const AccessPoint&    access_point,
+                                          std::vector<int32_t>& rssi_list)
+{
+    EXPECT_TRUE(g_mocked_data_store_ != nullptr);
+    return g_mocked_data_store_->GetRSSISeriesData(device_id, access_point, rssi_list);
+}
+
+bool DataStore::GetRSSISeriesData(const std::string&                    device_id,
+                                  const std::vector<AccessPoint>&       access_points,
+                                  std::vector<AccessPointRssiListPair>& series)
+{
+    EXPECT_TRUE(g_mocked_data_store_ != nullptr);
+    return g_mocked_data_store_->GetRSSISeriesData(device_id, access_points, series);
+}
+
+bool DataStore::CollectRSSISeries(const std::string& device_id, ArenaVector<RssiSeries>& series)
+{
+    EXPECT_TRUE(g_mocked_data_store_ != nullptr);
+    return g_mocked_data_store_->CollectRSSISeries(device_id, series);
+}
+
+bool DataStore::GetDeviceIds(std::vector<std::string>& device_ids)
+{
+    EXPECT_TRUE(g_mocked_data_store_ != nullptr);
+    return g_mocked_data_store_->GetDeviceIds(device_ids);
+}
+
+bool DataStore::VisitReadings(const std::string& dev, const ReadingVisitor& visitor)
+{
+    EXPECT_TRUE(g_mocked_data_store_ != nullptr);
+    return g_mocked_data_store_->VisitReadings(dev, visitor);
+}
+
+bool DataStore::VisitLocations(const LocationVisitor& visitor)
+{
+    EXPECT_TRUE(g_mocked_data_store_ != nullptr);
+    return g_mocked_data_store_->VisitLocations(visitor);
+}
+
+bool DataStore::VisitAccessPoints(const AccessPointPositionVisitor& visitor)
+{
+    EXPECT_TRUE(g_mocked_data_store_ != nullptr);
+    return g_mocked_data_store_->VisitAccessPoints(visitor);
+}
+
+bool DataStore::BeginTransaction()
+{
+    EXPECT_TRUE(g_mocked_data_store_ != nullptr);
+    return g_mocked_data_store_->BeginTransaction();
+}
+
+bool DataStore::CommitTransaction()
+{
+    EXPECT_TRUE(g_mocked_data_store_ != nullptr);
+    return g_mocked_data_store_->CommitTransaction();
+}
+
+bool DataStore::RollbackTransaction()
+{
+    EXPECT_TRUE(g_mocked_data_store_ != nullptr);
+    return g_mocked_data_store_->RollbackTransaction();
+}
+
+// Kept real on top of the mocked transaction calls, tests expect those around the statements of body.
+bool DataStore::RunInTransaction(const std::function<bool()>& body)
+{
+    if (!BeginTransaction())
+        return false;
+
+    if (body() && CommitTransaction())
+        return true;
+
+    RollbackTransaction();
+    return false;
+}
+
+bool DataStore::InsertReadings(const std::string& dev, const std::vector<StoredReading>& readings)
+{
+    EXPECT_TRUE(g_mocked_data_store_ != nullptr);
+    return g_mocked_data_store_->InsertReadings(dev, readings);
+}
+
+bool DataStore::InsertLocations(const std::vector<StoredLocation>& locations)
+{
+    EXPECT_TRUE(g_mocked_data_store_ != nullptr);
+    return g_mocked_data_store_->InsertLocations(locations);
+}
+
+bool DataStore::InsertAccessPoints(const std::vector<AccessPoint>& access_points)
+{
+    EXPECT_TRUE(g_mocked_data_store_ != nullptr);
+    return g_mocked_data_store_->InsertAccessPoints(access_points);
+}
+
 std::vector<AccessPoint> DataStore::GetDistinctAccessPoints(const std::string& dev)
 {
     EXPECT_TRUE(g_mocked_data_store_ != nullptr);
     return g_mocked_data_store_->GetDistinctAccessPoints(dev);
 }
 
-std::vector<int32_t> DataStore::GetRSSISeriesFromDatabase(const std::string& device_id, AccessPoint access_point)
+std::vector<int32_t> DataStore::GetRSSISeriesFromDatabase(const std::string& device_id, const AccessPoint& access_point)
 {
     EXPECT_TRUE(g_mocked_data_store_ != nullptr);
     return g_mocked_data_store_->GetRSSISeriesData(device_id, access_point);
 }
 
-std::vector<AccessPointRssiListPair> DataStore::GetRSSISeriesData(const std::string& device_id, std::vector<AccessPoint> access_points)
+std::vector<AccessPointRssiListPair> DataStore::GetRSSISeriesData(const std::string&              device_id,
+                                                                  const std::vector<AccessPoint>& access_points)
 {
     EXPECT_TRUE(g_mocked_data_store_ != nullptr);
     return g_mocked_data_store_->GetRSSISeriesData(device_id, access_points);
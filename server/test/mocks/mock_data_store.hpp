@@ -26,17 +26,55 @@ public:
 
     MOCK_METHOD2(InsertRSSIReadings, bool(const std::string&, std::vector<AccessPointRssiPair>));
 
+    MOCK_METHOD3(InsertRSSIReadings, bool(const std::string&, const RssiReading*, size_t));
+
     MOCK_METHOD3(GetPosition, bool(const std::string&, QueryT, Position&));
 
+    MOCK_METHOD0(GetEmployeeIds, std::vector<std::string>());
+
     MOCK_METHOD1(CreateDeviceTable, bool(const std::string&));
 
     MOCK_METHOD1(ClearDeviceTable, bool(const std::string&));
 
+    MOCK_METHOD2(VisitDistinctAccessPoints, bool(const std::string&, const AccessPointVisitor&));
+
+    MOCK_METHOD3(VisitRSSISeries, bool(const std::string&, const AccessPoint&, const RssiVisitor&));
+
+    MOCK_METHOD2(GetDistinctAccessPoints, bool(const std::string&, std::vector<AccessPoint>&));
+
+    MOCK_METHOD3(GetRSSISeriesData, bool(const std::string&, const AccessPoint&, std::vector<int32_t>&));
+
+    MOCK_METHOD3(GetRSSISeriesData,
+                 bool(const std::string&, const std::vector<AccessPoint>&, std::vector<AccessPointRssiListPair>&));
+
+    MOCK_METHOD2(CollectRSSISeries, bool(const std::string&, ArenaVector<RssiSeries>&));
+
+    MOCK_METHOD1(GetDeviceIds, bool(std::vector<std::string>&));
+
+    MOCK_METHOD2(VisitReadings, bool(const std::string&, const ReadingVisitor&));
+
+    MOCK_METHOD1(VisitLocations, bool(const LocationVisitor&));
+
+    MOCK_METHOD1(VisitAccessPoints, bool(const AccessPointPositionVisitor&));
+
+    MOCK_METHOD0(BeginTransaction, bool());
+
+    MOCK_METHOD0(CommitTransaction, bool());
+
+    MOCK_METHOD0(RollbackTransaction, bool());
+
+    MOCK_METHOD2(InsertReadings, bool(const std::string&, const std::vector<StoredReading>&));
+
+    MOCK_METHOD1(InsertLocations, bool(const std::vector<StoredLocation>&));
+
+    MOCK_METHOD1(InsertAccessPoints, bool(const std::vector<AccessPoint>&));
+
     MOCK_METHOD1(GetDistinctAccessPoints, std::vector<AccessPoint>(const std::string&));
 
-    MOCK_METHOD2(GetRSSISeriesData, std::vector<int32_t>(const std::string&, AccessPoint));
+    MOCK_METHOD2(GetRSSISeriesData, std::vector<int32_t>(const std::string&, const AccessPoint&));
 
-    MOCK_METHOD2(GetRSSISeriesData, std::vector<AccessPointRssiListPair>(const std::string&, std::vector<AccessPoint>));
+    MOCK_METHOD2(GetRSSISeriesData,
+                 std::vector<AccessPointRssiListPair>(const std::string&, const std::vector<AccessPoint>&));
 
     ~MockDataStore()
     {
@@ -0,0 +1,61 @@
+#include "mock_device_registry.hpp"
+
+namespace ins_service
+{
+
+::testing::NiceMock<MockDeviceRegistry>* g_mocked_device_registry_;
+
+DeviceRegistry::~DeviceRegistry()
+{
+}
+
+bool DeviceRegistry::Init()
+{
+    EXPECT_TRUE(g_mocked_device_registry_ != nullptr);
+    return g_mocked_device_registry_->Init();
+}
+
+insNode_t* DeviceRegistry::Acquire(const DeviceId& device_id, bool pin)
+{
+    EXPECT_TRUE(g_mocked_device_registry_ != nullptr);
+    return g_mocked_device_registry_->Acquire(device_id, pin);
+}
+
+bool DeviceRegistry::Touch(const DeviceId& device_id, bool pin)
+{
+    EXPECT_TRUE(g_mocked_device_registry_ != nullptr);
+    return g_mocked_device_registry_->Touch(device_id, pin);
+}
+
+void DeviceRegistry::Unpin(const DeviceId& device_id)
+{
+    EXPECT_TRUE(g_mocked_device_registry_ != nullptr);
+    g_mocked_device_registry_->Unpin(device_id);
+}
+
+void DeviceRegistry::Restore(const DeviceRecord& record)
+{
+    EXPECT_TRUE(g_mocked_device_registry_ != nullptr);
+    g_mocked_device_registry_->Restore(record);
+}
+
+void DeviceRegistry::VisitRecords(std::shared_timed_mutex&                          engine_lock,
+                                  const std::function<void(const DeviceRecord&)>& visitor)
+{
+    EXPECT_TRUE(g_mocked_device_registry_ != nullptr);
+    g_mocked_device_registry_->VisitRecords(engine_lock, visitor);
+}
+
+size_t DeviceRegistry::ResidentCount() const
+{
+    EXPECT_TRUE(g_mocked_device_registry_ != nullptr);
+    return g_mocked_device_registry_->ResidentCount();
+}
+
+size_t DeviceRegistry::SpilledCount() const
+{
+    EXPECT_TRUE(g_mocked_device_registry_ != nullptr);
+    return g_mocked_device_registry_->SpilledCount();
+}
+
+} // ins_service
@@ -0,0 +1,47 @@
+#ifndef INS_SERVER_TEST_MOCKS_DEVICE_REGISTRY_HPP
+#define INS_SERVER_TEST_MOCKS_DEVICE_REGISTRY_HPP
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "device_registry.hpp"
+
+namespace ins_service
+{
+
+class MockDeviceRegistry;
+
+extern ::testing::NiceMock<MockDeviceRegistry>* g_mocked_device_registry_;
+
+class MockDeviceRegistry : public DeviceRegistry
+{
+public:
+    MockDeviceRegistry()
+        : DeviceRegistry(1, "")
+    {
+    }
+
+    MOCK_METHOD0(Init, bool());
+
+    MOCK_METHOD2(Acquire, insNode_t*(const DeviceId&, bool));
+
+    MOCK_METHOD2(Touch, bool(const DeviceId&, bool));
+
+    MOCK_METHOD1(Unpin, void(const DeviceId&));
+
+    MOCK_METHOD1(Restore, void(const DeviceRecord&));
+
+    MOCK_METHOD2(VisitRecords, void(std::shared_timed_mutex&, const std::function<void(const DeviceRecord&)>&));
+
+    MOCK_CONST_METHOD0(ResidentCount, size_t());
+
+    MOCK_CONST_METHOD0(SpilledCount, size_t());
+
+    ~MockDeviceRegistry()
+    {
+        g_mocked_device_registry_ = nullptr;
+    }
+};
+}
+
+#endif // !INS_SERVER_TEST_MOCKS_DEVICE_REGISTRY_HPP
@@ -0,0 +1,24 @@
+#include "mock_engine_snapshot.hpp"
+
+namespace ins_service
+{
+
+::testing::NiceMock<MockEngineSnapshot>* g_mocked_engine_snapshot_;
+
+bool EngineSnapshot::Save(const std::string&       filename,
+                          std::shared_timed_mutex& engine_lock,
+                          DeviceRegistry&          device_registry)
+{
+    EXPECT_TRUE(g_mocked_engine_snapshot_ != nullptr);
+    return g_mocked_engine_snapshot_->Save(filename, engine_lock, device_registry);
+}
+
+bool EngineSnapshot::Restore(const std::string&       filename,
+                             std::shared_timed_mutex& engine_lock,
+                             DeviceRegistry&          device_registry)
+{
+    EXPECT_TRUE(g_mocked_engine_snapshot_ != nullptr);
+    return g_mocked_engine_snapshot_->Restore(filename, engine_lock, device_registry);
+}
+
+} // ins_service
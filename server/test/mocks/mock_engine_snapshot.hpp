@@ -0,0 +1,30 @@
+#ifndef INS_SERVER_TEST_MOCKS_ENGINE_SNAPSHOT_HPP
+#define INS_SERVER_TEST_MOCKS_ENGINE_SNAPSHOT_HPP
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "engine_snapshot.hpp"
+
+namespace ins_service
+{
+
+class MockEngineSnapshot;
+
+extern ::testing::NiceMock<MockEngineSnapshot>* g_mocked_engine_snapshot_;
+
+class MockEngineSnapshot : public EngineSnapshot
+{
+public:
+    MOCK_METHOD3(Save, bool(const std::string&, std::shared_timed_mutex&, DeviceRegistry&));
+
+    MOCK_METHOD3(Restore, bool(const std::string&, std::shared_timed_mutex&, DeviceRegistry&));
+
+    ~MockEngineSnapshot()
+    {
+        g_mocked_engine_snapshot_ = nullptr;
+    }
+};
+}
+
+#endif // !INS_SERVER_TEST_MOCKS_ENGINE_SNAPSHOT_HPP
@@ -5,10 +5,10 @@ namespace ins_service
 
 ::testing::NiceMock<MockLocalization>* g_mocked_localization_;
 
-Position Localization::ProcessRSSIDataSet(const std::string& device_id)
+Position Localization::ProcessRSSIDataSet(const std::string& device_id, std::shared_timed_mutex& engine_lock)
 {
     EXPECT_TRUE(g_mocked_localization_ != nullptr);
-    return g_mocked_localization_->ProcessRSSIDataSet(device_id);
+    return g_mocked_localization_->ProcessRSSIDataSet(device_id, engine_lock);
 }
 
 } // ins_service
\ No newline at end of file
@@ -15,7 +15,7 @@ extern ::testing::NiceMock<MockLocalization>* g_mocked_localization_;
 class MockLocalization : public Localization
 {
 public:
-    MOCK_METHOD1(ProcessRSSIDataSet, Position(const std::string&));
+    MOCK_METHOD2(ProcessRSSIDataSet, Position(const std::string&, std::shared_timed_mutex&));
 
     ~MockLocalization()
     {
@@ -0,0 +1,84 @@
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "admission_controller.hpp"
+
+using namespace ::testing;
+
+namespace ins_service
+{
+
+class AdmissionControllerFixture : public Test
+{
+protected:
+    typedef std::shared_ptr<AdmissionController::Ticket> TicketPtr;
+};
+
+/**
+ * TEST: Admit
+ * EXPECT: Requests over the class limit are shed until a ticket is released.
+ */
+TEST_F(AdmissionControllerFixture, Admit_OverLimit_WillShedUntilReleased)
+{
+    AdmissionController admission(4, 2, 4);
+
+    TicketPtr first  = admission.Admit(RouteClass::kDevice);
+    TicketPtr second = admission.Admit(RouteClass::kDevice);
+    EXPECT_NE(nullptr, first);
+    EXPECT_NE(nullptr, second);
+    EXPECT_EQ(nullptr, admission.Admit(RouteClass::kDevice));
+    EXPECT_EQ(2u, admission.InFlight(RouteClass::kDevice));
+    EXPECT_EQ(1u, admission.Shed(RouteClass::kDevice));
+
+    first.reset();
+    EXPECT_EQ(1u, admission.InFlight(RouteClass::kDevice));
+    EXPECT_NE(nullptr, admission.Admit(RouteClass::kDevice));
+}
+
+/**
+ * TEST: Admit
+ * EXPECT: Lower classes are shed while a higher class is more than half full, higher classes are not affected
+ *         by lower ones.
+ */
+TEST_F(AdmissionControllerFixture, Admit_BusyHigherClass_WillShedLowerClasses)
+{
+    AdmissionController    admission(4, 4, 4);
+    std::vector<TicketPtr> uploads;
+    for (int i = 0; i < 4; ++i)
+        uploads.push_back(admission.Admit(RouteClass::kIngest));
+    EXPECT_NE(nullptr, admission.Admit(RouteClass::kInteractive));
+
+    std::vector<TicketPtr> lookups;
+    for (int i = 0; i < 3; ++i)
+        lookups.push_back(admission.Admit(RouteClass::kInteractive));
+    EXPECT_EQ(nullptr, admission.Admit(RouteClass::kDevice));
+
+    uploads.clear();
+    EXPECT_EQ(nullptr, admission.Admit(RouteClass::kIngest));
+    EXPECT_EQ(1u, admission.Shed(RouteClass::kIngest));
+
+    lookups.clear();
+    EXPECT_NE(nullptr, admission.Admit(RouteClass::kIngest));
+}
+
+/**
+ * TEST: RetryAfter
+ * EXPECT: Hints are spread between the base of the class and twice that, uploads backing off the furthest.
+ */
+TEST_F(AdmissionControllerFixture, RetryAfter_WillSpreadHints)
+{
+    AdmissionController admission(4, 4, 4);
+
+    std::vector<uint32_t> hints;
+    for (int i = 0; i < 5; ++i)
+        hints.push_back(admission.RetryAfter(RouteClass::kIngest));
+    EXPECT_THAT(hints, Each(AllOf(Ge(5u), Lt(10u))));
+    EXPECT_THAT(hints, Contains(Ne(hints.front())));
+
+    EXPECT_EQ(1u, admission.RetryAfter(RouteClass::kInteractive));
+}
+
+} // namespace ins_service
@@ -0,0 +1,108 @@
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+
+#include "arena.hpp"
+
+using namespace ::testing;
+
+namespace ins_service
+{
+
+class ArenaFixture : public Test
+{
+public:
+    size_t BlockCount()
+    {
+        return arena_.blocks_.size();
+    }
+
+protected:
+    Arena arena_{ 1024 };
+};
+
+/**
+ * TEST: Allocate
+ * EXPECT: Allocations honour the requested alignment and do not overlap.
+ */
+TEST_F(ArenaFixture, Allocate_WillAlignAndNotOverlap)
+{
+    char*    byte  = static_cast<char*>(arena_.Allocate(1, 1));
+    double*  value = static_cast<double*>(arena_.Allocate(sizeof(double), alignof(double)));
+    int32_t* words = static_cast<int32_t*>(arena_.Allocate(4 * sizeof(int32_t), alignof(int32_t)));
+
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(value) % alignof(double));
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(words) % alignof(int32_t));
+    EXPECT_LT(byte, reinterpret_cast<char*>(value));
+    EXPECT_LE(reinterpret_cast<char*>(value + 1), reinterpret_cast<char*>(words));
+}
+
+/**
+ * TEST: Allocate
+ * EXPECT: Requests larger than the block size get a block of their own.
+ */
+TEST_F(ArenaFixture, Allocate_Oversized_WillUseDedicatedBlock)
+{
+    arena_.Allocate(16);
+    void* large = arena_.Allocate(4096);
+    std::memset(large, 0x5a, 4096);
+
+    EXPECT_EQ(2u, BlockCount());
+    EXPECT_GE(arena_.BytesReserved(), 1024u + 4096u);
+}
+
+/**
+ * TEST: Rewind
+ * EXPECT: Rewinding to empty reuses the same memory, no new blocks are allocated.
+ */
+TEST_F(ArenaFixture, Rewind_WillReuseBlocks)
+{
+    void* first = arena_.Allocate(512);
+    arena_.Allocate(768);
+    EXPECT_EQ(2u, BlockCount());
+
+    arena_.Rewind(Arena::Mark{ 0, 0 });
+    EXPECT_EQ(first, arena_.Allocate(512));
+    arena_.Allocate(768);
+    EXPECT_EQ(2u, BlockCount());
+}
+
+/**
+ * TEST: ArenaScope
+ * EXPECT: Nested scopes only release what was allocated inside them.
+ */
+TEST_F(ArenaFixture, ArenaScope_Nested_WillKeepOuterAllocations)
+{
+    ArenaScope  outer(arena_);
+    const char* mac_addr = arena_.CopyString(std::string("ee:44:43:a5:ff:ef"));
+    void*       inner_allocation;
+    {
+        ArenaScope inner(arena_);
+        inner_allocation = arena_.Allocate(64);
+        std::memset(inner_allocation, 0, 64);
+    }
+
+    EXPECT_STREQ("ee:44:43:a5:ff:ef", mac_addr);
+    EXPECT_EQ(inner_allocation, arena_.Allocate(64));
+}
+
+/**
+ * TEST: ArenaVector
+ * EXPECT: Standard containers grow inside the arena.
+ */
+TEST_F(ArenaFixture, ArenaVector_WillGrowInArena)
+{
+    ArenaScope           scope(arena_);
+    ArenaVector<int32_t> rssi(scope.Allocator<int32_t>());
+    for (int32_t i = 0; i < 1000; ++i)
+        rssi.push_back(-i);
+
+    EXPECT_EQ(1000u, rssi.size());
+    EXPECT_EQ(-999, rssi.back());
+    EXPECT_EQ(&arena_, &rssi.get_allocator().arena());
+}
+
+} // namespace !ins_service
@@ -0,0 +1,130 @@
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <future>
+#include <stdexcept>
+#include <thread>
+
+#include "coroutine.hpp"
+#include "mock_data_store.hpp"
+
+using namespace ::testing;
+
+namespace ins_service
+{
+
+class CoroutineFixture : public Test
+{
+public:
+    virtual void SetUp()
+    {
+        g_mocked_data_store_ = &mock_data_store_;
+        ON_CALL(mock_data_store_, BeginTransaction()).WillByDefault(Return(true));
+        ON_CALL(mock_data_store_, CommitTransaction()).WillByDefault(Return(true));
+        ON_CALL(mock_data_store_, CreateDeviceTable(_)).WillByDefault(Return(true));
+        ON_CALL(mock_data_store_, InsertRSSIReadings(_, An<const RssiReading*>(), _)).WillByDefault(Return(true));
+    }
+
+protected:
+    static DetachedTask HopToDevice(DeviceExecutor& executor, const char* device_id,
+                                    std::promise<std::pair<bool, std::thread::id>>& resumed)
+    {
+        bool posted = co_await ResumeOnDevice(executor, DeviceId(device_id));
+        resumed.set_value(std::make_pair(posted, std::this_thread::get_id()));
+    }
+
+    static DetachedTask ThrowOnDevice(DeviceExecutor& executor, const char* device_id)
+    {
+        co_await ResumeOnDevice(executor, DeviceId(device_id));
+        throw std::runtime_error("failed");
+    }
+
+    static DetachedTask WaitForStorage(StorageWriter& writer, std::promise<size_t>& depth)
+    {
+        co_await ResumeWhenStored(writer);
+        depth.set_value(writer.Depth());
+    }
+
+    NiceMock<MockDataStore>    mock_data_store_;
+    std::shared_ptr<DataStore> data_store_ = std::make_shared<DataStore>();
+};
+
+/**
+ * TEST: ResumeOnDevice
+ * EXPECT: The coroutine continues on the shard of the device.
+ */
+TEST_F(CoroutineFixture, ResumeOnDevice_WillContinueOnShard)
+{
+    DeviceExecutor executor(2);
+    executor.Start();
+
+    std::promise<std::pair<bool, std::thread::id>> resumed;
+    HopToDevice(executor, "1000", resumed);
+    auto result = resumed.get_future().get();
+    EXPECT_TRUE(result.first);
+    EXPECT_NE(std::this_thread::get_id(), result.second);
+
+    executor.Stop();
+}
+
+/**
+ * TEST: ResumeOnDevice
+ * EXPECT: A saturated executor does not take the coroutine, which continues right away with false.
+ */
+TEST_F(CoroutineFixture, ResumeOnDevice_SaturatedExecutor_WillNotSuspend)
+{
+    DeviceExecutor executor(1, 1);
+    executor.Start();
+
+    std::promise<void> release;
+    auto               released = release.get_future().share();
+    ASSERT_TRUE(executor.TryPost(DeviceId("2000"), [released] { released.wait(); }));
+
+    std::promise<std::pair<bool, std::thread::id>> resumed;
+    HopToDevice(executor, "1000", resumed);
+    auto result = resumed.get_future().get();
+    EXPECT_FALSE(result.first);
+    EXPECT_EQ(std::this_thread::get_id(), result.second);
+
+    release.set_value();
+    executor.Stop();
+}
+
+/**
+ * TEST: ResumeWhenStored
+ * EXPECT: The coroutine continues once the uploads queued before the wait are stored.
+ */
+TEST_F(CoroutineFixture, ResumeWhenStored_WillContinueAfterStorage)
+{
+    StorageWriter writer(data_store_);
+    EXPECT_CALL(mock_data_store_, InsertRSSIReadings("1000", An<const RssiReading*>(), 1u)).Times(50);
+
+    writer.Start();
+    RssiReading reading{ MacAddress("23:43:3d:3e:5e:f5"), -40 };
+    for (int i = 0; i < 50; ++i)
+        EXPECT_TRUE(writer.Submit(DeviceId("1000"), &reading, 1));
+
+    std::promise<size_t> depth;
+    WaitForStorage(writer, depth);
+    EXPECT_EQ(0u, depth.get_future().get());
+
+    writer.Stop();
+}
+
+/**
+ * TEST: DetachedTask
+ * EXPECT: An exception escaping a detached coroutine is logged, the shard and the process go on.
+ */
+TEST_F(CoroutineFixture, DetachedTask_Throws_WillNotTerminate)
+{
+    DeviceExecutor executor(1);
+    executor.Start();
+
+    ThrowOnDevice(executor, "1000");
+    std::promise<std::pair<bool, std::thread::id>> resumed;
+    HopToDevice(executor, "1000", resumed);
+    EXPECT_TRUE(resumed.get_future().get().first);
+}
+
+} // namespace ins_service
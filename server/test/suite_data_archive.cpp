@@ -0,0 +1,207 @@
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <fstream>
+
+#include "checksum.hpp"
+#include "data_archive.hpp"
+#include "data_store.hpp"
+
+using namespace ::testing;
+
+namespace ins_service
+{
+
+class DataArchiveFixture : public Test
+{
+public:
+    virtual void SetUp()
+    {
+        source_->Init("archive_source_db");
+        target_->Init("archive_target_db");
+    }
+
+    virtual void TearDown()
+    {
+        source_->Close();
+        target_->Close();
+        std::remove("archive_source_db");
+        std::remove("archive_target_db");
+        std::remove("archive_file");
+    }
+
+    void FillSource(int32_t readings_per_access_point)
+    {
+        std::vector<AccessPointRssiPair> data_points;
+        AccessPoint                      ap1("ee:44:43:a5:ff:ef");
+        AccessPoint                      ap2("11:65:d4:fe:ee:ff");
+        for (int32_t i = 0; i < readings_per_access_point; ++i)
+        {
+            data_points.push_back(std::make_pair(ap1, -i));
+            data_points.push_back(std::make_pair(ap2, i));
+        }
+        source_->CreateDeviceTable("4004");
+        source_->InsertRSSIReadings("4004", data_points);
+        source_->CreateDeviceTable("1000");
+        source_->InsertRSSIReadings("1000", { std::make_pair(ap1, -42) });
+
+        source_->UpdateDeviceLocation("4004", Position{ 1.5, 2.5, 1.0 });
+        source_->AssignDeviceToEmployee("4004", "jdoe");
+        source_->InsertAccessPoints({ AccessPoint("ee:44:43:a5:ff:ef", Position{ 0.0, 4.0, 1.0 }) });
+    }
+
+    std::vector<std::string> DumpReadings(std::shared_ptr<DataStore> data_store)
+    {
+        std::vector<std::string> rows;
+        std::vector<std::string> device_ids;
+        data_store->GetDeviceIds(device_ids);
+        for (auto const& device_id : device_ids)
+        {
+            data_store->VisitReadings(device_id, [&rows, &device_id](const StoredReading& reading) {
+                rows.push_back(device_id + "|" + reading.mac_addr.str() + "|" + std::to_string(reading.rssi) + "|"
+                               + reading.timestamp);
+            });
+        }
+        return rows;
+    }
+
+    std::vector<std::string> DumpLocations(std::shared_ptr<DataStore> data_store)
+    {
+        std::vector<std::string> rows;
+        data_store->VisitLocations([&rows](const StoredLocation& location) {
+            rows.push_back(location.device_id.str() + "|" + location.employee_id + "|" + std::to_string(location.pos.x)
+                           + "|" + std::to_string(location.pos.y) + "|" + location.timestamp);
+        });
+        data_store->VisitAccessPoints([&rows](const AccessPoint& access_point) {
+            rows.push_back(access_point.mac_addr.str() + "|" + std::to_string(access_point.pos.y));
+        });
+        return rows;
+    }
+
+    // Archive holding one empty reading block of device_id.
+    void WriteReadingArchive(const std::string& device_id)
+    {
+        std::string payload(1, static_cast<char>(device_id.size()));
+        payload += device_id;
+        payload += '\0'; // no access points in the dictionary
+
+        std::ofstream file("archive_file", std::ios::binary);
+        file.write("INSARCH1", 8);
+        PutU32(file, 1);
+        file.put(3);
+        PutU32(file, 0);
+        PutU32(file, static_cast<uint32_t>(payload.size()));
+        PutU32(file, Crc32(payload.data(), payload.size()));
+        file << payload;
+        file.write("\0\0\0\0\0\0\0\0\0\0\0\0\0", 13);
+    }
+
+    void PutU32(std::ofstream& file, uint32_t value)
+    {
+        for (int i = 0; i < 4; ++i)
+            file.put(static_cast<char>(value >> (8 * i)));
+    }
+
+protected:
+    std::shared_ptr<DataStore> source_ = std::make_shared<DataStore>();
+    std::shared_ptr<DataStore> target_ = std::make_shared<DataStore>();
+};
+
+/**
+ * TEST: Export / Import
+ * EXPECT: Readings, locations and access points survive a round trip unchanged, timestamps included.
+ */
+TEST_F(DataArchiveFixture, ExportImport_WillRoundTripWholeDataset)
+{
+    FillSource(10);
+
+    EXPECT_TRUE(DataArchive(source_).Export("archive_file"));
+    EXPECT_TRUE(DataArchive(target_).Import("archive_file"));
+
+    EXPECT_EQ(21u, DumpReadings(target_).size());
+    EXPECT_EQ(DumpReadings(source_), DumpReadings(target_));
+    EXPECT_EQ(DumpLocations(source_), DumpLocations(target_));
+
+    Position pos;
+    EXPECT_TRUE(target_->GetPosition("jdoe", QueryT::EMPLOYEE, pos));
+    EXPECT_EQ(Position({ 1.5, 2.5, 1.0 }), pos);
+}
+
+/**
+ * TEST: Export / Import
+ * EXPECT: Devices with more readings than fit in one block are split and reassembled in order.
+ */
+TEST_F(DataArchiveFixture, ExportImport_WillSplitLargeTablesIntoBlocks)
+{
+    FillSource(5000);
+
+    EXPECT_TRUE(DataArchive(source_).Export("archive_file"));
+    EXPECT_TRUE(DataArchive(target_).Import("archive_file"));
+
+    EXPECT_EQ(10001u, DumpReadings(target_).size());
+    EXPECT_EQ(DumpReadings(source_), DumpReadings(target_));
+}
+
+/**
+ * TEST: Import
+ * EXPECT: A corrupted block fails its checksum and nothing from the archive is kept, so the import can be
+ *         re-run without duplicating readings.
+ */
+TEST_F(DataArchiveFixture, Import_CorruptBlock_WillRollBack)
+{
+    FillSource(5000);
+    EXPECT_TRUE(DataArchive(source_).Export("archive_file"));
+
+    std::fstream file("archive_file", std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(-20, std::ios::end);
+    file.put('\x7f');
+    file.close();
+
+    EXPECT_FALSE(DataArchive(target_).Import("archive_file"));
+    EXPECT_TRUE(DumpReadings(target_).empty());
+    EXPECT_TRUE(DumpLocations(target_).empty());
+
+    EXPECT_TRUE(DataArchive(source_).Export("archive_file"));
+    EXPECT_TRUE(DataArchive(target_).Import("archive_file"));
+    EXPECT_EQ(DumpReadings(source_), DumpReadings(target_));
+}
+
+/**
+ * TEST: Import
+ * EXPECT: Device ids that are empty, too long or not made of letters, digits and '_' are rejected before they
+ *         name a table.
+ */
+TEST_F(DataArchiveFixture, Import_InvalidDeviceId_WillFail)
+{
+    WriteReadingArchive("4004");
+    EXPECT_TRUE(DataArchive(target_).Import("archive_file"));
+
+    for (auto const& device_id : { std::string(), std::string(DeviceId::kCapacity + 1, '1'),
+                                   std::string("1 (x TEXT); DROP TABLE locations; --") })
+    {
+        WriteReadingArchive(device_id);
+        EXPECT_FALSE(DataArchive(target_).Import("archive_file"));
+    }
+
+    std::vector<std::string> device_ids;
+    EXPECT_TRUE(target_->GetDeviceIds(device_ids));
+    EXPECT_EQ(std::vector<std::string>{ "4004" }, device_ids);
+    EXPECT_TRUE(target_->UpdateDeviceLocation("4004", Position{ 1.0, 1.0, 1.0 }));
+}
+
+/**
+ * TEST: Import
+ * EXPECT: Files that are not archives, or are missing, are rejected.
+ */
+TEST_F(DataArchiveFixture, Import_NotAnArchive_WillFail)
+{
+    std::ofstream file("archive_file", std::ios::binary);
+    file << "device_id,mac_addr,rssi\n";
+    file.close();
+
+    EXPECT_FALSE(DataArchive(target_).Import("archive_file"));
+    EXPECT_FALSE(DataArchive(target_).Import("missing_archive_file"));
+}
+
+} // namespace !ins_service
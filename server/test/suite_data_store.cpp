@@ -2,6 +2,9 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <thread>
+
 #include "data_store.hpp"
 #include "stdio.h"
 
@@ -446,4 +449,140 @@ TEST_F(DataStoreFixture, GetRSSISeriesData_WillReturnRssiListVector)
     data_store_->Close();
     std::remove("db");
 }
+/**
+ * TEST: VisitDistinctAccessPoints / VisitRSSISeries
+ * EXPECT: Rows are handed to the visitor in insertion order without building a result vector.
+ */
+TEST_F(DataStoreFixture, VisitRSSISeries_WillStreamRowsToVisitor)
+{
+    data_store_->Init("db");
+    std::string                      device_id = "4004";
+    std::vector<AccessPointRssiPair> data_points;
+    AccessPoint                      ap1("ee:44:43:a5:ff:ef");
+    AccessPoint                      ap2("11:65:d4:fe:ee:ff");
+
+    for (int32_t i = 0; i < 5; ++i)
+    {
+        data_points.push_back(std::make_pair(ap1, i));
+        data_points.push_back(std::make_pair(ap2, -i));
+    }
+    data_store_->CreateDeviceTable(device_id);
+    EXPECT_TRUE(data_store_->InsertRSSIReadings(device_id, data_points));
+
+    std::vector<std::string> visited_mac_addrs;
+    EXPECT_TRUE(data_store_->VisitDistinctAccessPoints(
+        device_id, [&visited_mac_addrs](const char* mac_addr) { visited_mac_addrs.push_back(mac_addr); }));
+    std::vector<std::string> expected_mac_addrs = { ap1.mac_addr.str(), ap2.mac_addr.str() };
+    EXPECT_EQ(expected_mac_addrs, visited_mac_addrs);
+
+    int32_t count = 0;
+    int32_t sum   = 0;
+    EXPECT_TRUE(data_store_->VisitRSSISeries(device_id, ap2, [&count, &sum](int32_t rssi) {
+        ++count;
+        sum += rssi;
+    }));
+    EXPECT_EQ(5, count);
+    EXPECT_EQ(-10, sum);
+
+    EXPECT_FALSE(data_store_->VisitRSSISeries("9999", ap1, [](int32_t) {}));
+
+    data_store_->Close();
+    std::remove("db");
+}
+
+/**
+ * TEST: GetRSSISeriesData (caller-provided buffer)
+ * EXPECT: The buffer is refilled for the requested access points only, dropping stale entries.
+ */
+TEST_F(DataStoreFixture, GetRSSISeriesData_WillRefillCallerBuffer)
+{
+    data_store_->Init("db");
+    std::string                      device_id = "4004";
+    std::vector<AccessPointRssiPair> data_points;
+    AccessPoint                      ap1("ee:44:43:a5:ff:ef");
+    AccessPoint                      ap2("11:65:d4:fe:ee:ff");
+    AccessPoint                      ap3("01:23:dd:3e:4c:cc");
+
+    for (int32_t i = 0; i < 3; ++i)
+    {
+        data_points.push_back(std::make_pair(ap1, i));
+        data_points.push_back(std::make_pair(ap2, i * 10));
+        data_points.push_back(std::make_pair(ap3, i * 100));
+    }
+    data_store_->CreateDeviceTable(device_id);
+    EXPECT_TRUE(data_store_->InsertRSSIReadings(device_id, data_points));
+
+    std::vector<AccessPointRssiListPair> series{ std::make_pair(ap1, std::vector<int32_t>{ 7, 7 }),
+                                                 std::make_pair(ap2, std::vector<int32_t>{ 7 }),
+                                                 std::make_pair(ap1, std::vector<int32_t>{ 7 }) };
+
+    EXPECT_TRUE(data_store_->GetRSSISeriesData(device_id, { ap3, ap1 }, series));
+
+    std::vector<AccessPointRssiListPair> expected_series{ std::make_pair(ap3, std::vector<int32_t>{ 0, 100, 200 }),
+                                                          std::make_pair(ap1, std::vector<int32_t>{ 0, 1, 2 }) };
+    EXPECT_EQ(expected_series, series);
+
+    data_store_->Close();
+    std::remove("db");
+}
+
+/**
+ * TEST: CollectRSSISeries
+ * EXPECT: Readings are grouped per access point, in order of first appearance, inside the arena.
+ */
+TEST_F(DataStoreFixture, CollectRSSISeries_WillGroupReadingsByAccessPoint)
+{
+    data_store_->Init("db");
+    std::string device_id  = "4004";
+    RssiReading readings[] = { { "ee:44:43:a5:ff:ef", -40 }, { "11:65:d4:fe:ee:ff", -60 },
+                               { "ee:44:43:a5:ff:ef", -42 }, { "ee:44:43:a5:ff:e", -70 } };
+    data_store_->CreateDeviceTable(device_id);
+    EXPECT_TRUE(data_store_->InsertRSSIReadings(device_id, readings, 4));
+
+    Arena                   arena;
+    ArenaVector<RssiSeries> series(ArenaAllocator<RssiSeries>{ arena });
+    EXPECT_TRUE(data_store_->CollectRSSISeries(device_id, series));
+
+    ASSERT_EQ(3u, series.size());
+    EXPECT_EQ("ee:44:43:a5:ff:ef", series[0].mac_addr);
+    EXPECT_EQ((std::vector<int32_t>{ -40, -42 }), std::vector<int32_t>(series[0].rssi.begin(), series[0].rssi.end()));
+    EXPECT_EQ("11:65:d4:fe:ee:ff", series[1].mac_addr);
+    EXPECT_EQ(1u, series[1].rssi.size());
+    EXPECT_EQ("ee:44:43:a5:ff:e", series[2].mac_addr);
+    EXPECT_EQ(-70, series[2].rssi[0]);
+
+    data_store_->Close();
+    std::remove("db");
+}
+
+/**
+ * TEST: RunInTransaction
+ * EXPECT: A failing body is rolled back, while a write of another thread issued during the transaction waits
+ *         for it and is kept.
+ */
+TEST_F(DataStoreFixture, RunInTransaction_BodyFails_WillRollBackOnlyItsOwnWrites)
+{
+    data_store_->Init("db");
+    std::string device_id = "5005";
+    RssiReading own[]     = { { "ee:44:43:a5:ff:ef", -40 }, { "ee:44:43:a5:ff:ef", -42 } };
+    RssiReading other[]   = { { "11:65:d4:fe:ee:ff", -60 } };
+    data_store_->CreateDeviceTable(device_id);
+
+    std::thread writer;
+    EXPECT_FALSE(data_store_->RunInTransaction([&]() {
+        EXPECT_TRUE(data_store_->InsertRSSIReadings(device_id, own, 2));
+        writer = std::thread([&]() { EXPECT_TRUE(data_store_->InsertRSSIReadings(device_id, other, 1)); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        return false;
+    }));
+    writer.join();
+
+    std::vector<AccessPoint> access_points;
+    EXPECT_TRUE(data_store_->GetDistinctAccessPoints(device_id, access_points));
+    ASSERT_EQ(1u, access_points.size());
+    EXPECT_EQ("11:65:d4:fe:ee:ff", access_points[0].mac_addr);
+
+    data_store_->Close();
+    std::remove("db");
+}
 } // namespace !ins_service
@@ -0,0 +1,206 @@
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "device_executor.hpp"
+
+using namespace ::testing;
+
+namespace ins_service
+{
+
+class DeviceExecutorFixture : public Test
+{
+public:
+    // Device ids whose home is the given shard.
+    std::vector<DeviceId> DevicesOfShard(const DeviceExecutor& executor, size_t shard, size_t count)
+    {
+        std::vector<DeviceId> devices;
+        for (int i = 1000; devices.size() < count; ++i)
+        {
+            DeviceId device_id(std::to_string(i));
+            if (executor.ShardOf(device_id) == shard)
+                devices.push_back(device_id);
+        }
+        return devices;
+    }
+};
+
+/**
+ * TEST: Post
+ * EXPECT: Operations of one device run in submission order and never overlap.
+ */
+TEST_F(DeviceExecutorFixture, Post_SameDevice_WillRunInOrderOneAtATime)
+{
+    DeviceExecutor executor(4);
+    executor.Start();
+
+    std::vector<int> order;
+    std::atomic<int> in_flight(0);
+    std::atomic<int> overlaps(0);
+    for (int i = 0; i < 200; ++i)
+    {
+        executor.Post(DeviceId("1000"), [&order, &in_flight, &overlaps, i] {
+            if (in_flight++ != 0)
+                ++overlaps;
+            order.push_back(i);
+            in_flight--;
+        });
+    }
+    executor.Execute(DeviceId("1000"), [] {});
+    executor.Stop();
+
+    EXPECT_EQ(0, overlaps.load());
+    ASSERT_EQ(200u, order.size());
+    for (int i = 0; i < 200; ++i)
+        EXPECT_EQ(i, order[i]);
+}
+
+/**
+ * TEST: Execute
+ * EXPECT: Runs the task inline before Start() and on a shard thread afterwards, rethrowing its exceptions.
+ */
+TEST_F(DeviceExecutorFixture, Execute_WillWaitForTaskAndRethrow)
+{
+    DeviceExecutor  executor(2);
+    std::thread::id runner;
+
+    executor.Execute(DeviceId("1000"), [&runner] { runner = std::this_thread::get_id(); });
+    EXPECT_EQ(std::this_thread::get_id(), runner);
+
+    executor.Start();
+    executor.Execute(DeviceId("1000"), [&runner] { runner = std::this_thread::get_id(); });
+    EXPECT_NE(std::this_thread::get_id(), runner);
+
+    EXPECT_THROW(executor.Execute(DeviceId("1000"), [] { throw std::runtime_error("failed"); }),
+                 std::runtime_error);
+    // Only operations dispatched to the shards are counted.
+    EXPECT_EQ(2u, executor.GetStats().executed);
+}
+
+/**
+ * TEST: Work stealing
+ * EXPECT: Devices queued on one busy shard are picked up by the idle shards.
+ */
+TEST_F(DeviceExecutorFixture, BusyShard_WillHaveDevicesStolen)
+{
+    DeviceExecutor executor(4);
+    executor.Start();
+
+    std::mutex                lock;
+    std::set<std::thread::id> runners;
+    std::vector<DeviceId>     devices = DevicesOfShard(executor, 0, 8);
+    for (auto const& device_id : devices)
+    {
+        executor.Post(device_id, [&lock, &runners] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            std::lock_guard<std::mutex> guard(lock);
+            runners.insert(std::this_thread::get_id());
+        });
+    }
+    for (auto const& device_id : devices)
+        executor.Execute(device_id, [] {});
+
+    EXPECT_GT(runners.size(), 1u);
+    EXPECT_GT(executor.GetStats().stolen, 0u);
+}
+
+/**
+ * TEST: Actors
+ * EXPECT: Actors only live while their device has operations queued, later posts of a device get a new one.
+ */
+TEST_F(DeviceExecutorFixture, Actors_MailboxDrained_WillBeDropped)
+{
+    DeviceExecutor executor(2);
+    executor.Start();
+
+    std::atomic<int> ran(0);
+    for (int i = 0; i < 100; ++i)
+        executor.Post(DeviceId(std::to_string(1000 + i)), [&ran] { ++ran; });
+    executor.Stop();
+    EXPECT_EQ(100, ran.load());
+    EXPECT_EQ(0u, executor.GetStats().actors);
+
+    executor.Start();
+    executor.Execute(DeviceId("1000"), [&ran] { ++ran; });
+    executor.Stop();
+    EXPECT_EQ(101, ran.load());
+    EXPECT_EQ(0u, executor.GetStats().actors);
+}
+
+/**
+ * TEST: TryPost
+ * EXPECT: Operations beyond the pending limit are rejected until the shards catch up.
+ */
+TEST_F(DeviceExecutorFixture, TryPost_TooManyPending_WillReject)
+{
+    DeviceExecutor executor(1, 2);
+    executor.Start();
+
+    std::mutex              lock;
+    std::condition_variable released_cv;
+    bool                    released = false;
+    auto                    blocked  = [&lock, &released_cv, &released] {
+        std::unique_lock<std::mutex> guard(lock);
+        released_cv.wait(guard, [&released] { return released; });
+    };
+    EXPECT_TRUE(executor.TryPost(DeviceId("1000"), blocked));
+    EXPECT_TRUE(executor.TryPost(DeviceId("2000"), [] {}));
+    EXPECT_FALSE(executor.TryPost(DeviceId("3000"), [] {}));
+    EXPECT_EQ(2u, executor.GetStats().pending);
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        released = true;
+    }
+    released_cv.notify_all();
+    executor.Stop();
+    EXPECT_EQ(0u, executor.GetStats().pending);
+}
+
+/**
+ * TEST: TryPost
+ * EXPECT: A throwing operation is logged and dropped; the shard keeps running the device's next operations.
+ */
+TEST_F(DeviceExecutorFixture, TryPost_TaskThrows_WillKeepShardRunning)
+{
+    DeviceExecutor executor(1);
+    executor.Start();
+
+    EXPECT_TRUE(executor.TryPost(DeviceId("1000"), [] { throw std::runtime_error("handler failed"); }));
+    EXPECT_TRUE(executor.TryPost(DeviceId("1000"), [] { throw 42; }));
+    bool ran = false;
+    executor.Execute(DeviceId("1000"), [&ran] { ran = true; });
+
+    executor.Stop();
+
+    EXPECT_TRUE(ran);
+    EXPECT_EQ(0u, executor.GetStats().pending);
+}
+
+/**
+ * TEST: Stop
+ * EXPECT: Operations still queued when the executor stops are run, not dropped.
+ */
+TEST_F(DeviceExecutorFixture, Stop_WillRunQueuedOperations)
+{
+    DeviceExecutor   executor(2);
+    std::atomic<int> executed(0);
+
+    for (int i = 0; i < 50; ++i)
+        executor.Post(DeviceId(std::to_string(i)), [&executed] { ++executed; });
+    executor.Stop();
+    EXPECT_EQ(50, executed.load());
+}
+
+} // namespace ins_service
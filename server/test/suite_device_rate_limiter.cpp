@@ -0,0 +1,107 @@
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "device_rate_limiter.hpp"
+
+using namespace ::testing;
+
+namespace ins_service
+{
+
+class DeviceRateLimiterFixture : public Test
+{
+protected:
+    size_t StripeBuckets(const DeviceRateLimiter& limiter, const DeviceId& device_id)
+    {
+        return limiter.StripeOf(device_id).buckets.size();
+    }
+
+    const void* StripeOf(const DeviceRateLimiter& limiter, const DeviceId& device_id)
+    {
+        return &limiter.StripeOf(device_id);
+    }
+
+    DeviceRateLimiter::Clock::time_point start_ = DeviceRateLimiter::Clock::now();
+};
+
+/**
+ * TEST: TryAcquire
+ * EXPECT: A device gets its burst right away, then one upload per 1 / rate seconds.
+ */
+TEST_F(DeviceRateLimiterFixture, TryAcquire_OverRate_WillThrottle)
+{
+    DeviceRateLimiter limiter(2, 3);
+    DeviceId          device_id("1000");
+
+    for (int i = 0; i < 3; ++i)
+        EXPECT_TRUE(limiter.TryAcquire(device_id, start_));
+    EXPECT_FALSE(limiter.TryAcquire(device_id, start_));
+    EXPECT_FALSE(limiter.TryAcquire(device_id, start_ + std::chrono::milliseconds(400)));
+    EXPECT_TRUE(limiter.TryAcquire(device_id, start_ + std::chrono::milliseconds(500)));
+    EXPECT_FALSE(limiter.TryAcquire(device_id, start_ + std::chrono::milliseconds(500)));
+
+    EXPECT_EQ(3u, limiter.Throttled(device_id));
+    EXPECT_EQ(3u, limiter.Throttled());
+    EXPECT_EQ(1u, limiter.RetryAfter());
+}
+
+/**
+ * TEST: TryAcquire
+ * EXPECT: Devices have buckets of their own, a flooding device does not throttle the others.
+ */
+TEST_F(DeviceRateLimiterFixture, TryAcquire_FloodingDevice_WillNotThrottleOthers)
+{
+    DeviceRateLimiter limiter(1, 1);
+
+    EXPECT_TRUE(limiter.TryAcquire(DeviceId("1000"), start_));
+    for (int i = 0; i < 100; ++i)
+        EXPECT_FALSE(limiter.TryAcquire(DeviceId("1000"), start_));
+    EXPECT_TRUE(limiter.TryAcquire(DeviceId("2000"), start_));
+    EXPECT_EQ(0u, limiter.Throttled(DeviceId("2000")));
+
+    DeviceRateLimiter unlimited(0, 1);
+    for (int i = 0; i < 100; ++i)
+        EXPECT_TRUE(unlimited.TryAcquire(DeviceId("1000"), start_));
+    EXPECT_EQ(0u, unlimited.BucketCount());
+}
+
+/**
+ * TEST: TryAcquire
+ * EXPECT: Once a stripe is full, buckets of quiet devices are dropped and busy ones are kept.
+ */
+TEST_F(DeviceRateLimiterFixture, TryAcquire_FullStripe_WillDropQuietDevices)
+{
+    DeviceRateLimiter limiter(1, 2);
+    DeviceId          busy("1000");
+    EXPECT_TRUE(limiter.TryAcquire(busy, start_));
+
+    // Only devices sharing the stripe of the busy one count towards its limit.
+    for (int i = 0; StripeBuckets(limiter, busy) < DeviceRateLimiter::kMaxBucketsPerStripe; ++i)
+    {
+        DeviceId device_id(std::to_string(2000 + i).c_str());
+        if (StripeOf(limiter, device_id) == StripeOf(limiter, busy))
+        {
+            EXPECT_TRUE(limiter.TryAcquire(device_id, start_ + std::chrono::seconds(1)));
+        }
+    }
+    EXPECT_EQ(DeviceRateLimiter::kMaxBucketsPerStripe, limiter.BucketCount());
+
+    // One second later the other devices are full again, the busy one still misses a token.
+    EXPECT_TRUE(limiter.TryAcquire(busy, start_ + std::chrono::seconds(1)));
+    EXPECT_TRUE(limiter.TryAcquire(busy, start_ + std::chrono::seconds(1)));
+
+    DeviceId newcomer;
+    for (int i = 0;; ++i)
+    {
+        newcomer = DeviceId(("new" + std::to_string(i)).c_str());
+        if (StripeOf(limiter, newcomer) == StripeOf(limiter, busy))
+            break;
+    }
+    EXPECT_TRUE(limiter.TryAcquire(newcomer, start_ + std::chrono::seconds(2)));
+    EXPECT_EQ(2u, StripeBuckets(limiter, busy));
+}
+
+} // namespace ins_service
@@ -0,0 +1,182 @@
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+#include "device_registry.hpp"
+
+extern "C"
+{
+#include <InsNodePool.h>
+}
+
+extern insNode_t* insNoderoot;
+
+using namespace ::testing;
+
+namespace ins_service
+{
+
+class DeviceRegistryFixture : public Test
+{
+public:
+    virtual void SetUp()
+    {
+        device_registry_.reset(new DeviceRegistry(2, "registry_spill"));
+        device_registry_->Init();
+    }
+
+    virtual void TearDown()
+    {
+        auto node = static_cast<insNode_t*>(insNoderoot->next);
+        while (node != NULL)
+        {
+            auto next = static_cast<insNode_t*>(node->next);
+            insNodePoolFree(node);
+            node = next;
+        }
+        insNoderoot->next = NULL;
+        device_registry_.reset();
+    }
+
+    std::vector<std::string> ResidentDevices()
+    {
+        std::vector<std::string> device_ids;
+        for (auto node = static_cast<insNode_t*>(insNoderoot->next); node != NULL;
+             node      = static_cast<insNode_t*>(node->next))
+            device_ids.push_back(node->devName);
+        std::sort(device_ids.begin(), device_ids.end());
+        return device_ids;
+    }
+
+    std::list<DeviceId>& Lru()
+    {
+        return device_registry_->lru_;
+    }
+
+protected:
+    std::unique_ptr<DeviceRegistry> device_registry_;
+};
+
+/**
+ * TEST: Acquire
+ * EXPECT: Acquiring a known device returns the same node and marks it most recently active.
+ */
+TEST_F(DeviceRegistryFixture, Acquire_KnownDevice_WillReturnSameNode)
+{
+    insNode_t* node = device_registry_->Acquire("1000");
+    ASSERT_TRUE(node != NULL);
+    device_registry_->Acquire("2000");
+
+    EXPECT_EQ(node, device_registry_->Acquire("1000"));
+    EXPECT_EQ("1000", Lru().front());
+    EXPECT_EQ(2u, device_registry_->ResidentCount());
+}
+
+/**
+ * TEST: Acquire
+ * EXPECT: Going over budget spills the least recently active device and frees its node.
+ */
+TEST_F(DeviceRegistryFixture, Acquire_OverBudget_WillSpillLeastRecentlyActive)
+{
+    device_registry_->Acquire("1000");
+    device_registry_->Acquire("2000");
+    device_registry_->Acquire("1000");
+    device_registry_->Acquire("3000");
+
+    std::vector<std::string> expected = { "1000", "3000" };
+    EXPECT_EQ(expected, ResidentDevices());
+    EXPECT_EQ(2u, device_registry_->ResidentCount());
+    EXPECT_EQ(1u, device_registry_->SpilledCount());
+}
+
+/**
+ * TEST: Acquire
+ * EXPECT: A spilled device is rehydrated with the state it had when it was evicted.
+ */
+TEST_F(DeviceRegistryFixture, Acquire_SpilledDevice_WillRehydrateState)
+{
+    insNode_t* node                                                  = device_registry_->Acquire("1000");
+    node->nodeCartPosition[0]                                        = 3.0f;
+    node->wifiAccessPointNode[2].wifiInitParams.initialErrorEstimate = 0.25f;
+    device_registry_->Acquire("2000");
+    device_registry_->Acquire("3000");
+    EXPECT_TRUE(findWifiNode(insNoderoot, "1000") == NULL);
+
+    node = device_registry_->Acquire("1000");
+    ASSERT_TRUE(node != NULL);
+    EXPECT_FLOAT_EQ(3.0f, node->nodeCartPosition[0]);
+    EXPECT_FLOAT_EQ(0.25f, node->wifiAccessPointNode[2].wifiInitParams.initialErrorEstimate);
+    EXPECT_TRUE(node->filterProcess == kalmanProcess);
+    EXPECT_EQ(2u, device_registry_->ResidentCount());
+    EXPECT_EQ(1u, device_registry_->SpilledCount());
+}
+
+/**
+ * TEST: Acquire / Unpin
+ * EXPECT: Pinned devices are skipped by eviction until they are unpinned.
+ */
+TEST_F(DeviceRegistryFixture, Acquire_PinnedDevice_WillNotBeEvicted)
+{
+    device_registry_->Acquire("1000", true);
+    device_registry_->Acquire("2000");
+    device_registry_->Acquire("3000");
+
+    std::vector<std::string> expected = { "1000", "3000" };
+    EXPECT_EQ(expected, ResidentDevices());
+
+    device_registry_->Unpin("1000");
+    device_registry_->Acquire("4000");
+    expected = { "3000", "4000" };
+    EXPECT_EQ(expected, ResidentDevices());
+}
+
+/**
+ * TEST: Touch
+ * EXPECT: Resident devices are marked most recently active and pinned, others are left to Acquire().
+ */
+TEST_F(DeviceRegistryFixture, Touch_WillOnlyMoveResidentDevices)
+{
+    device_registry_->Acquire("1000");
+    device_registry_->Acquire("2000");
+
+    EXPECT_TRUE(device_registry_->Touch("1000", true));
+    EXPECT_EQ("1000", Lru().front());
+    EXPECT_FALSE(device_registry_->Touch("3000"));
+    EXPECT_EQ(2u, device_registry_->ResidentCount());
+
+    device_registry_->Acquire("3000");
+    std::vector<std::string> expected = { "1000", "3000" };
+    EXPECT_EQ(expected, ResidentDevices());
+}
+
+/**
+ * TEST: VisitRecords
+ * EXPECT: Resident and spilled devices are all visited, resident ones most recent first and under the
+ *         engine lock, spilled ones after it is released.
+ */
+TEST_F(DeviceRegistryFixture, VisitRecords_WillVisitResidentAndSpilledDevices)
+{
+    device_registry_->Acquire("1000");
+    device_registry_->Acquire("2000");
+    device_registry_->Acquire("3000");
+
+    std::shared_timed_mutex  engine_lock;
+    std::vector<std::string> visited;
+    std::vector<bool>        engine_locked;
+    device_registry_->VisitRecords(engine_lock, [&](const DeviceRecord& record) {
+        visited.push_back(record.dev_name);
+        bool released = engine_lock.try_lock_shared();
+        if (released)
+            engine_lock.unlock_shared();
+        engine_locked.push_back(!released);
+    });
+
+    std::vector<std::string> expected        = { "3000", "2000", "1000" };
+    std::vector<bool>        expected_locked = { true, true, false };
+    EXPECT_EQ(expected, visited);
+    EXPECT_EQ(expected_locked, engine_locked);
+}
+
+} // namespace !ins_service
@@ -0,0 +1,195 @@
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include "employee_index.hpp"
+
+using namespace ::testing;
+
+namespace ins_service
+{
+
+class EmployeeIndexFixture : public Test
+{
+public:
+    virtual void SetUp()
+    {
+        index_.Insert("jdoe");
+        index_.Insert("jdavis");
+        index_.Insert("asmith", "Anna Smith");
+        index_.Insert("8923");
+    }
+
+    // Nodes of the trie below the root.
+    size_t TrieNodes(const EmployeeIndex& index)
+    {
+        size_t                                      nodes = 0;
+        std::vector<const EmployeeIndex::TrieNode*> pending(1, index.root_.get());
+        while (!pending.empty())
+        {
+            const EmployeeIndex::TrieNode* node = pending.back();
+            pending.pop_back();
+            for (auto const& child : node->children)
+            {
+                pending.push_back(child.get());
+                ++nodes;
+            }
+        }
+        return nodes;
+    }
+
+    std::vector<std::string> Ids(const std::vector<EmployeeMatch>& matches)
+    {
+        std::vector<std::string> ids;
+        for (auto const& match : matches)
+            ids.push_back(match.employee_id);
+        return ids;
+    }
+
+protected:
+    EmployeeIndex index_;
+};
+
+/**
+ * TEST: Search
+ * EXPECT: Every employee id starting with the query is returned, shortest completion first.
+ */
+TEST_F(EmployeeIndexFixture, Search_Prefix_WillReturnAllCompletionsRanked)
+{
+    std::vector<std::string> expected_ids = { "jdoe", "jdavis" };
+    EXPECT_EQ(expected_ids, Ids(index_.Search("jd", 10)));
+}
+
+/**
+ * TEST: Search
+ * EXPECT: An exact id scores 1.0 and ranks first.
+ */
+TEST_F(EmployeeIndexFixture, Search_ExactId_WillRankFirstWithFullScore)
+{
+    auto matches = index_.Search("8923", 10);
+    ASSERT_FALSE(matches.empty());
+    EXPECT_EQ("8923", matches[0].employee_id);
+    EXPECT_DOUBLE_EQ(1.0, matches[0].score);
+}
+
+/**
+ * TEST: Search
+ * EXPECT: Names are indexed case-insensitively and resolve to the employee id.
+ */
+TEST_F(EmployeeIndexFixture, Search_ByName_WillReturnEmployeeId)
+{
+    std::vector<std::string> expected_ids = { "asmith" };
+    EXPECT_EQ(expected_ids, Ids(index_.Search("anna", 10)));
+}
+
+/**
+ * TEST: Search
+ * EXPECT: Misspelled queries fall back to trigram matching, ranked below any prefix match.
+ */
+TEST_F(EmployeeIndexFixture, Search_Misspelled_WillReturnFuzzyMatch)
+{
+    auto matches = index_.Search("Ana Smiht", 10);
+    ASSERT_FALSE(matches.empty());
+    EXPECT_EQ("asmith", matches[0].employee_id);
+    EXPECT_LE(matches[0].score, 0.5);
+}
+
+/**
+ * TEST: Search
+ * EXPECT: The number of matches is bounded by max_results.
+ */
+TEST_F(EmployeeIndexFixture, Search_WillHonourMaxResults)
+{
+    EXPECT_EQ(1u, index_.Search("j", 1).size());
+    EXPECT_TRUE(index_.Search("j", 0).empty());
+    EXPECT_TRUE(index_.Search("   ", 10).empty());
+}
+
+/**
+ * TEST: Search
+ * EXPECT: The best prefix matches are returned however many longer keys come first in the trie.
+ */
+TEST_F(EmployeeIndexFixture, Search_ManyLongerKeys_WillReturnShortestCompletions)
+{
+    for (int i = 0; i < 100; ++i)
+        index_.Insert("ka" + std::to_string(1000 + i));
+    index_.Insert("kb");
+    index_.Insert("kz");
+
+    std::vector<std::string> expected_ids = { "kb", "kz" };
+    EXPECT_EQ(expected_ids, Ids(index_.Search("k", 2)));
+}
+
+/**
+ * TEST: Remove
+ * EXPECT: Removing keys prunes the trie back to the shape their insertion left it in.
+ */
+TEST_F(EmployeeIndexFixture, Remove_WillPruneTrie)
+{
+    size_t nodes = TrieNodes(index_);
+    for (int i = 0; i < 20; ++i)
+        index_.Insert("jdo" + std::to_string(i), "John Doe " + std::to_string(i));
+    for (int i = 0; i < 20; ++i)
+        index_.Remove("jdo" + std::to_string(i));
+
+    EXPECT_EQ(nodes, TrieNodes(index_));
+    std::vector<std::string> expected_ids = { "jdoe", "jdavis" };
+    EXPECT_EQ(expected_ids, Ids(index_.Search("jd", 10)));
+}
+
+/**
+ * TEST: Remove
+ * EXPECT: Removed employees are no longer returned and re-inserting them works.
+ */
+TEST_F(EmployeeIndexFixture, Remove_WillDropEmployeeFromResults)
+{
+    index_.Remove("jdoe");
+    EXPECT_EQ(3u, index_.Size());
+    std::vector<std::string> expected_ids = { "jdavis" };
+    EXPECT_EQ(expected_ids, Ids(index_.Search("jd", 10)));
+
+    index_.Insert("jdoe");
+    EXPECT_EQ(4u, index_.Size());
+    EXPECT_EQ(2u, index_.Search("jd", 10).size());
+}
+
+/**
+ * TEST: Insert
+ * EXPECT: Inserting an existing employee replaces its name instead of duplicating it.
+ */
+TEST_F(EmployeeIndexFixture, Insert_Existing_WillReplaceName)
+{
+    index_.Insert("asmith", "Anne Smythe");
+    EXPECT_EQ(4u, index_.Size());
+    auto stale = index_.Search("anna", 10);
+    ASSERT_FALSE(stale.empty());
+    EXPECT_LE(stale[0].score, 0.5);
+    std::vector<std::string> expected_ids = { "asmith" };
+    EXPECT_EQ(expected_ids, Ids(index_.Search("anne", 10)));
+}
+
+/**
+ * TEST: Insert
+ * EXPECT: Concurrent inserts of the same employee leave a single entry.
+ */
+TEST_F(EmployeeIndexFixture, Insert_Concurrent_WillKeepOneEntry)
+{
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([this] {
+            for (int i = 0; i < 500; ++i)
+                index_.Insert("mlopez", "Maria Lopez");
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    EXPECT_EQ(5u, index_.Size());
+    std::vector<std::string> expected_ids = { "mlopez" };
+    EXPECT_EQ(expected_ids, Ids(index_.Search("mlopez", 10)));
+}
+
+} // namespace !ins_service
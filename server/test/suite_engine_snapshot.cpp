@@ -0,0 +1,184 @@
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <fstream>
+
+#include "engine_snapshot.hpp"
+
+extern "C"
+{
+#include <InsNodePool.h>
+}
+
+extern insNode_t* insNoderoot;
+
+using namespace ::testing;
+
+namespace ins_service
+{
+
+class EngineSnapshotFixture : public Test
+{
+public:
+    virtual void SetUp()
+    {
+        ClearEngine();
+    }
+
+    virtual void TearDown()
+    {
+        ClearEngine();
+        device_registry_.reset();
+        std::remove("engine_snapshot");
+    }
+
+    // Drops every device, as if the service had been restarted.
+    void ClearEngine()
+    {
+        auto node = static_cast<insNode_t*>(insNoderoot->next);
+        while (node != NULL)
+        {
+            auto next = static_cast<insNode_t*>(node->next);
+            insNodePoolFree(node);
+            node = next;
+        }
+        insNoderoot->next = NULL;
+
+        device_registry_.reset();
+        device_registry_.reset(new DeviceRegistry(2, "engine_spill"));
+        device_registry_->Init();
+    }
+
+    insNode_t* AddDevice(const char* device_id, float x, float y, float error_estimate)
+    {
+        insNode_t* node           = device_registry_->Acquire(device_id);
+        node->nodeCartPosition[0] = x;
+        node->nodeCartPosition[1] = y;
+        node->nodeCartPosition[2] = 1.0f;
+        node->wifiAccessPointNode[0].wifiInitParams.initialErrorEstimate = error_estimate;
+        node->wifiAccessPointNode[0].pathLoss.powerdo                    = -14.5f;
+        return node;
+    }
+
+    size_t CountDevices()
+    {
+        size_t count = 0;
+        for (auto node = static_cast<insNode_t*>(insNoderoot->next); node != NULL;
+             node      = static_cast<insNode_t*>(node->next))
+            ++count;
+        return count;
+    }
+
+protected:
+    EngineSnapshot                  engine_snapshot_;
+    std::shared_timed_mutex         engine_lock_;
+    std::unique_ptr<DeviceRegistry> device_registry_;
+};
+
+/**
+ * TEST: Save / Restore
+ * EXPECT: Devices come back with their positions, filter state and processing callbacks.
+ */
+TEST_F(EngineSnapshotFixture, SaveRestore_WillRebuildDeviceList)
+{
+    AddDevice("1000", 3.0f, 4.0f, 2.5f);
+    AddDevice("4004", 7.0f, 1.5f, 0.5f);
+    EXPECT_TRUE(engine_snapshot_.Save("engine_snapshot", engine_lock_, *device_registry_));
+
+    ClearEngine();
+    EXPECT_TRUE(engine_snapshot_.Restore("engine_snapshot", engine_lock_, *device_registry_));
+    EXPECT_EQ(2u, CountDevices());
+
+    insNode_t* node = findWifiNode(insNoderoot, "4004");
+    ASSERT_TRUE(node != NULL);
+    EXPECT_FLOAT_EQ(7.0f, node->nodeCartPosition[0]);
+    EXPECT_FLOAT_EQ(1.5f, node->nodeCartPosition[1]);
+    EXPECT_FLOAT_EQ(0.5f, node->wifiAccessPointNode[0].wifiInitParams.initialErrorEstimate);
+    EXPECT_FLOAT_EQ(-14.5f, node->wifiAccessPointNode[0].pathLoss.powerdo);
+    EXPECT_TRUE(node->filterProcess == kalmanProcess);
+    EXPECT_TRUE(node->trilaterationProcess == trilateration_process);
+}
+
+/**
+ * TEST: Save / Restore
+ * EXPECT: Spilled devices are saved too and restored beyond the resident budget are spilled again.
+ */
+TEST_F(EngineSnapshotFixture, SaveRestore_WillKeepSpilledDevices)
+{
+    AddDevice("1000", 3.0f, 4.0f, 2.5f);
+    AddDevice("2000", 5.0f, 4.0f, 1.5f);
+    AddDevice("4004", 7.0f, 1.5f, 0.5f);
+    EXPECT_EQ(1u, device_registry_->SpilledCount());
+    EXPECT_TRUE(engine_snapshot_.Save("engine_snapshot", engine_lock_, *device_registry_));
+
+    ClearEngine();
+    EXPECT_TRUE(engine_snapshot_.Restore("engine_snapshot", engine_lock_, *device_registry_));
+    EXPECT_EQ(2u, CountDevices());
+    EXPECT_EQ(1u, device_registry_->SpilledCount());
+
+    insNode_t* node = device_registry_->Acquire("1000");
+    ASSERT_TRUE(node != NULL);
+    EXPECT_FLOAT_EQ(3.0f, node->nodeCartPosition[0]);
+    EXPECT_FLOAT_EQ(2.5f, node->wifiAccessPointNode[0].wifiInitParams.initialErrorEstimate);
+}
+
+/**
+ * TEST: Restore
+ * EXPECT: Devices that are already registered are updated in place instead of duplicated.
+ */
+TEST_F(EngineSnapshotFixture, Restore_ExistingDevice_WillUpdateInPlace)
+{
+    AddDevice("1000", 3.0f, 4.0f, 2.5f);
+    EXPECT_TRUE(engine_snapshot_.Save("engine_snapshot", engine_lock_, *device_registry_));
+
+    ClearEngine();
+    insNode_t* node = AddDevice("1000", 0.0f, 0.0f, 20.0f);
+    EXPECT_TRUE(engine_snapshot_.Restore("engine_snapshot", engine_lock_, *device_registry_));
+
+    EXPECT_EQ(1u, CountDevices());
+    EXPECT_FLOAT_EQ(3.0f, node->nodeCartPosition[0]);
+    EXPECT_FLOAT_EQ(2.5f, node->wifiAccessPointNode[0].wifiInitParams.initialErrorEstimate);
+}
+
+/**
+ * TEST: Restore
+ * EXPECT: A corrupted snapshot is rejected and the device list is left alone.
+ */
+TEST_F(EngineSnapshotFixture, Restore_CorruptSnapshot_WillFail)
+{
+    AddDevice("1000", 3.0f, 4.0f, 2.5f);
+    EXPECT_TRUE(engine_snapshot_.Save("engine_snapshot", engine_lock_, *device_registry_));
+    ClearEngine();
+
+    std::fstream file("engine_snapshot", std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(-4, std::ios::end);
+    file.put('\x7f');
+    file.close();
+
+    EXPECT_FALSE(engine_snapshot_.Restore("engine_snapshot", engine_lock_, *device_registry_));
+    EXPECT_EQ(0u, CountDevices());
+}
+
+/**
+ * TEST: Restore
+ * EXPECT: Missing, truncated and foreign files are rejected.
+ */
+TEST_F(EngineSnapshotFixture, Restore_InvalidFile_WillFail)
+{
+    EXPECT_FALSE(engine_snapshot_.Restore("engine_snapshot", engine_lock_, *device_registry_));
+
+    AddDevice("1000", 3.0f, 4.0f, 2.5f);
+    EXPECT_TRUE(engine_snapshot_.Save("engine_snapshot", engine_lock_, *device_registry_));
+    ClearEngine();
+    EXPECT_EQ(0, truncate("engine_snapshot", 100));
+    EXPECT_FALSE(engine_snapshot_.Restore("engine_snapshot", engine_lock_, *device_registry_));
+
+    std::ofstream file("engine_snapshot", std::ios::binary | std::ios::trunc);
+    file << "not a snapshot at all, just some text";
+    file.close();
+    EXPECT_FALSE(engine_snapshot_.Restore("engine_snapshot", engine_lock_, *device_registry_));
+    EXPECT_EQ(0u, CountDevices());
+}
+
+} // namespace !ins_service
@@ -0,0 +1,125 @@
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+extern "C"
+{
+#include <InsNodePool.h>
+}
+
+using namespace ::testing;
+
+namespace ins_service
+{
+
+class InsNodePoolFixture : public Test
+{
+public:
+    virtual void TearDown()
+    {
+        for (auto node : nodes_)
+            insNodePoolFree(node);
+        nodes_.clear();
+        EXPECT_EQ(0u, insNodePoolDestroy());
+    }
+
+    insNode_t* Alloc()
+    {
+        insNode_t* node = insNodePoolAlloc();
+        if (node != NULL)
+            nodes_.push_back(node);
+        return node;
+    }
+
+    void Free(insNode_t* node)
+    {
+        nodes_.erase(std::find(nodes_.begin(), nodes_.end(), node));
+        EXPECT_EQ(0u, insNodePoolFree(node));
+    }
+
+    insNodePoolStats_t Stats()
+    {
+        insNodePoolStats_t stats;
+        insNodePoolGetStats(&stats);
+        return stats;
+    }
+
+protected:
+    std::vector<insNode_t*> nodes_;
+};
+
+/**
+ * TEST: insNodePoolAlloc
+ * EXPECT: A released block is handed out again before the pool grows.
+ */
+TEST_F(InsNodePoolFixture, Alloc_WillReuseReleasedBlocks)
+{
+    insNode_t* node = Alloc();
+    ASSERT_TRUE(node != NULL);
+    std::strcpy(node->devName, "4004");
+    node->nodeCartPosition[0] = 3.0f;
+    Free(node);
+
+    insNode_t* reused = Alloc();
+    EXPECT_EQ(node, reused);
+    EXPECT_EQ(1u, Stats().slabs);
+}
+
+/**
+ * TEST: insNodePoolAlloc
+ * EXPECT: The pool grows one slab at a time and keeps track of its usage.
+ */
+TEST_F(InsNodePoolFixture, Alloc_WillGrowBySlabAndTrackUsage)
+{
+    EXPECT_EQ(0u, insNodePoolInit(2, 0));
+    insNode_t* first  = Alloc();
+    insNode_t* second = Alloc();
+    insNode_t* third  = Alloc();
+    ASSERT_TRUE(first != NULL && second != NULL && third != NULL);
+    Free(second);
+
+    insNodePoolStats_t stats = Stats();
+    EXPECT_EQ(2u, stats.slabs);
+    EXPECT_EQ(4u, stats.capacity);
+    EXPECT_EQ(2u, stats.inUse);
+    EXPECT_EQ(3u, stats.highWater);
+    EXPECT_EQ(3u, stats.allocations);
+    EXPECT_EQ(1u, stats.releases);
+}
+
+/**
+ * TEST: insNodePoolInit
+ * EXPECT: Pre-faulting grows the pool up front, allocations then need no new slab.
+ */
+TEST_F(InsNodePoolFixture, Init_WithPrefault_WillGrowPoolUpFront)
+{
+    EXPECT_EQ(0u, insNodePoolInit(4, 6));
+    EXPECT_EQ(2u, Stats().slabs);
+    EXPECT_EQ(8u, Stats().capacity);
+
+    for (int i = 0; i < 6; ++i)
+        ASSERT_TRUE(Alloc() != NULL);
+    EXPECT_EQ(2u, Stats().slabs);
+}
+
+/**
+ * TEST: insNodePoolFree / insNodePoolDestroy
+ * EXPECT: Foreign blocks are rejected and the pool cannot be destroyed while blocks are in use.
+ */
+TEST_F(InsNodePoolFixture, Free_ForeignBlock_WillFail)
+{
+    insNode_t  foreign;
+    insNode_t* node = Alloc();
+    ASSERT_TRUE(node != NULL);
+
+    EXPECT_NE(0u, insNodePoolFree(&foreign));
+    EXPECT_NE(0u, insNodePoolFree(reinterpret_cast<insNode_t*>(reinterpret_cast<char*>(node) + 8)));
+    EXPECT_NE(0u, insNodePoolDestroy());
+    EXPECT_EQ(1u, Stats().inUse);
+}
+
+} // namespace !ins_service
@@ -4,6 +4,8 @@
 
 #include "ins_service.hpp"
 #include "mock_data_store.hpp"
+#include "mock_device_registry.hpp"
+#include "mock_engine_snapshot.hpp"
 #include "mock_lib_wrapper.hpp"
 #include "mock_localization.hpp"
 
@@ -17,8 +19,10 @@ class IndoorNavigationServiceFixture : public Test
 public:
     virtual void SetUp()
     {
-        g_mocked_data_store_  = &mock_data_store_;
-        g_mocked_lib_wrapper_ = &mock_lib_wrapper_;
+        g_mocked_data_store_      = &mock_data_store_;
+        g_mocked_lib_wrapper_     = &mock_lib_wrapper_;
+        g_mocked_engine_snapshot_ = &mock_engine_snapshot_;
+        g_mocked_device_registry_ = &mock_device_registry_;
         //spdlog::set_level(spdlog::level::debug);
     }
 
@@ -34,9 +38,11 @@ public:
 
 
 protected:
-    NiceMock<MockDataStore>  mock_data_store_;
-    NiceMock<MockLibWrapper> mock_lib_wrapper_;
-    IndoorNavigationService  ins_service_;
+    NiceMock<MockDataStore>      mock_data_store_;
+    NiceMock<MockLibWrapper>     mock_lib_wrapper_;
+    NiceMock<MockEngineSnapshot> mock_engine_snapshot_;
+    NiceMock<MockDeviceRegistry> mock_device_registry_;
+    IndoorNavigationService      ins_service_;
 };
 
 /*
@@ -98,4 +104,69 @@ TEST_F(IndoorNavigationServiceFixture, Shutdown_WillCloseDatabaseAndShutdownHttp
     ins_service_.Shutdown();
 }
 
+/**
+ * TEST: Init
+ * EXPECT: Restore the engine snapshot before serving
+ */
+TEST_F(IndoorNavigationServiceFixture, Init_WillRestoreEngineSnapshot)
+{
+    ServiceOptions options;
+    options.snapshot_file = "engine_snapshot";
+    EXPECT_CALL(mock_engine_snapshot_, Restore("engine_snapshot", _, _)).Times(1);
+
+    Pistache::Port    port(9080);
+    Pistache::Address addr(Pistache::Ipv4::any(), port);
+    ins_service_.Init(addr, 3, options);
+}
+
+/**
+ * TEST: Shutdown service
+ * EXPECT: Save the engine snapshot once the periodic snapshots are stopped
+ */
+TEST_F(IndoorNavigationServiceFixture, Shutdown_WillSaveEngineSnapshot)
+{
+    ServiceOptions options;
+    options.snapshot_file = "engine_snapshot";
+    EXPECT_CALL(mock_engine_snapshot_, Save("engine_snapshot", _, _)).Times(1);
+
+    Pistache::Port    port(9080);
+    Pistache::Address addr(Pistache::Ipv4::any(), port);
+    ins_service_.Init(addr, 3, options);
+    ins_service_.Start();
+    ins_service_.Shutdown();
+}
+
+/**
+ * TEST: Init
+ * EXPECT: Initialize the device registry before restoring the engine snapshot
+ */
+TEST_F(IndoorNavigationServiceFixture, Init_WillInitDeviceRegistryBeforeRestore)
+{
+    InSequence sequence;
+    EXPECT_CALL(mock_device_registry_, Init()).Times(1);
+    EXPECT_CALL(mock_engine_snapshot_, Restore(_, _, _)).Times(1);
+
+    Pistache::Port    port(9080);
+    Pistache::Address addr(Pistache::Ipv4::any(), port);
+    ins_service_.Init(addr, 3);
+}
+
+/**
+ * TEST: Init / Shutdown
+ * EXPECT: An empty snapshot file disables snapshots
+ */
+TEST_F(IndoorNavigationServiceFixture, EmptySnapshotFile_WillSkipSnapshots)
+{
+    ServiceOptions options;
+    options.snapshot_file = "";
+    EXPECT_CALL(mock_engine_snapshot_, Restore(_, _, _)).Times(0);
+    EXPECT_CALL(mock_engine_snapshot_, Save(_, _, _)).Times(0);
+
+    Pistache::Port    port(9080);
+    Pistache::Address addr(Pistache::Ipv4::any(), port);
+    ins_service_.Init(addr, 3, options);
+    ins_service_.Start();
+    ins_service_.Shutdown();
+}
+
 } // namespace !ins_service
\ No newline at end of file
@@ -6,6 +6,8 @@
 #include "ins_service.hpp"
 #include <stdio.h>
 
+extern insNode_t* insNoderoot;
+
 namespace ins_service
 {
 
@@ -113,9 +115,16 @@ TEST_F(LocalizationFixture, LocalizationTest_WillReturnCorrectNodePositionFromNo
 
 	data_store_->InsertRSSIReadings(dev_name, accesspoint_rssi_list);
 
-    Position pos = localization_.ProcessRSSIDataSet(dev_name);
+    std::shared_timed_mutex engine_lock;
+    Position                pos = localization_.ProcessRSSIDataSet(dev_name, engine_lock);
     data_store_->UpdateDeviceLocation(dev_name, pos);
 
+    // destroyInsNode() clears the MAC pointers into the request arena before the arena is rewound.
+    insNode_t* insNode = findWifiNode(insNoderoot, dev_name.c_str());
+    ASSERT_NE(nullptr, insNode);
+    for (int i = 0; i < MAXIMUM_NUMBER_NODES; ++i)
+        EXPECT_EQ(nullptr, insNode->wifiAccessPointNode[i].macAddress);
+
     data_store_->GetPosition(dev_name, QueryT::DEVICE, pos);
 
     EXPECT_NEAR(pos.x, dev_position.x, resolution);
@@ -0,0 +1,105 @@
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "metrics.hpp"
+
+using namespace ::testing;
+
+namespace ins_service
+{
+
+class MetricsFixture : public Test
+{
+protected:
+    size_t ShardCount(const Metrics& metrics)
+    {
+        std::lock_guard<std::mutex> lock(metrics.lock_);
+        return metrics.shards_.size();
+    }
+
+    std::string Render(const Metrics& metrics)
+    {
+        std::string out;
+        metrics.Render(out);
+        return out;
+    }
+};
+
+/**
+ * TEST: EndRequest / Render
+ * EXPECT: Answered requests are counted by status class and their latency lands in cumulative buckets.
+ */
+TEST_F(MetricsFixture, EndRequest_WillCountAndBucketLatency)
+{
+    Metrics metrics;
+    metrics.StartRequest(Route::kResolvePos);
+    metrics.EndRequest(Route::kResolvePos, 200, std::chrono::microseconds(80));
+    metrics.StartRequest(Route::kResolvePos);
+    metrics.EndRequest(Route::kResolvePos, 503, std::chrono::milliseconds(3));
+
+    std::string out = Render(metrics);
+    EXPECT_THAT(out, HasSubstr("ins_requests_total{route=\"resolve_pos\",code=\"2xx\"} 1\n"));
+    EXPECT_THAT(out, HasSubstr("ins_requests_total{route=\"resolve_pos\",code=\"5xx\"} 1\n"));
+    EXPECT_THAT(out, HasSubstr("ins_request_duration_seconds_bucket{route=\"resolve_pos\",le=\"0.000050\"} 0\n"));
+    EXPECT_THAT(out, HasSubstr("ins_request_duration_seconds_bucket{route=\"resolve_pos\",le=\"0.000100\"} 1\n"));
+    EXPECT_THAT(out, HasSubstr("ins_request_duration_seconds_bucket{route=\"resolve_pos\",le=\"0.005000\"} 2\n"));
+    EXPECT_THAT(out, HasSubstr("ins_request_duration_seconds_bucket{route=\"resolve_pos\",le=\"+Inf\"} 2\n"));
+    EXPECT_THAT(out, HasSubstr("ins_request_duration_seconds_count{route=\"resolve_pos\"} 2\n"));
+    EXPECT_THAT(out, HasSubstr("ins_requests_in_flight{route=\"resolve_pos\"} 0\n"));
+}
+
+/**
+ * TEST: StartRequest / EndRequest
+ * EXPECT: Every thread records into a shard of its own, requests started and answered on different threads
+ *         leave the in-flight gauge right once merged.
+ */
+TEST_F(MetricsFixture, Render_WillMergeThreadShards)
+{
+    Metrics metrics;
+    for (int i = 0; i < 3; ++i)
+        metrics.StartRequest(Route::kSetRssi);
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 2; ++i)
+    {
+        threads.emplace_back([&metrics] {
+            metrics.EndRequest(Route::kSetRssi, 200, std::chrono::milliseconds(1));
+            metrics.RecordStage(Stage::kSolve, std::chrono::microseconds(20));
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    EXPECT_EQ(3u, ShardCount(metrics));
+    std::string out = Render(metrics);
+    EXPECT_THAT(out, HasSubstr("ins_requests_total{route=\"set_rssi\",code=\"2xx\"} 2\n"));
+    EXPECT_THAT(out, HasSubstr("ins_requests_in_flight{route=\"set_rssi\"} 1\n"));
+    EXPECT_THAT(out, HasSubstr("ins_stage_duration_seconds_count{stage=\"solve\"} 2\n"));
+}
+
+/**
+ * TEST: EndRequest
+ * EXPECT: A request ended without a response leaves the gauge but is not counted as answered.
+ */
+TEST_F(MetricsFixture, EndRequest_WithoutResponse_WillOnlyLeaveGauge)
+{
+    Metrics metrics;
+    metrics.StartRequest(Route::kGetDevicePos);
+    metrics.EndRequest(Route::kGetDevicePos, 0, Metrics::Clock::duration::zero());
+
+    std::string out = Render(metrics);
+    EXPECT_THAT(out, HasSubstr("ins_requests_in_flight{route=\"get_device_pos\"} 0\n"));
+    EXPECT_THAT(out, HasSubstr("ins_request_duration_seconds_count{route=\"get_device_pos\"} 0\n"));
+
+    std::string sample;
+    Metrics::RenderHeader(sample, "ins_test", "gauge", "Test gauge.");
+    Metrics::RenderValue(sample, "ins_test", "class=\"a\"", 7);
+    EXPECT_EQ("# HELP ins_test Test gauge.\n# TYPE ins_test gauge\nins_test{class=\"a\"} 7\n", sample);
+}
+
+} // namespace ins_service
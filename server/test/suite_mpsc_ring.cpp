@@ -0,0 +1,103 @@
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "mpsc_ring.hpp"
+
+using namespace ::testing;
+
+namespace ins_service
+{
+
+/**
+ * TEST: MpscRing
+ * EXPECT: The capacity is rounded up to a power of two and a full ring rejects pushes.
+ */
+TEST(MpscRingTest, TryPush_Full_WillFail)
+{
+    MpscRing<int> ring(3);
+    EXPECT_EQ(4u, ring.Capacity());
+
+    for (int i = 0; i < 4; ++i)
+        EXPECT_TRUE(ring.TryPush(i));
+    EXPECT_FALSE(ring.TryPush(4));
+    EXPECT_EQ(4u, ring.Depth());
+
+    int item;
+    EXPECT_TRUE(ring.TryPop(item));
+    EXPECT_TRUE(ring.TryPush(4));
+}
+
+/**
+ * TEST: MpscRing
+ * EXPECT: Items come out in push order across wrap-arounds and the depth follows.
+ */
+TEST(MpscRingTest, TryPop_WillPreserveOrderAcrossWrapAround)
+{
+    MpscRing<int> ring(4);
+    int           item;
+    EXPECT_FALSE(ring.TryPop(item));
+
+    for (int round = 0; round < 3; ++round)
+    {
+        for (int i = 0; i < 3; ++i)
+            EXPECT_TRUE(ring.TryPush(round * 10 + i));
+        EXPECT_EQ(3u, ring.Depth());
+        for (int i = 0; i < 3; ++i)
+        {
+            EXPECT_TRUE(ring.TryPop(item));
+            EXPECT_EQ(round * 10 + i, item);
+        }
+        EXPECT_EQ(0u, ring.Depth());
+    }
+    EXPECT_EQ(9u, ring.Pushed());
+    EXPECT_EQ(9u, ring.Popped());
+}
+
+/**
+ * TEST: MpscRing
+ * EXPECT: Concurrent producers lose nothing and each producer's items stay in order.
+ */
+TEST(MpscRingTest, ConcurrentProducers_WillDeliverEveryItemInProducerOrder)
+{
+    const int kProducers = 4;
+    const int kItems     = 20000;
+
+    MpscRing<int>            ring(64);
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p)
+    {
+        producers.emplace_back([&ring, p, kItems] {
+            for (int i = 0; i < kItems; ++i)
+            {
+                while (!ring.TryPush(p * kItems + i))
+                    std::this_thread::yield();
+            }
+        });
+    }
+
+    std::vector<int> next(kProducers, 0);
+    int              received = 0;
+    int              item;
+    while (received < kProducers * kItems)
+    {
+        if (!ring.TryPop(item))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        int producer = item / kItems;
+        EXPECT_EQ(next[producer], item % kItems);
+        next[producer] = item % kItems + 1;
+        ++received;
+    }
+
+    for (auto& producer : producers)
+        producer.join();
+    EXPECT_EQ(0u, ring.Depth());
+}
+
+} // namespace ins_service
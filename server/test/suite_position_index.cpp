@@ -0,0 +1,109 @@
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "mock_data_store.hpp"
+#include "position_index.hpp"
+
+using namespace ::testing;
+
+namespace ins_service
+{
+
+class PositionIndexFixture : public Test
+{
+public:
+    virtual void SetUp()
+    {
+        g_mocked_data_store_ = &mock_data_store_;
+    }
+
+protected:
+    void ExpectLocations(const std::vector<StoredLocation>& locations)
+    {
+        EXPECT_CALL(mock_data_store_, VisitLocations(_))
+            .WillOnce(Invoke([locations](const LocationVisitor& visitor) {
+                for (auto const& location : locations)
+                    visitor(location);
+                return true;
+            }));
+    }
+
+    static StoredLocation Location(const char* device_id, const char* employee_id, double x)
+    {
+        StoredLocation location;
+        location.device_id   = DeviceId(device_id);
+        location.employee_id = employee_id;
+        location.pos         = Position{ x, 0, 0 };
+        return location;
+    }
+
+    NiceMock<MockDataStore> mock_data_store_;
+    DataStore               data_store_;
+    PositionIndex           index_;
+};
+
+/**
+ * TEST: Load
+ * EXPECT: Devices and employees of the locations table can be looked up.
+ */
+TEST_F(PositionIndexFixture, Load_WillIndexDevicesAndEmployees)
+{
+    ExpectLocations({ Location("1000", "jdoe", 1.5), Location("2000", "", 2.5) });
+    EXPECT_TRUE(index_.Load(data_store_));
+
+    Position pos;
+    EXPECT_TRUE(index_.GetDevicePosition(DeviceId("2000"), pos));
+    EXPECT_DOUBLE_EQ(2.5, pos.x);
+    EXPECT_TRUE(index_.GetEmployeePosition("jdoe", pos));
+    EXPECT_DOUBLE_EQ(1.5, pos.x);
+    EXPECT_FALSE(index_.GetDevicePosition(DeviceId("3000"), pos));
+    EXPECT_FALSE(index_.GetEmployeePosition("", pos));
+    EXPECT_EQ(1u, index_.Version());
+}
+
+/**
+ * TEST: UpdateDevicePosition / Publish
+ * EXPECT: Updates stay invisible until published, then land together in one new version.
+ */
+TEST_F(PositionIndexFixture, Publish_WillBatchUpdatesIntoOneVersion)
+{
+    ExpectLocations({ Location("1000", "jdoe", 1.5) });
+    index_.Load(data_store_);
+
+    index_.UpdateDevicePosition(DeviceId("1000"), Position{ 7, 0, 0 });
+    index_.UpdateDevicePosition(DeviceId("4000"), Position{ 8, 0, 0 });
+
+    Position pos;
+    EXPECT_FALSE(index_.GetDevicePosition(DeviceId("4000"), pos));
+
+    index_.Publish();
+    index_.Publish();
+    EXPECT_EQ(2u, index_.Version());
+    EXPECT_TRUE(index_.GetEmployeePosition("jdoe", pos));
+    EXPECT_DOUBLE_EQ(7, pos.x);
+    EXPECT_TRUE(index_.GetDevicePosition(DeviceId("4000"), pos));
+    EXPECT_DOUBLE_EQ(8, pos.x);
+}
+
+/**
+ * TEST: Start / Stop
+ * EXPECT: The publisher thread publishes queued updates, Stop() publishes the rest.
+ */
+TEST_F(PositionIndexFixture, Publisher_WillPublishQueuedUpdates)
+{
+    Position pos;
+    index_.Start(1);
+    index_.UpdateDevicePosition(DeviceId("1000"), Position{ 3, 0, 0 });
+    while (!index_.GetDevicePosition(DeviceId("1000"), pos))
+        std::this_thread::yield();
+    EXPECT_DOUBLE_EQ(3, pos.x);
+
+    index_.Stop();
+    index_.UpdateDevicePosition(DeviceId("1000"), Position{ 4, 0, 0 });
+    index_.Stop();
+    EXPECT_TRUE(index_.GetDevicePosition(DeviceId("1000"), pos));
+    EXPECT_DOUBLE_EQ(4, pos.x);
+}
+
+} // namespace ins_service
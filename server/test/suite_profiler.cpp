@@ -0,0 +1,103 @@
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "profiler.hpp"
+
+using namespace ::testing;
+
+namespace ins_service
+{
+
+class ProfilerFixture : public Test
+{
+protected:
+    // Fills the sample buffer with stacks given innermost frame first, signal frames included.
+    void SetSamples(Profiler& profiler, const std::vector<std::vector<uintptr_t>>& stacks)
+    {
+        profiler.capacity_ = stacks.size();
+        profiler.samples_.reset(new Profiler::Sample[stacks.size()]);
+        for (size_t i = 0; i < stacks.size(); ++i)
+        {
+            profiler.samples_[i].depth = static_cast<int>(stacks[i].size());
+            for (size_t f = 0; f < stacks[i].size(); ++f)
+                profiler.samples_[i].frames[f] = reinterpret_cast<void*>(stacks[i][f]);
+        }
+    }
+
+    std::string Collapse(const Profiler& profiler)
+    {
+        std::string out;
+        profiler.Collapse(profiler.capacity_, out);
+        return out;
+    }
+};
+
+/**
+ * TEST: Collapse
+ * EXPECT: Stacks are written outermost frame first without the signal frames, identical stacks are counted once.
+ */
+TEST_F(ProfilerFixture, Collapse_WillCountIdenticalStacks)
+{
+    Profiler profiler;
+    SetSamples(profiler,
+               { { 0x1, 0x2, 0x10, 0x20 }, { 0x1, 0x2, 0x10, 0x20 }, { 0x1, 0x2, 0x30, 0x20 }, { 0x1, 0x2 } });
+
+    EXPECT_EQ("0x20;0x10 2\n0x20;0x30 1\n", Collapse(profiler));
+}
+
+/**
+ * TEST: Start
+ * EXPECT: A profile of a busy thread delivers collapsed stacks ending in their sample counts.
+ */
+TEST_F(ProfilerFixture, Start_WillSampleBusyThreads)
+{
+    std::atomic<bool> done(false);
+    std::thread       busy([&done] {
+        uint64_t spins = 0;
+        while (!done.load())
+            ++spins;
+        EXPECT_GT(spins, 0u);
+    });
+
+    Profiler                  profiler;
+    std::promise<std::string> stacks;
+    ASSERT_TRUE(profiler.Start(std::chrono::seconds(1),
+                               [&stacks](const std::string& collapsed) { stacks.set_value(collapsed); }));
+    std::string out = stacks.get_future().get();
+    done.store(true);
+    busy.join();
+
+    ASSERT_FALSE(out.empty());
+    EXPECT_THAT(out, MatchesRegex("([^\n]+ [0-9]+\n)+"));
+}
+
+/**
+ * TEST: Start
+ * EXPECT: Only one profile runs in the process at a time, a profiler cut short by its destruction still answers.
+ */
+TEST_F(ProfilerFixture, Start_WhileRunning_WillRefuse)
+{
+    std::promise<void> answered;
+    Profiler           other;
+    {
+        Profiler profiler;
+        ASSERT_TRUE(
+            profiler.Start(std::chrono::seconds(30), [&answered](const std::string&) { answered.set_value(); }));
+        EXPECT_FALSE(profiler.Start(std::chrono::seconds(1), [](const std::string&) {}));
+        EXPECT_FALSE(other.Start(std::chrono::seconds(1), [](const std::string&) {}));
+    }
+    EXPECT_EQ(std::future_status::ready, answered.get_future().wait_for(std::chrono::seconds(0)));
+
+    std::promise<void> second;
+    EXPECT_TRUE(other.Start(std::chrono::seconds(1), [&second](const std::string&) { second.set_value(); }));
+    second.get_future().wait();
+}
+
+} // namespace ins_service
@@ -0,0 +1,123 @@
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "rcu_cell.hpp"
+
+using namespace ::testing;
+
+namespace ins_service
+{
+
+namespace
+{
+// Counts live instances so tests can tell when a version is reclaimed.
+class Tracked
+{
+public:
+    explicit Tracked(int value)
+        : value(value)
+    {
+        ++live;
+    }
+
+    ~Tracked()
+    {
+        --live;
+    }
+
+    int value;
+
+    static std::atomic<int> live;
+};
+
+std::atomic<int> Tracked::live(0);
+} // namespace
+
+/**
+ * TEST: Publish
+ * EXPECT: Readers see the latest version and a version nobody reads is reclaimed right away.
+ */
+TEST(RcuCellTest, Publish_WillReplaceAndReclaimUnreadVersion)
+{
+    {
+        RcuCell<Tracked> cell(std::unique_ptr<Tracked>(new Tracked(1)));
+        EXPECT_EQ(1, cell.Read()->value);
+
+        cell.Publish(std::unique_ptr<Tracked>(new Tracked(2)));
+        EXPECT_EQ(2, cell.Read()->value);
+        EXPECT_EQ(0u, cell.RetiredCount());
+        EXPECT_EQ(1, Tracked::live.load());
+    }
+    EXPECT_EQ(0, Tracked::live.load());
+}
+
+/**
+ * TEST: Publish
+ * EXPECT: A version pinned by a reader survives until the reader lets go.
+ */
+TEST(RcuCellTest, Publish_PinnedVersion_WillWaitForReader)
+{
+    RcuCell<Tracked> cell(std::unique_ptr<Tracked>(new Tracked(1)));
+    {
+        auto pinned = cell.Read();
+        cell.Publish(std::unique_ptr<Tracked>(new Tracked(2)));
+        cell.Publish(std::unique_ptr<Tracked>(new Tracked(3)));
+
+        EXPECT_EQ(1, pinned->value);
+        EXPECT_EQ(3, cell.Read()->value);
+        EXPECT_EQ(2u, cell.RetiredCount());
+    }
+
+    cell.Publish(std::unique_ptr<Tracked>(new Tracked(4)));
+    EXPECT_EQ(0u, cell.RetiredCount());
+    EXPECT_EQ(1, Tracked::live.load());
+}
+
+/**
+ * TEST: Read / Publish
+ * EXPECT: Concurrent readers only ever observe complete, increasing versions while a writer publishes.
+ */
+TEST(RcuCellTest, ConcurrentReaders_WillSeeConsistentVersions)
+{
+    RcuCell<std::vector<int>> cell(std::unique_ptr<std::vector<int>>(new std::vector<int>(64, 0)));
+    std::atomic<bool>         done(false);
+    std::atomic<int>          torn(0);
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; ++r)
+    {
+        readers.emplace_back([&cell, &done, &torn] {
+            int last = 0;
+            while (!done)
+            {
+                auto version = cell.Read();
+                int  first   = version->front();
+                for (int value : *version)
+                {
+                    if (value != first)
+                        ++torn;
+                }
+                if (first < last)
+                    ++torn;
+                last = first;
+            }
+        });
+    }
+
+    for (int v = 1; v <= 2000; ++v)
+        cell.Publish(std::unique_ptr<std::vector<int>>(new std::vector<int>(64, v)));
+    done = true;
+    for (auto& reader : readers)
+        reader.join();
+
+    EXPECT_EQ(0, torn.load());
+    cell.Publish(std::unique_ptr<std::vector<int>>(new std::vector<int>(64, 0)));
+    EXPECT_EQ(0u, cell.RetiredCount());
+}
+
+} // namespace ins_service
@@ -0,0 +1,134 @@
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "request_parser.hpp"
+
+using namespace ::testing;
+
+namespace ins_service
+{
+
+/**
+ * TEST: PathSegments
+ * EXPECT: Segments are returned in order, pointing into the path, with empty ones skipped.
+ */
+TEST(RequestParserTest, PathSegments_WillSplitInPlace)
+{
+    std::string  path = "/set_rssi//4004/ee:44:43:a5:ff:ef/";
+    PathSegments segments(path);
+    StringView   segment;
+
+    ASSERT_TRUE(segments.Next(segment));
+    EXPECT_TRUE(segment == StringView("set_rssi"));
+    EXPECT_EQ(path.data() + 1, segment.data());
+    ASSERT_TRUE(segments.Next(segment));
+    EXPECT_TRUE(segment == StringView("4004"));
+    ASSERT_TRUE(segments.Next(segment));
+    EXPECT_TRUE(segment == StringView("ee:44:43:a5:ff:ef"));
+    EXPECT_FALSE(segments.Next(segment));
+}
+
+/**
+ * TEST: ParseInt32 / ParseRssi
+ * EXPECT: Signed decimals in range are accepted, anything else is rejected.
+ */
+TEST(RequestParserTest, ParseInt32AndRssi_WillAcceptOnlyDecimalsInRange)
+{
+    int32_t value = 0;
+    EXPECT_TRUE(ParseInt32("-67", value));
+    EXPECT_EQ(-67, value);
+    EXPECT_TRUE(ParseInt32("+12", value));
+    EXPECT_EQ(12, value);
+    EXPECT_TRUE(ParseInt32("-2147483648", value));
+    EXPECT_EQ(INT32_MIN, value);
+
+    EXPECT_FALSE(ParseInt32("", value));
+    EXPECT_FALSE(ParseInt32("-", value));
+    EXPECT_FALSE(ParseInt32("12a", value));
+    EXPECT_FALSE(ParseInt32("2147483648", value));
+    EXPECT_FALSE(ParseInt32("99999999999999999999", value));
+
+    EXPECT_TRUE(ParseRssi("12.323", value));
+    EXPECT_EQ(12, value);
+    EXPECT_TRUE(ParseRssi("-44.7", value));
+    EXPECT_EQ(-44, value);
+    EXPECT_FALSE(ParseRssi("-44.7.1", value));
+    EXPECT_FALSE(ParseRssi(".5", value));
+}
+
+/**
+ * TEST: ParseMacAddress / ParseDeviceId
+ * EXPECT: Only well formed mac addresses and table safe device ids are accepted.
+ */
+TEST(RequestParserTest, ParseMacAddressAndDeviceId_WillValidate)
+{
+    MacAddress mac_addr;
+    EXPECT_TRUE(ParseMacAddress("EE:44:43:a5:ff:ef", mac_addr));
+    EXPECT_EQ("EE:44:43:a5:ff:ef", mac_addr);
+    EXPECT_FALSE(ParseMacAddress("ee:44:43:a5:ff:e", mac_addr));
+    EXPECT_FALSE(ParseMacAddress("ee-44-43-a5-ff-ef", mac_addr));
+    EXPECT_FALSE(ParseMacAddress("ee:44:43:a5:ff:eg", mac_addr));
+
+    DeviceId device_id;
+    EXPECT_TRUE(ParseDeviceId("4004", device_id));
+    EXPECT_EQ("4004", device_id);
+    EXPECT_FALSE(ParseDeviceId("", device_id));
+    EXPECT_FALSE(ParseDeviceId("1;DROP TABLE locations", device_id));
+    EXPECT_FALSE(ParseDeviceId(std::string(64, '1'), device_id));
+}
+
+/**
+ * TEST: ParseRssiUpload
+ * EXPECT: Device id and every complete reading are parsed, a dangling access point is ignored.
+ */
+TEST(RequestParserTest, ParseRssiUpload_WillParseReadings)
+{
+    DeviceId    device_id;
+    RssiReading readings[3];
+    size_t      count = 0;
+
+    EXPECT_TRUE(ParseRssiUpload("/set_rssi/4004/ee:44:43:a5:ff:ef/-40/11:65:d4:fe:ee:ff/-71/01:23:dd:3e:4c:cc",
+                                device_id,
+                                readings,
+                                3,
+                                count));
+    EXPECT_EQ("4004", device_id);
+    ASSERT_EQ(2u, count);
+    EXPECT_EQ("ee:44:43:a5:ff:ef", readings[0].mac_addr);
+    EXPECT_EQ(-40, readings[0].rssi);
+    EXPECT_EQ("11:65:d4:fe:ee:ff", readings[1].mac_addr);
+    EXPECT_EQ(-71, readings[1].rssi);
+}
+
+/**
+ * TEST: ParseRssiUpload
+ * EXPECT: Malformed uploads, or uploads without any reading, are rejected.
+ */
+TEST(RequestParserTest, ParseRssiUpload_Malformed_WillFail)
+{
+    DeviceId    device_id;
+    RssiReading readings[2];
+    size_t      count = 0;
+
+    EXPECT_FALSE(ParseRssiUpload("/set_rssi/4004", device_id, readings, 2, count));
+    EXPECT_FALSE(ParseRssiUpload("/set_rssi/4004/ee:44:43:a5:ff:ef", device_id, readings, 2, count));
+    EXPECT_FALSE(ParseRssiUpload("/set_rssi/4004/ee:44:43:a5:ff:ef/strong", device_id, readings, 2, count));
+    EXPECT_FALSE(ParseRssiUpload("/set_rssi/40.04/ee:44:43:a5:ff:ef/-40", device_id, readings, 2, count));
+}
+
+/**
+ * TEST: ParseUploadDeviceId
+ * EXPECT: The device id is taken from the path whatever follows it.
+ */
+TEST(RequestParserTest, ParseUploadDeviceId_WillIgnoreReadings)
+{
+    DeviceId device_id;
+
+    EXPECT_TRUE(ParseUploadDeviceId("/set_rssi/4004/ee:44:43:a5:ff:ef/strong", device_id));
+    EXPECT_EQ("4004", device_id);
+    EXPECT_FALSE(ParseUploadDeviceId("/set_rssi/40.04/ee:44:43:a5:ff:ef/-40", device_id));
+    EXPECT_FALSE(ParseUploadDeviceId("/set_rssi", device_id));
+}
+
+} // namespace !ins_service
@@ -0,0 +1,165 @@
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <future>
+
+#include "mock_data_store.hpp"
+#include "storage_writer.hpp"
+
+using namespace ::testing;
+
+namespace ins_service
+{
+
+class StorageWriterFixture : public Test
+{
+public:
+    virtual void SetUp()
+    {
+        g_mocked_data_store_ = &mock_data_store_;
+        ON_CALL(mock_data_store_, BeginTransaction()).WillByDefault(Return(true));
+        ON_CALL(mock_data_store_, CommitTransaction()).WillByDefault(Return(true));
+        ON_CALL(mock_data_store_, CreateDeviceTable(_)).WillByDefault(Return(true));
+        ON_CALL(mock_data_store_, InsertRSSIReadings(_, An<const RssiReading*>(), _)).WillByDefault(Return(true));
+    }
+
+    size_t DrainBatch(StorageWriter& writer)
+    {
+        return writer.DrainBatch();
+    }
+
+protected:
+    bool Submit(StorageWriter& writer, const char* device_id, size_t count = 1)
+    {
+        RssiReading readings[IngestRecord::kMaxReadings];
+        for (size_t i = 0; i < count; ++i)
+            readings[i] = RssiReading{ MacAddress("23:43:3d:3e:5e:f5"), -40 - static_cast<int32_t>(i) };
+        return writer.Submit(DeviceId(device_id), readings, count);
+    }
+
+    NiceMock<MockDataStore>    mock_data_store_;
+    std::shared_ptr<DataStore> data_store_ = std::make_shared<DataStore>();
+};
+
+/**
+ * TEST: Submit
+ * EXPECT: Uploads are rejected when the queue is full or hold too many readings.
+ */
+TEST_F(StorageWriterFixture, Submit_FullQueueOrTooManyReadings_WillFail)
+{
+    StorageWriter writer(data_store_, 2);
+
+    EXPECT_FALSE(Submit(writer, "1000", 0));
+    EXPECT_FALSE(Submit(writer, "1000", IngestRecord::kMaxReadings + 1));
+    EXPECT_TRUE(Submit(writer, "1000", IngestRecord::kMaxReadings));
+    EXPECT_TRUE(Submit(writer, "1000"));
+    EXPECT_FALSE(Submit(writer, "1000"));
+    EXPECT_EQ(2u, writer.Depth());
+}
+
+/**
+ * TEST: DrainBatch
+ * EXPECT: Queued uploads are stored in one transaction, creating each device table once.
+ */
+TEST_F(StorageWriterFixture, DrainBatch_WillStoreUploadsInOneTransaction)
+{
+    StorageWriter writer(data_store_);
+    Submit(writer, "1000", 2);
+    Submit(writer, "1000", 3);
+    Submit(writer, "2000");
+
+    InSequence sequence;
+    EXPECT_CALL(mock_data_store_, BeginTransaction()).Times(1);
+    EXPECT_CALL(mock_data_store_, CreateDeviceTable("1000")).Times(1);
+    EXPECT_CALL(mock_data_store_, InsertRSSIReadings("1000", An<const RssiReading*>(), 2u)).Times(1);
+    EXPECT_CALL(mock_data_store_, InsertRSSIReadings("1000", An<const RssiReading*>(), 3u)).Times(1);
+    EXPECT_CALL(mock_data_store_, CreateDeviceTable("2000")).Times(1);
+    EXPECT_CALL(mock_data_store_, InsertRSSIReadings("2000", An<const RssiReading*>(), 1u)).Times(1);
+    EXPECT_CALL(mock_data_store_, CommitTransaction()).Times(1);
+
+    EXPECT_EQ(3u, DrainBatch(writer));
+    EXPECT_EQ(0u, DrainBatch(writer));
+    EXPECT_EQ(0u, writer.Depth());
+}
+
+/**
+ * TEST: DrainBatch
+ * EXPECT: A batch holds at most kMaxBatch uploads.
+ */
+TEST_F(StorageWriterFixture, DrainBatch_WillCapBatchSize)
+{
+    StorageWriter writer(data_store_);
+    for (size_t i = 0; i < StorageWriter::kMaxBatch + 1; ++i)
+        Submit(writer, "1000");
+
+    EXPECT_CALL(mock_data_store_, CommitTransaction()).Times(2);
+    EXPECT_EQ(StorageWriter::kMaxBatch, DrainBatch(writer));
+    EXPECT_EQ(1u, DrainBatch(writer));
+}
+
+/**
+ * TEST: DrainBatch
+ * EXPECT: A batch whose transaction fails is stored again upload by upload, re-creating the device tables the
+ *         rollback dropped.
+ */
+TEST_F(StorageWriterFixture, DrainBatch_CommitFails_WillStoreUploadsOneByOne)
+{
+    StorageWriter writer(data_store_);
+    Submit(writer, "1000", 2);
+    Submit(writer, "2000");
+
+    EXPECT_CALL(mock_data_store_, CommitTransaction()).WillOnce(Return(false));
+    EXPECT_CALL(mock_data_store_, RollbackTransaction()).Times(1);
+    EXPECT_CALL(mock_data_store_, CreateDeviceTable("1000")).Times(2);
+    EXPECT_CALL(mock_data_store_, CreateDeviceTable("2000")).Times(2);
+    EXPECT_CALL(mock_data_store_, InsertRSSIReadings("1000", An<const RssiReading*>(), 2u)).Times(2);
+    EXPECT_CALL(mock_data_store_, InsertRSSIReadings("2000", An<const RssiReading*>(), 1u)).Times(2);
+    EXPECT_EQ(2u, DrainBatch(writer));
+
+    // The tables exist now, later uploads do not create them again.
+    Submit(writer, "1000");
+    EXPECT_CALL(mock_data_store_, CommitTransaction()).WillOnce(Return(true));
+    EXPECT_CALL(mock_data_store_, InsertRSSIReadings("1000", An<const RssiReading*>(), 1u)).Times(1);
+    EXPECT_EQ(1u, DrainBatch(writer));
+}
+
+/**
+ * TEST: Flush / Stop
+ * EXPECT: The storage thread has stored every upload submitted before Flush() returns.
+ */
+TEST_F(StorageWriterFixture, Flush_WillWaitForStorageThread)
+{
+    StorageWriter writer(data_store_);
+    EXPECT_CALL(mock_data_store_, InsertRSSIReadings("1000", An<const RssiReading*>(), 1u)).Times(100);
+
+    writer.Start();
+    for (int i = 0; i < 100; ++i)
+        EXPECT_TRUE(Submit(writer, "1000"));
+    writer.Flush();
+    EXPECT_EQ(0u, writer.Depth());
+    writer.Stop();
+}
+
+/**
+ * TEST: OnStored
+ * EXPECT: The callback runs once the uploads submitted before it are stored, right away when there are none.
+ */
+TEST_F(StorageWriterFixture, OnStored_WillRunCallbackAfterStorage)
+{
+    StorageWriter writer(data_store_);
+    std::atomic<int> called(0);
+    writer.OnStored([&called] { ++called; });
+    EXPECT_EQ(1, called);
+
+    writer.Start();
+    for (int i = 0; i < 10; ++i)
+        EXPECT_TRUE(Submit(writer, "1000"));
+    std::promise<size_t> depth;
+    writer.OnStored([&writer, &depth] { depth.set_value(writer.Depth()); });
+    EXPECT_EQ(0u, depth.get_future().get());
+    writer.Stop();
+}
+
+} // namespace ins_service
@@ -0,0 +1,156 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+
+#include "synthetic_building.hpp"
+
+extern "C"
+{
+#include <WifiAccessPointLocalConfig.h>
+}
+
+using namespace ::testing;
+
+namespace ins_service
+{
+
+class SyntheticBuildingFixture : public Test
+{
+protected:
+    // Distance the engine derives from rssi with the path loss parameters of access_point, as power2distance().
+    float EngineDistance(const SyntheticAccessPoint& access_point, float rssi)
+    {
+        float n_exponent = (access_point.power_transmit - access_point.power_at_arbitrary_distance)
+                           / (10.0f * std::log10(access_point.arbitrary_distance));
+        return std::pow(10.0f, (access_point.power_transmit - rssi) / (10.0f * n_exponent));
+    }
+
+    float Distance(const Position& lhs, const Position& rhs, float floor_height)
+    {
+        double dx = lhs.x - rhs.x;
+        double dy = lhs.y - rhs.y;
+        double dz = (lhs.z - rhs.z) * floor_height;
+        return static_cast<float>(std::sqrt(dx * dx + dy * dy + dz * dz));
+    }
+};
+
+/**
+ * TEST: SyntheticBuilding
+ * EXPECT: The same seed lays out the same building and readings, another seed a different one.
+ */
+TEST_F(SyntheticBuildingFixture, SyntheticBuilding_SameSeed_WillBeReproducible)
+{
+    BuildingOptions   options;
+    SyntheticBuilding first(options);
+    SyntheticBuilding second(options);
+    options.seed = 7;
+    SyntheticBuilding other(options);
+
+    EXPECT_EQ(first.LocalConfig(), second.LocalConfig());
+    EXPECT_EQ(first.desks(), second.desks());
+    EXPECT_NE(first.LocalConfig(), other.LocalConfig());
+
+    std::mt19937 first_random(1);
+    std::mt19937 second_random(1);
+    EXPECT_EQ(first.SimulateReadings(first.desks()[0], 50, first_random),
+              second.SimulateReadings(second.desks()[0], 50, second_random));
+}
+
+/**
+ * TEST: SyntheticBuilding
+ * EXPECT: Floors and access points per floor are capped at what the local config lookup tells apart.
+ */
+TEST_F(SyntheticBuildingFixture, SyntheticBuilding_TooLarge_WillBeCapped)
+{
+    BuildingOptions options;
+    options.floors                  = 5;
+    options.access_points_per_floor = 15;
+    options.desks_per_floor         = 4;
+    SyntheticBuilding building(options);
+
+    EXPECT_EQ(SyntheticBuilding::kMaxFloors, building.options().floors);
+    EXPECT_EQ(SyntheticBuilding::kMaxFloors * SyntheticBuilding::kMaxAccessPointsPerFloor,
+              building.access_points().size());
+    EXPECT_EQ(SyntheticBuilding::kMaxFloors * 4, building.desks().size());
+}
+
+/**
+ * TEST: WriteLocalConfig
+ * EXPECT: The engine loads every access point back from the written config with its position and powers.
+ */
+TEST_F(SyntheticBuildingFixture, WriteLocalConfig_WillLoadInEngine)
+{
+    BuildingOptions options;
+    options.access_points_per_floor = SyntheticBuilding::kMaxAccessPointsPerFloor;
+    SyntheticBuilding building(options);
+
+    char filename[] = "synthetic_WifiNodeLCFG_XXXXXX";
+    int  fd         = mkstemp(filename);
+    ASSERT_NE(-1, fd);
+    close(fd);
+    ASSERT_TRUE(building.WriteLocalConfig(filename));
+    ASSERT_EQ(0, lcfg_initialize(filename));
+    remove(filename);
+
+    for (auto const& access_point : building.access_points())
+    {
+        wifiParams_t block;
+        memset(&block, 0, sizeof(block));
+        block.macAddress = const_cast<char*>(access_point.mac_addr.c_str());
+        loadLCFGParams(&block);
+
+        EXPECT_STREQ(access_point.mac_addr.c_str(), block.macAddress);
+        EXPECT_NEAR(access_point.pos.x, block.position[0], 1e-3);
+        EXPECT_NEAR(access_point.pos.y, block.position[1], 1e-3);
+        EXPECT_NEAR(access_point.pos.z, block.position[2], 1e-3);
+        EXPECT_NEAR(access_point.power_transmit, block.pathLoss.powerdo, 1e-3);
+        EXPECT_NEAR(access_point.power_at_arbitrary_distance, block.pathLoss.powerd, 1e-3);
+        EXPECT_NEAR(access_point.arbitrary_distance, block.pathLoss.dDistance, 1e-3);
+        lcfg_freeStringParameter(block.macAddress);
+    }
+}
+
+/**
+ * TEST: SimulateReadings
+ * EXPECT: Without noise, the engine's path loss model turns every reading back into the true distance, and the
+ *         strongest access points come first.
+ */
+TEST_F(SyntheticBuildingFixture, SimulateReadings_WithoutNoise_WillInvertToDistance)
+{
+    BuildingOptions options;
+    options.noise_db        = 0.0f;
+    options.sensitivity_dbm = -200.0f;
+    SyntheticBuilding building(options);
+    std::mt19937      random(1);
+
+    const Position& desk   = building.desks()[0];
+    auto            series = building.SimulateReadings(desk, 10, random);
+    ASSERT_EQ(std::min<size_t>(building.access_points().size(), MAXIMUM_NUMBER_NODES), series.size());
+
+    for (size_t i = 0; i < series.size(); ++i)
+    {
+        auto access_point = std::find_if(building.access_points().begin(),
+                                         building.access_points().end(),
+                                         [&series, i](const SyntheticAccessPoint& candidate) {
+                                             return candidate.mac_addr == series[i].first.mac_addr;
+                                         });
+        ASSERT_NE(building.access_points().end(), access_point);
+        ASSERT_THAT(series[i].second, Each(series[i].second[0]));
+        if (i > 0)
+        {
+            EXPECT_GE(series[i - 1].second[0], series[i].second[0]);
+        }
+
+        // Readings are whole dBm, which is up to 0.5 dB off the mean.
+        float distance = std::max(1.0f, Distance(access_point->pos, desk, options.floor_height_m));
+        EXPECT_NEAR(distance, EngineDistance(*access_point, series[i].second[0]), distance * 0.05f);
+    }
+}
+
+} // namespace ins_service
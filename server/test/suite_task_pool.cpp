@@ -0,0 +1,121 @@
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
+
+#include "task_pool.hpp"
+
+using namespace ::testing;
+
+namespace ins_service
+{
+
+class TaskPoolFixture : public Test
+{
+public:
+    static int CurrentNiceness()
+    {
+        return getpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)));
+    }
+};
+
+/**
+ * TEST: TrySubmit
+ * EXPECT: A pool that is not started runs tasks inline.
+ */
+TEST_F(TaskPoolFixture, TrySubmit_NotStarted_WillRunInline)
+{
+    TaskPool        pool("test", 2, 1, ThreadPriority::kInteractive);
+    std::thread::id runner;
+
+    EXPECT_TRUE(pool.TrySubmit([&runner] { runner = std::this_thread::get_id(); }));
+    EXPECT_EQ(std::this_thread::get_id(), runner);
+}
+
+/**
+ * TEST: TrySubmit
+ * EXPECT: Tasks beyond the queue limit are rejected while the workers are busy.
+ */
+TEST_F(TaskPoolFixture, TrySubmit_FullQueue_WillReject)
+{
+    TaskPool pool("test", 1, 2, ThreadPriority::kInteractive);
+    pool.Start();
+
+    std::mutex              lock;
+    std::condition_variable released_cv;
+    bool                    started  = false;
+    bool                    released = false;
+    EXPECT_TRUE(pool.TrySubmit([&] {
+        std::unique_lock<std::mutex> guard(lock);
+        started = true;
+        released_cv.notify_all();
+        released_cv.wait(guard, [&released] { return released; });
+    }));
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        released_cv.wait(guard, [&started] { return started; });
+    }
+
+    std::atomic<int> executed(0);
+    EXPECT_TRUE(pool.TrySubmit([&executed] { ++executed; }));
+    EXPECT_TRUE(pool.TrySubmit([&executed] { ++executed; }));
+    EXPECT_FALSE(pool.TrySubmit([&executed] { ++executed; }));
+    EXPECT_EQ(2u, pool.Depth());
+    EXPECT_EQ(1u, pool.Rejected());
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        released = true;
+    }
+    released_cv.notify_all();
+    pool.Stop();
+    EXPECT_EQ(2, executed.load());
+}
+
+/**
+ * TEST: Run
+ * EXPECT: A throwing task is logged and the worker goes on with the next one.
+ */
+TEST_F(TaskPoolFixture, Run_ThrowingTask_WillKeepWorker)
+{
+    TaskPool pool("test", 1, 2, ThreadPriority::kInteractive);
+    pool.Start();
+
+    std::atomic<int> executed(0);
+    EXPECT_TRUE(pool.TrySubmit([] { throw std::runtime_error("failed"); }));
+    EXPECT_TRUE(pool.TrySubmit([&executed] { ++executed; }));
+    pool.Stop();
+    EXPECT_EQ(1, executed.load());
+}
+
+/**
+ * TEST: Start
+ * EXPECT: Bulk pools lower the priority of their workers, interactive pools keep it.
+ */
+TEST_F(TaskPoolFixture, Start_WillApplyThreadPriority)
+{
+    int      bulk_niceness        = -1;
+    int      interactive_niceness = -1;
+    TaskPool bulk("bulk", 1, 1, ThreadPriority::kBulk);
+    TaskPool interactive("interactive", 1, 1, ThreadPriority::kInteractive);
+    bulk.Start();
+    interactive.Start();
+
+    bulk.TrySubmit([&bulk_niceness] { bulk_niceness = CurrentNiceness(); });
+    interactive.TrySubmit([&interactive_niceness] { interactive_niceness = CurrentNiceness(); });
+    bulk.Stop();
+    interactive.Stop();
+
+    EXPECT_EQ(CurrentNiceness() + kBulkThreadNiceness, bulk_niceness);
+    EXPECT_EQ(CurrentNiceness(), interactive_niceness);
+}
+
+} // namespace ins_service
@@ -0,0 +1,119 @@
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+
+#include "tracer.hpp"
+
+using namespace ::testing;
+
+namespace ins_service
+{
+
+class TracerFixture : public Test
+{
+protected:
+    size_t RingCount(const Tracer& tracer)
+    {
+        std::lock_guard<std::mutex> lock(tracer.lock_);
+        return tracer.rings_.size();
+    }
+
+    std::string Dump(const Tracer& tracer)
+    {
+        std::string out;
+        tracer.Dump(out);
+        return out;
+    }
+
+    size_t Count(const std::string& text, const std::string& pattern)
+    {
+        size_t count = 0;
+        for (size_t at = text.find(pattern); at != std::string::npos; at = text.find(pattern, at + 1))
+            ++count;
+        return count;
+    }
+};
+
+/**
+ * TEST: StartTrace
+ * EXPECT: One request out of every configured count gets a trace id, none once tracing is off.
+ */
+TEST_F(TracerFixture, StartTrace_WillSampleOneOutOfEvery)
+{
+    Tracer tracer;
+    EXPECT_EQ(0u, tracer.StartTrace());
+
+    tracer.SetSampleEvery(3);
+    EXPECT_EQ(1u, tracer.StartTrace());
+    EXPECT_EQ(0u, tracer.StartTrace());
+    EXPECT_EQ(0u, tracer.StartTrace());
+    EXPECT_EQ(2u, tracer.StartTrace());
+
+    tracer.SetSampleEvery(0);
+    EXPECT_EQ(0u, tracer.StartTrace());
+}
+
+/**
+ * TEST: Record / Dump
+ * EXPECT: Spans are dumped as complete events with microsecond times, a full ring keeps its latest spans
+ *         and untraced spans are dropped.
+ */
+TEST_F(TracerFixture, Dump_WillKeepLatestSpansOfEachRing)
+{
+    Tracer tracer;
+    EXPECT_EQ("{\"traceEvents\":[],\"displayTimeUnit\":\"ms\"}", Dump(tracer));
+
+    Tracer::Clock::time_point start = Tracer::Clock::now();
+    tracer.Record("first", 7, start, start + std::chrono::microseconds(1500));
+    tracer.Record("untraced", 0, start, start);
+    EXPECT_THAT(Dump(tracer), HasSubstr("{\"name\":\"first\",\"cat\":\"ins\",\"ph\":\"X\","));
+    EXPECT_THAT(Dump(tracer), HasSubstr(",\"dur\":1500.000,\"pid\":1,\"tid\":1,\"args\":{\"trace\":7}}"));
+    EXPECT_THAT(Dump(tracer), Not(HasSubstr("untraced")));
+
+    for (size_t i = 0; i < Tracer::kRingSpans; ++i)
+        tracer.Record("later", 8, start, start);
+    std::string out = Dump(tracer);
+    EXPECT_THAT(out, Not(HasSubstr("first")));
+    EXPECT_EQ(Tracer::kRingSpans, Count(out, "\"name\":\"later\""));
+}
+
+/**
+ * TEST: TraceScope / TraceSpan
+ * EXPECT: Spans belong to the trace made current on their thread, every thread records into a ring of its
+ *         own and the previous trace is current again once a scope ends.
+ */
+TEST_F(TracerFixture, TraceSpan_WillRecordCurrentTraceOfThread)
+{
+    Tracer& tracer = DefaultTracer();
+    {
+        TraceSpan span("no_trace");
+    }
+    {
+        TraceScope outer(41);
+        {
+            TraceScope inner(42);
+            TraceSpan  span("inner_span");
+            EXPECT_EQ(42u, CurrentTrace());
+        }
+        EXPECT_EQ(41u, CurrentTrace());
+    }
+    EXPECT_EQ(0u, CurrentTrace());
+
+    std::thread other([] {
+        TraceScope scope(43);
+        TraceSpan  span("other_span");
+    });
+    other.join();
+
+    std::string out = Dump(tracer);
+    EXPECT_THAT(out, Not(HasSubstr("no_trace")));
+    EXPECT_THAT(out, HasSubstr("\"name\":\"inner_span\""));
+    EXPECT_THAT(out, HasSubstr("\"args\":{\"trace\":42}"));
+    EXPECT_THAT(out, HasSubstr("\"args\":{\"trace\":43}"));
+    EXPECT_EQ(2u, RingCount(tracer));
+}
+
+} // namespace ins_service
@@ -0,0 +1,81 @@
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <unordered_map>
+
+#include "types.hpp"
+
+using namespace ::testing;
+
+namespace ins_service
+{
+
+/**
+ * TEST: FixedString
+ * EXPECT: Values compare by content, whatever string type they were built from.
+ */
+TEST(FixedStringTest, Compare_WillUseContent)
+{
+    MacAddress mac_addr(std::string("ee:44:43:a5:ff:ef"));
+
+    EXPECT_EQ(MacAddress("ee:44:43:a5:ff:ef"), mac_addr);
+    EXPECT_EQ("ee:44:43:a5:ff:ef", mac_addr);
+    EXPECT_NE(MacAddress("ee:44:43:a5:ff:e"), mac_addr);
+    EXPECT_TRUE(MacAddress("ee:44:43:a5:ff:e") < mac_addr);
+    EXPECT_TRUE(mac_addr.Equals("ee:44:43:a5:ff:efXX", 17));
+    EXPECT_EQ(17u, mac_addr.size());
+    EXPECT_STREQ("ee:44:43:a5:ff:ef", mac_addr.c_str());
+}
+
+/**
+ * TEST: FixedString
+ * EXPECT: Input longer than the capacity is truncated.
+ */
+TEST(FixedStringTest, Assign_TooLong_WillTruncate)
+{
+    MacAddress mac_addr("ee:44:43:a5:ff:ef:01:02");
+
+    EXPECT_EQ(MacAddress::kCapacity, mac_addr.size());
+    EXPECT_EQ("ee:44:43:a5:ff:ef", mac_addr.str());
+    EXPECT_TRUE(MacAddress().empty());
+}
+
+/**
+ * TEST: FixedString
+ * EXPECT: Values can be hashed and printed.
+ */
+TEST(FixedStringTest, HashAndPrint_WillUseContent)
+{
+    std::unordered_map<DeviceId, int> positions;
+    positions[DeviceId("4004")] = 1;
+    positions[std::string("1000")] = 2;
+
+    EXPECT_EQ(1, positions[DeviceId(std::string("4004"))]);
+    EXPECT_EQ(2u, positions.size());
+
+    std::ostringstream out;
+    out << DeviceId("4004") << "/" << MacAddress("ee:44:43:a5:ff:ef");
+    EXPECT_EQ("4004/ee:44:43:a5:ff:ef", out.str());
+}
+
+/**
+ * TEST: AccessPointRssiPair
+ * EXPECT: Readings are flat values that survive a bulk copy.
+ */
+TEST(FixedStringTest, AccessPointRssiPair_WillBeBulkCopyable)
+{
+    static_assert(std::is_trivially_copyable<AccessPoint>::value, "access points are flat");
+
+    AccessPointRssiPair readings[2] = { std::make_pair(AccessPoint("ee:44:43:a5:ff:ef"), -40),
+                                        AccessPointRssiPair(AccessPoint("11:65:d4:fe:ee:ff"), -60) };
+    AccessPointRssiPair copies[2];
+    std::memcpy(copies, readings, sizeof(readings));
+
+    EXPECT_EQ(readings[0], copies[0]);
+    EXPECT_EQ("11:65:d4:fe:ee:ff", copies[1].first.mac_addr);
+    EXPECT_EQ(-60, copies[1].second);
+}
+
+} // namespace !ins_service